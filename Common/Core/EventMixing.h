@@ -12,8 +12,22 @@
 #ifndef ANALYSIS_CORE_EVENTMIXING_H_
 #define ANALYSIS_CORE_EVENTMIXING_H_
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace eventmixing
 {
+/// Find the bin of a value in a set of bin edges, the bins being [edges[i-1], edges[i])
+/// \param edges Bin edges, in increasing order
+/// \param value Value to be binned
+/// \return Index i of the upper edge of the bin, 0 for underflow and edges.size() for overflow
+template <typename T1, typename T2>
+static int findUpperEdge(const T1& edges, const T2& value)
+{
+  return std::upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+}
+
 /// Calculate hash for an element based on 2 properties and their bins.
 /// \tparam T1 Data type of the configurable of the z-vertex and multiplicity bins
 /// \tparam T2 Data type of the value of the z-vertex and multiplicity
@@ -25,26 +39,164 @@ namespace eventmixing
 template <typename T1, typename T2>
 static int getMixingBin(const T1& vtxBins, const T1& multBins, const T2& vtx, const T2& mult)
 {
-  // underflow
-  if (vtx < vtxBins.at(0)) {
+  const int i = findUpperEdge(vtxBins, vtx);
+  const int j = findUpperEdge(multBins, mult);
+  // underflow and overflow
+  if (i == 0 || i == static_cast<int>(vtxBins.size()) || j == 0 || j == static_cast<int>(multBins.size())) {
     return -1;
   }
-  if (mult < multBins.at(0)) {
-    return -1;
+  return i + j * (vtxBins.size() + 1);
+}
+
+/// \class MixingBinning
+/// \brief Mixing categories in an arbitrary number of event properties (z-vertex, multiplicity, centrality, event plane, ...)
+///
+/// Each axis is given by its bin edges, the bins being [edges[i], edges[i+1]). The bin of a value is computed
+/// directly for equidistant edges and with a binary search otherwise. The category of an event is the
+/// row-major index of its bins (last axis running fastest), or -1 if any of the values is outside its axis.
+class MixingBinning
+{
+ public:
+  MixingBinning() = default;
+
+  /// Add an axis
+  /// \param edges Bin edges, in increasing order (at least two)
+  template <typename T>
+  void addAxis(const T& edges)
+  {
+    Axis axis;
+    axis.edges.assign(edges.begin(), edges.end());
+    axis.nBins = static_cast<int>(axis.edges.size()) - 1;
+    if (axis.nBins > 0) {
+      const float width = (axis.edges.back() - axis.edges.front()) / axis.nBins;
+      axis.isUniform = width > 0.f;
+      for (int i = 1; i < axis.nBins && axis.isUniform; ++i) {
+        axis.isUniform = std::abs(axis.edges[i] - (axis.edges.front() + i * width)) <= 1.e-5f * width;
+      }
+      axis.invWidth = axis.isUniform ? 1.f / width : 0.f;
+    }
+    mAxes.push_back(std::move(axis));
+
+    // strides of the category, last axis running fastest
+    mStrides.resize(mAxes.size());
+    mNCategories = 1;
+    for (int i = static_cast<int>(mAxes.size()) - 1; i >= 0; --i) {
+      mStrides[i] = mNCategories;
+      mNCategories *= std::max(mAxes[i].nBins, 0);
+    }
+  }
+
+  /// Remove all the axes
+  void clear()
+  {
+    mAxes.clear();
+    mStrides.clear();
+    mNCategories = 0;
   }
 
-  for (unsigned int i = 1; i < vtxBins.size(); i++) {
-    if (vtx < vtxBins.at(i)) {
-      for (unsigned int j = 1; j < multBins.size(); j++) {
-        if (mult < multBins.at(j)) {
-          return i + j * (vtxBins.size() + 1);
-        }
+  int getNAxes() const { return mAxes.size(); }
+  int getNBins(int axis) const { return mAxes[axis].nBins; }
+  int getNCategories() const { return mNCategories; }
+  const std::vector<float>& getEdges(int axis) const { return mAxes[axis].edges; }
+
+  /// \return Bin of the value in the given axis, -1 if outside the axis
+  int getBin(int axis, float value) const
+  {
+    const Axis& a = mAxes[axis];
+    if (!(value >= a.edges.front() && value < a.edges.back())) { // also rejects NaN
+      return -1;
+    }
+    if (!a.isUniform) {
+      return findUpperEdge(a.edges, value) - 1;
+    }
+    int bin = std::min(static_cast<int>((value - a.edges.front()) * a.invWidth), a.nBins - 1);
+    // correct for the rounding close to the edges, so that the result is the same as with the binary search
+    if (value < a.edges[bin]) {
+      --bin;
+    } else if (value >= a.edges[bin + 1]) {
+      ++bin;
+    }
+    return bin;
+  }
+
+  /// \param values Values for all the axes, in the order in which the axes were added
+  /// \return Category of the values, -1 if any value is outside its axis or if no axis is defined
+  int getCategory(const float* values) const
+  {
+    if (mAxes.empty()) {
+      return -1;
+    }
+    int category = 0;
+    for (size_t i = 0; i < mAxes.size(); ++i) {
+      const int bin = getBin(i, values[i]);
+      if (bin < 0) {
+        return -1;
       }
+      category += bin * mStrides[i];
     }
+    return category;
   }
-  // overflow
-  return -1;
-}
+
+  /// Same as getCategory(const float*), with the value of axis i taken as values[variables[i]]
+  int getCategory(const float* values, const int* variables) const
+  {
+    if (mAxes.empty()) {
+      return -1;
+    }
+    int category = 0;
+    for (size_t i = 0; i < mAxes.size(); ++i) {
+      const int bin = getBin(i, values[variables[i]]);
+      if (bin < 0) {
+        return -1;
+      }
+      category += bin * mStrides[i];
+    }
+    return category;
+  }
+
+  /// \param values One value per axis, in the order in which the axes were added
+  template <typename... Ts>
+  int getCategoryOf(Ts... values) const
+  {
+    const float array[] = {static_cast<float>(values)...};
+    return sizeof...(Ts) == mAxes.size() ? getCategory(array) : -1;
+  }
+
+  /// Categories of all the rows of a table (e.g. collisions)
+  /// \param table Table to be looped over
+  /// \param categories Output, one category per row
+  /// \param getters One callable per axis, returning the value of the axis for a row
+  template <typename TTable, typename... TGetters>
+  void getCategories(TTable const& table, std::vector<int>& categories, TGetters const&... getters) const
+  {
+    categories.resize(table.size());
+    size_t row = 0;
+    for (auto const& element : table) {
+      categories[row++] = getCategoryOf(getters(element)...);
+    }
+  }
+
+  /// \return Bin in the given axis of a category
+  int getBinFromCategory(int axis, int category) const
+  {
+    if (category < 0) {
+      return -1;
+    }
+    return (category / mStrides[axis]) % mAxes[axis].nBins;
+  }
+
+ private:
+  struct Axis {
+    std::vector<float> edges; ///< bin edges
+    int nBins = 0;            ///< number of bins
+    bool isUniform = false;   ///< whether the edges are equidistant
+    float invWidth = 0.f;     ///< inverse of the bin width, for equidistant edges
+  };
+
+  std::vector<Axis> mAxes;   ///< axes
+  std::vector<int> mStrides; ///< stride of each axis in the category
+  int mNCategories = 0;      ///< total number of categories
+};
 }; // namespace eventmixing
 
 #endif /* ANALYSIS_CORE_EVENTMIXING_H_ */
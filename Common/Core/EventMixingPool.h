@@ -0,0 +1,206 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  EventMixingPool.h
+/// \brief Pools of pre-selected tracks of past events, per mixing category, to build mixed-event pairs
+///
+/// The selected tracks of an event are copied once into a compact block (kinematics, sign and selection
+/// bitmask, one array per quantity, optionally followed by per-track values precomputed once), together with
+/// the event-level values needed when filling the pairs.
+/// Each category keeps a FIFO of at most "depth" such blocks: the current event is paired directly with the
+/// blocks of its category, then takes the place of the oldest one. Tracks are thus read and selected once,
+/// whatever the number of mixed events they take part in, and the memory is bounded by the depth.
+///
+
+#ifndef ANALYSIS_CORE_EVENTMIXINGPOOL_H_
+#define ANALYSIS_CORE_EVENTMIXINGPOOL_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace eventmixing
+{
+class PoolEvent;
+
+/// \class PoolTrack
+/// \brief View of a track stored in a PoolEvent, with the accessors used by the pair fill functions
+class PoolTrack
+{
+ public:
+  PoolTrack(const PoolEvent* event, int index) : mEvent(event), mIndex(index) {}
+
+  float pt() const;
+  float eta() const;
+  float phi() const;
+  int sign() const;
+  uint32_t mask() const;
+  /// Per-track values added with PoolEvent::addTrackValues
+  const float* values() const;
+  int index() const { return mIndex; }
+
+ private:
+  const PoolEvent* mEvent; ///< event holding the track
+  int mIndex;              ///< position of the track in the event
+};
+
+/// \class PoolEvent
+/// \brief Compact copy of the selected tracks of an event and of its event-level values
+class PoolEvent
+{
+ public:
+  class iterator
+  {
+   public:
+    iterator(const PoolEvent* event, int index) : mEvent(event), mIndex(index) {}
+    PoolTrack operator*() const { return PoolTrack(mEvent, mIndex); }
+    iterator& operator++()
+    {
+      ++mIndex;
+      return *this;
+    }
+    bool operator!=(const iterator& other) const { return mIndex != other.mIndex; }
+
+   private:
+    const PoolEvent* mEvent;
+    int mIndex;
+  };
+
+  /// Remove the tracks and values, keeping the allocated memory
+  void clear()
+  {
+    mPt.clear();
+    mEta.clear();
+    mPhi.clear();
+    mSign.clear();
+    mMask.clear();
+    mTrackValues.clear();
+    mValues.clear();
+  }
+
+  void addTrack(float pt, float eta, float phi, int sign, uint32_t mask)
+  {
+    mPt.push_back(pt);
+    mEta.push_back(eta);
+    mPhi.push_back(phi);
+    mSign.push_back(sign);
+    mMask.push_back(mask);
+  }
+  /// Add values to the last added track (e.g. quantities computed once per track and used by all its pairs),
+  /// the same number of values being added to all the tracks
+  void addTrackValues(const float* values, int nValues)
+  {
+    mNTrackValues = nValues;
+    mTrackValues.insert(mTrackValues.end(), values, values + nValues);
+  }
+  void addValue(float value) { mValues.push_back(value); }
+
+  int size() const { return mPt.size(); }
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size()); }
+  PoolTrack operator[](int index) const { return PoolTrack(this, index); }
+
+  float pt(int index) const { return mPt[index]; }
+  float eta(int index) const { return mEta[index]; }
+  float phi(int index) const { return mPhi[index]; }
+  int sign(int index) const { return mSign[index]; }
+  uint32_t mask(int index) const { return mMask[index]; }
+  const float* trackValues(int index) const { return mTrackValues.data() + index * mNTrackValues; }
+  /// Event-level values, in the order in which they were added
+  const std::vector<float>& values() const { return mValues; }
+
+ private:
+  std::vector<float> mPt;
+  std::vector<float> mEta;
+  std::vector<float> mPhi;
+  std::vector<int8_t> mSign;
+  std::vector<uint32_t> mMask;     ///< selection bitmask
+  std::vector<float> mTrackValues; ///< per-track values, mNTrackValues per track
+  int mNTrackValues = 0;           ///< number of values per track
+  std::vector<float> mValues;      ///< event-level values
+};
+
+inline float PoolTrack::pt() const { return mEvent->pt(mIndex); }
+inline float PoolTrack::eta() const { return mEvent->eta(mIndex); }
+inline float PoolTrack::phi() const { return mEvent->phi(mIndex); }
+inline int PoolTrack::sign() const { return mEvent->sign(mIndex); }
+inline uint32_t PoolTrack::mask() const { return mEvent->mask(mIndex); }
+inline const float* PoolTrack::values() const { return mEvent->trackValues(mIndex); }
+
+/// \class MixingPool
+/// \brief FIFO of at most depth events per mixing category
+class MixingPool
+{
+ public:
+  MixingPool() = default;
+  explicit MixingPool(int depth) : mDepth(depth) {}
+
+  void setDepth(int depth)
+  {
+    mDepth = depth;
+    clear();
+  }
+  int getDepth() const { return mDepth; }
+
+  /// Forget all the stored events, keeping the allocated memory
+  void clear()
+  {
+    for (auto& [category, fifo] : mCategories) {
+      fifo.nEvents = 0;
+      fifo.next = 0;
+    }
+  }
+
+  /// \return Number of events stored for the category
+  int getNEvents(int category) const
+  {
+    auto found = mCategories.find(category);
+    return found == mCategories.end() ? 0 : found->second.nEvents;
+  }
+
+  /// \return Stored event of the category, 0 <= index < getNEvents(category)
+  const PoolEvent& getEvent(int category, int index) const { return mCategories.at(category).events[index]; }
+
+  /// Move the event into the pool of the category, in place of the oldest one if the pool is full
+  /// \param event Event to be stored, replaced by a cleared event (reusing the memory of the dropped one)
+  void addEvent(int category, PoolEvent& event)
+  {
+    if (mDepth <= 0) {
+      event.clear();
+      return;
+    }
+    auto& fifo = mCategories[category];
+    if (static_cast<int>(fifo.events.size()) < mDepth) {
+      fifo.events.resize(mDepth);
+    }
+    std::swap(fifo.events[fifo.next], event);
+    event.clear();
+    fifo.next = (fifo.next + 1) % mDepth;
+    if (fifo.nEvents < mDepth) {
+      ++fifo.nEvents;
+    }
+  }
+
+ private:
+  struct Fifo {
+    std::vector<PoolEvent> events; ///< ring buffer of events
+    int nEvents = 0;               ///< number of stored events
+    int next = 0;                  ///< slot of the next event
+  };
+
+  int mDepth = 0;                             ///< maximum number of events per category
+  std::unordered_map<int, Fifo> mCategories; ///< events per category
+};
+}; // namespace eventmixing
+
+#endif /* ANALYSIS_CORE_EVENTMIXINGPOOL_H_ */
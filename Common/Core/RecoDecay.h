@@ -20,7 +20,10 @@
 #include <tuple>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
 #include <utility>
 
 #include <TDatabasePDG.h>
@@ -522,52 +525,62 @@ class RecoDecay
     return maxNormDeltaIP;
   }
 
-  /// Adds particle mass in the list.
+  /// Returns the mass of the particles which cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt).
   /// \param pdg  PDG code
-  /// \param mass  particle mass
-  static void addMassPDG(int pdg, double mass)
+  /// \return particle mass, negative if the mass is to be taken from ROOT
+  static constexpr double getMassPDGNotInROOT(int pdg)
   {
-    mListMass.push_back(std::make_tuple(pdg, mass));
+    switch (pdg) {
+      case 4422:        // Ξcc (wrong mass in ROOT)
+        return 3.62155; // https://pdg.lbl.gov/ (2021)
+      case 9920443:     // χc1 aka X(3872)
+        return 3.87165; // https://pdg.lbl.gov/ (2021)
+      case 4332:        // Ω0c (wrong mass in ROOT)
+        return 2.6952;  // https://pdg.lbl.gov/ (2022)
+      default:
+        return -1.;
+    }
+  }
+
+  /// Returns particle mass based on PDG code.
+  /// The mass is cached per particle species in a function-local static at the first call.
+  /// \tparam pdg  PDG code
+  /// \return particle mass
+  template <int pdg>
+  static double getMassPDG()
+  {
+    static const double mass = getMassPDG(pdg);
+    return mass;
   }
 
   /// Returns particle mass based on PDG code.
+  /// The masses are taken from ROOT once and kept in a hash cache which is read without locking.
+  /// The lookup of a particle missing in the cache is serialised, since TDatabasePDG is not thread-safe.
   /// \param pdg  PDG code
   /// \return particle mass
   static double getMassPDG(int pdg)
   {
-    // Try to get the particle mass from the list first.
-    for (const auto& particle : mListMass) {
-      if (std::get<0>(particle) == pdg) {
-        return std::get<1>(particle);
-      }
+    // Try to get the particle mass from the cache first.
+    auto iSlot = findMassSlot(pdg);
+    if (iSlot >= 0 && mMassCache[iSlot].ready.load(std::memory_order_acquire)) {
+      return mMassCache[iSlot].mass.load(std::memory_order_relaxed);
     }
-    // Get the mass of the new particle and add it in the list.
-    double mass = 0.;
-    switch (pdg) {
-      // Particles that cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt)
-      case 4422: {      // Ξcc (wrong mass in ROOT)
-        mass = 3.62155; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      case 9920443: {   // χc1 aka X(3872)
-        mass = 3.87165; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      case 4332: {     // Ω0c (wrong mass in ROOT)
-        mass = 2.6952; // https://pdg.lbl.gov/ (2022)
-        break;
-      }
-      // Take the rest from ROOT.
-      default: {
-        const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
-        if (!particle) { // Check that it's there.
-          LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
-          return 999.;
-        }
-        mass = particle->Mass();
+    // Get the mass of the new particle and add it in the cache.
+    std::lock_guard<std::mutex> lock(mMutexMassPDG);
+    iSlot = findMassSlot(pdg); // another thread may have cached it in the meantime
+    if (iSlot >= 0 && mMassCache[iSlot].ready.load(std::memory_order_acquire)) {
+      return mMassCache[iSlot].mass.load(std::memory_order_relaxed);
+    }
+    double mass = getMassPDGNotInROOT(pdg);
+    if (mass < 0.) { // Take the rest from ROOT.
+      const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
+      if (!particle) { // Check that it's there.
+        LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
+        return 999.;
       }
+      mass = particle->Mass();
     }
-    addMassPDG(pdg, mass);
+    cacheMassPDG(pdg, mass);
     return mass;
   }
 
@@ -989,9 +1002,59 @@ class RecoDecay
   }
 
  private:
-  static std::vector<std::tuple<int, double>> mListMass; ///< list of particle masses in form (PDG code, mass)
-};
+  static constexpr int NMassCacheSlots = 1024; ///< size of the PDG mass cache, power of 2
+
+  /// Slot of the PDG mass cache, empty while pdg is 0, valid once ready is set
+  struct MassCacheSlot {
+    std::atomic<int> pdg;
+    std::atomic<double> mass;
+    std::atomic<bool> ready;
+  };
 
-std::vector<std::tuple<int, double>> RecoDecay::mListMass;
+  /// Finds the slot of the PDG mass cache holding a particle (open addressing with linear probing).
+  /// \param pdg  PDG code
+  /// \param insert  whether to claim an empty slot for the particle if it is not in the cache
+  /// \return slot index, -1 if the particle is not found (and cannot be inserted)
+  static int findMassSlot(int pdg, bool insert = false)
+  {
+    auto hash = static_cast<uint32_t>(pdg) * 2654435761u; // Knuth multiplicative hash
+    auto iSlot = static_cast<int>(hash >> 22);             // top 10 bits, NMassCacheSlots = 2^10
+    for (int iProbe = 0; iProbe < NMassCacheSlots; ++iProbe) {
+      auto& slot = mMassCache[iSlot];
+      int slotPdg = slot.pdg.load(std::memory_order_acquire);
+      if (slotPdg == pdg) {
+        return iSlot;
+      }
+      if (slotPdg == 0) {
+        if (!insert) {
+          return -1;
+        }
+        // Claim the empty slot, unless another thread got it first for this or another particle.
+        if (slot.pdg.compare_exchange_strong(slotPdg, pdg, std::memory_order_acq_rel) || slotPdg == pdg) {
+          return iSlot;
+        }
+      }
+      iSlot = (iSlot + 1) & (NMassCacheSlots - 1);
+    }
+    return -1;
+  }
+
+  /// Adds particle mass in the cache.
+  /// \param pdg  PDG code
+  /// \param mass  particle mass
+  static void cacheMassPDG(int pdg, double mass)
+  {
+    auto iSlot = findMassSlot(pdg, true);
+    if (iSlot < 0) {
+      LOGF(warning, "PDG mass cache full, mass of PDG code %i not cached", pdg);
+      return;
+    }
+    mMassCache[iSlot].mass.store(mass, std::memory_order_relaxed);
+    mMassCache[iSlot].ready.store(true, std::memory_order_release);
+  }
+
+  inline static std::array<MassCacheSlot, NMassCacheSlots> mMassCache{}; ///< cache of particle masses
+  inline static std::mutex mMutexMassPDG;                                 ///< serialises the lookup of the masses missing in the cache
+};
 
 #endif // COMMON_CORE_RECODECAY_H_
@@ -263,6 +263,8 @@ class TrackSelection
   void ResetITSRequirements() { mRequiredITSHits.clear(); }
 
  private:
+  friend class TrackSelectionFused; // evaluates the cuts of several selections in one pass
+
   bool FulfillsITSHitRequirements(uint8_t itsClusterMap);
 
   o2::aod::track::TrackTypeEnum mTrackType{o2::aod::track::TrackTypeEnum::Track};
@@ -0,0 +1,227 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  TrackSelectionFused.cxx
+/// \brief Evaluation of a set of track selections in one pass over a track table
+///
+
+#include "Common/Core/TrackSelectionFused.h"
+
+#include <algorithm>
+
+using TrackCuts = TrackSelection::TrackCuts;
+
+TrackSelectionFused::UniqueCut TrackSelectionFused::MakeCut(int selection, TrackCuts cut)
+{
+  auto& sel = mSelections[selection];
+  UniqueCut uniqueCut;
+  uniqueCut.cut = cut;
+
+  switch (cut) {
+    case TrackCuts::kTrackType:
+      uniqueCut.threshold = static_cast<int>(sel.mTrackType);
+      break;
+    case TrackCuts::kPtRange:
+      uniqueCut.min = sel.mMinPt;
+      uniqueCut.max = sel.mMaxPt;
+      break;
+    case TrackCuts::kEtaRange:
+      uniqueCut.min = sel.mMinEta;
+      uniqueCut.max = sel.mMaxEta;
+      break;
+    case TrackCuts::kTPCNCls:
+      uniqueCut.threshold = sel.mMinNClustersTPC;
+      break;
+    case TrackCuts::kTPCCrossedRows:
+      uniqueCut.threshold = sel.mMinNCrossedRowsTPC;
+      break;
+    case TrackCuts::kTPCCrossedRowsOverNCls:
+      uniqueCut.min = sel.mMinNCrossedRowsOverFindableClustersTPC;
+      break;
+    case TrackCuts::kTPCChi2NDF:
+      uniqueCut.max = sel.mMaxChi2PerClusterTPC;
+      break;
+    case TrackCuts::kTPCRefit:
+      uniqueCut.required = sel.mRequireTPCRefit;
+      break;
+    case TrackCuts::kITSNCls:
+      uniqueCut.threshold = sel.mMinNClustersITS;
+      break;
+    case TrackCuts::kITSChi2NDF:
+      uniqueCut.max = sel.mMaxChi2PerClusterITS;
+      break;
+    case TrackCuts::kITSRefit:
+      uniqueCut.required = sel.mRequireITSRefit;
+      break;
+    case TrackCuts::kITSHits:
+      uniqueCut.itsHits = sel.mRequiredITSHits;
+      for (int clusterMap = 0; clusterMap < 256; ++clusterMap) {
+        uniqueCut.itsHitsLUT[clusterMap] = sel.FulfillsITSHitRequirements(clusterMap);
+      }
+      break;
+    case TrackCuts::kGoldenChi2:
+      uniqueCut.required = sel.mRequireGoldenChi2;
+      break;
+    case TrackCuts::kDCAxy:
+      if (sel.mMaxDcaXYPtDep) {
+        uniqueCut.ptDepSelection = selection;
+      } else {
+        uniqueCut.max = sel.mMaxDcaXY;
+      }
+      break;
+    case TrackCuts::kDCAz:
+      uniqueCut.max = sel.mMaxDcaZ;
+      break;
+    default:
+      break;
+  }
+  return uniqueCut;
+}
+
+void TrackSelectionFused::Compile()
+{
+  if (mCompiled) {
+    return;
+  }
+  mUniqueCuts.clear();
+  mCutIndex.assign(mSelections.size() * NCuts, -1);
+  for (int selection = 0; selection < static_cast<int>(mSelections.size()); ++selection) {
+    for (int cut = 0; cut < NCuts; ++cut) {
+      auto uniqueCut = MakeCut(selection, static_cast<TrackCuts>(cut));
+      auto found = std::find(mUniqueCuts.begin(), mUniqueCuts.end(), uniqueCut);
+      if (found == mUniqueCuts.end()) {
+        found = mUniqueCuts.insert(mUniqueCuts.end(), std::move(uniqueCut));
+      }
+      mCutIndex[selection * NCuts + cut] = std::distance(mUniqueCuts.begin(), found);
+    }
+  }
+  mCompiled = true;
+}
+
+void TrackSelectionFused::EvaluateCuts()
+{
+  const int64_t n = mNTracks;
+  mCutResults.resize(mUniqueCuts.size() * n);
+
+  for (size_t iCut = 0; iCut < mUniqueCuts.size(); ++iCut) {
+    const auto& uniqueCut = mUniqueCuts[iCut];
+    uint8_t* result = mCutResults.data() + iCut * n;
+    const float min = uniqueCut.min;
+    const float max = uniqueCut.max;
+    const int threshold = uniqueCut.threshold;
+    const uint8_t notRequired = !uniqueCut.required;
+
+    // the loops below are kept free of branches so that they can be vectorised
+    switch (uniqueCut.cut) {
+      case TrackCuts::kTrackType:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mTrackType[i] == threshold;
+        }
+        break;
+      case TrackCuts::kPtRange:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = (mPt[i] >= min) & (mPt[i] <= max);
+        }
+        break;
+      case TrackCuts::kEtaRange:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = (mEta[i] >= min) & (mEta[i] <= max);
+        }
+        break;
+      case TrackCuts::kTPCNCls:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mTPCNCls[i] >= threshold;
+        }
+        break;
+      case TrackCuts::kTPCCrossedRows:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mTPCCrossedRows[i] >= threshold;
+        }
+        break;
+      case TrackCuts::kTPCCrossedRowsOverNCls:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mTPCCrossedRowsOverFindableCls[i] >= min;
+        }
+        break;
+      case TrackCuts::kTPCChi2NDF:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mTPCChi2NCl[i] <= max;
+        }
+        break;
+      case TrackCuts::kTPCRefit:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = notRequired | mTPCRefit[i];
+        }
+        break;
+      case TrackCuts::kITSNCls:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mITSNCls[i] >= threshold;
+        }
+        break;
+      case TrackCuts::kITSChi2NDF:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mITSChi2NCl[i] <= max;
+        }
+        break;
+      case TrackCuts::kITSRefit:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = notRequired | mITSRefit[i];
+        }
+        break;
+      case TrackCuts::kITSHits:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = uniqueCut.itsHitsLUT[mITSClusterMap[i]];
+        }
+        break;
+      case TrackCuts::kGoldenChi2:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = notRequired | mGoldenChi2[i];
+        }
+        break;
+      case TrackCuts::kDCAxy:
+        if (uniqueCut.ptDepSelection >= 0) {
+          const auto& maxDcaXYPtDep = mSelections[uniqueCut.ptDepSelection].mMaxDcaXYPtDep;
+          for (int64_t i = 0; i < n; ++i) {
+            result[i] = mDcaXY[i] <= maxDcaXYPtDep(mPt[i]);
+          }
+        } else {
+          for (int64_t i = 0; i < n; ++i) {
+            result[i] = mDcaXY[i] <= max;
+          }
+        }
+        break;
+      case TrackCuts::kDCAz:
+        for (int64_t i = 0; i < n; ++i) {
+          result[i] = mDcaZ[i] <= max;
+        }
+        break;
+      default:
+        std::fill(result, result + n, 0);
+        break;
+    }
+  }
+}
+
+void TrackSelectionFused::BuildMasks()
+{
+  const int64_t n = mNTracks;
+  mMasks.assign(mSelections.size() * n, 0);
+  for (size_t selection = 0; selection < mSelections.size(); ++selection) {
+    uint16_t* mask = mMasks.data() + selection * n;
+    for (int cut = 0; cut < NCuts; ++cut) {
+      const uint8_t* result = mCutResults.data() + mCutIndex[selection * NCuts + cut] * n;
+      for (int64_t i = 0; i < n; ++i) {
+        mask[i] |= static_cast<uint16_t>(result[i]) << cut;
+      }
+    }
+  }
+}
@@ -0,0 +1,168 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  TrackSelectionFused.h
+/// \brief Evaluation of a set of track selections in one pass over a track table
+///
+/// The cuts of all the added TrackSelection objects are compiled into a list of
+/// unique cuts: cuts with identical parameters in several selections are evaluated
+/// only once. The track properties are gathered in columns, each unique cut is then
+/// evaluated with a branch-free loop over its column and the per-selection masks
+/// (same content as TrackSelection::IsSelectedMask) are assembled from the results.
+///
+
+#ifndef COMMON_CORE_TRACKSELECTIONFUSED_H_
+#define COMMON_CORE_TRACKSELECTIONFUSED_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+#include "Framework/DataTypes.h"
+#include "Common/Core/TrackSelection.h"
+
+class TrackSelectionFused
+{
+ public:
+  TrackSelectionFused() = default;
+
+  static constexpr int NCuts = static_cast<int>(TrackSelection::TrackCuts::kNCuts);
+  static constexpr uint16_t AllCutsMask = (1 << NCuts) - 1;
+
+  // Add a copy of the selection, returns its index to be used in GetMask and IsSelected
+  int AddSelection(const TrackSelection& selection)
+  {
+    mSelections.push_back(selection);
+    mCompiled = false;
+    return static_cast<int>(mSelections.size()) - 1;
+  }
+
+  int GetNSelections() const { return mSelections.size(); }
+  // Number of cuts actually evaluated per track, after removing the duplicates
+  int GetNUniqueCuts()
+  {
+    Compile();
+    return mUniqueCuts.size();
+  }
+
+  // Evaluate all the selections for all the tracks of the table
+  template <typename T>
+  void Evaluate(T const& tracks)
+  {
+    Compile();
+    FillColumns(tracks);
+    EvaluateCuts();
+    BuildMasks();
+  }
+
+  int64_t GetNTracks() const { return mNTracks; }
+  // Same as TrackSelection::IsSelectedMask for the track in the given row of the last evaluated table
+  uint16_t GetMask(int selection, int64_t row) const { return mMasks[selection * mNTracks + row]; }
+  // Same as TrackSelection::IsSelected for the track in the given row of the last evaluated table
+  bool IsSelected(int selection, int64_t row) const { return GetMask(selection, row) == AllCutsMask; }
+
+ private:
+  // cut with its parameters, shared by all the selections using the same parameters
+  struct UniqueCut {
+    TrackSelection::TrackCuts cut;
+    float min{0.f};                                           // lower bound for float cuts
+    float max{0.f};                                           // upper bound for float cuts
+    int threshold{0};                                         // bound for integer cuts (track type, number of clusters)
+    bool required{false};                                     // refit and golden chi2 requirements
+    std::vector<std::pair<int8_t, std::set<uint8_t>>> itsHits; // ITS hit requirements
+    int ptDepSelection{-1};                                   // selection providing a pT dependent DCAxy cut, never shared
+    std::array<uint8_t, 256> itsHitsLUT{};                    // ITS hit requirements result per cluster map
+
+    bool operator==(const UniqueCut& other) const
+    {
+      return cut == other.cut && min == other.min && max == other.max && threshold == other.threshold && required == other.required && itsHits == other.itsHits && ptDepSelection < 0 && other.ptDepSelection < 0;
+    }
+  };
+
+  void Compile();
+  UniqueCut MakeCut(int selection, TrackSelection::TrackCuts cut);
+  void EvaluateCuts();
+  void BuildMasks();
+
+  template <typename T>
+  void FillColumns(T const& tracks)
+  {
+    mNTracks = tracks.size();
+    mTrackType.resize(mNTracks);
+    mPt.resize(mNTracks);
+    mEta.resize(mNTracks);
+    mTPCNCls.resize(mNTracks);
+    mTPCCrossedRows.resize(mNTracks);
+    mTPCCrossedRowsOverFindableCls.resize(mNTracks);
+    mTPCChi2NCl.resize(mNTracks);
+    mTPCRefit.resize(mNTracks);
+    mITSNCls.resize(mNTracks);
+    mITSChi2NCl.resize(mNTracks);
+    mITSRefit.resize(mNTracks);
+    mITSClusterMap.resize(mNTracks);
+    mGoldenChi2.resize(mNTracks);
+    mDcaXY.resize(mNTracks);
+    mDcaZ.resize(mNTracks);
+
+    int64_t row = 0;
+    for (auto& track : tracks) {
+      const bool isRun2 = track.trackType() == o2::aod::track::Run2Track || track.trackType() == o2::aod::track::Run2Tracklet;
+      mTrackType[row] = track.trackType();
+      mPt[row] = track.pt();
+      mEta[row] = track.eta();
+      mTPCNCls[row] = track.tpcNClsFound();
+      mTPCCrossedRows[row] = track.tpcNClsCrossedRows();
+      mTPCCrossedRowsOverFindableCls[row] = track.tpcCrossedRowsOverFindableCls();
+      mTPCChi2NCl[row] = track.tpcChi2NCl();
+      mTPCRefit[row] = isRun2 ? ((track.flags() & o2::aod::track::TPCrefit) != 0) : track.hasTPC();
+      mITSNCls[row] = track.itsNCls();
+      mITSChi2NCl[row] = track.itsChi2NCl();
+      mITSRefit[row] = isRun2 ? ((track.flags() & o2::aod::track::ITSrefit) != 0) : track.hasITS();
+      mITSClusterMap[row] = track.itsClusterMap();
+      mGoldenChi2[row] = isRun2 ? ((track.flags() & o2::aod::track::GoldenChi2) != 0) : true; // the golden chi2 cut only applies to Run 2 tracks
+      mDcaXY[row] = std::abs(track.dcaXY());
+      mDcaZ[row] = std::abs(track.dcaZ());
+      ++row;
+    }
+  }
+
+  std::vector<TrackSelection> mSelections{}; // copies of the added selections
+  bool mCompiled{false};                     // whether the unique cuts are up to date with the selections
+
+  std::vector<UniqueCut> mUniqueCuts{};    // cuts evaluated per track
+  std::vector<int> mCutIndex{};            // unique cut used for each (selection, cut), NCuts entries per selection
+  std::vector<uint8_t> mCutResults{};      // result of each unique cut, mNTracks entries per unique cut
+  std::vector<uint16_t> mMasks{};          // mask of each selection, mNTracks entries per selection
+
+  // track columns
+  int64_t mNTracks{0};
+  std::vector<uint8_t> mTrackType{};
+  std::vector<float> mPt{};
+  std::vector<float> mEta{};
+  std::vector<int> mTPCNCls{};
+  std::vector<int> mTPCCrossedRows{};
+  std::vector<float> mTPCCrossedRowsOverFindableCls{};
+  std::vector<float> mTPCChi2NCl{};
+  std::vector<uint8_t> mTPCRefit{};
+  std::vector<int> mITSNCls{};
+  std::vector<float> mITSChi2NCl{};
+  std::vector<uint8_t> mITSRefit{};
+  std::vector<uint8_t> mITSClusterMap{};
+  std::vector<uint8_t> mGoldenChi2{};
+  std::vector<float> mDcaXY{}; // absolute value
+  std::vector<float> mDcaZ{};  // absolute value
+};
+
+#endif // COMMON_CORE_TRACKSELECTIONFUSED_H_
@@ -12,8 +12,14 @@
 #include <map>
 #include <list>
 #include <fstream>
+#include <deque>
+#include <future>
+#include <vector>
 #include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
 
+#include "TROOT.h"
 #include "TSystem.h"
 #include "TFile.h"
 #include "TTree.h"
@@ -63,6 +69,19 @@ const char* getTableName(const char* branchName, const char* treeName)
   return tableName;
 }
 
+TFile* openInputFile(const TString& fileName, bool readAhead)
+{
+  // asks the kernel to read local files in the background, before their baskets are needed
+  if (readAhead && !fileName.Contains(":")) {
+    int fd = open(fileName.Data(), O_RDONLY);
+    if (fd >= 0) {
+      posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+      close(fd);
+    }
+  }
+  return TFile::Open(fileName);
+}
+
 // AOD merger with correct index rewriting
 // No need to know the datamodel because the branch names follow a canonical standard (identified by fIndex)
 int main(int argc, char* argv[])
@@ -71,6 +90,9 @@ int main(int argc, char* argv[])
   std::string outputFileName("AO2D.root");
   long maxDirSize = 100000000;
   bool skipNonExistingFiles = false;
+  bool fastCopy = true;
+  int nThreads = 0;
+  int nPrefetch = 0;
   int exitCode = 0; // 0: success, >0: failure
 
   int option_index = 0;
@@ -79,7 +101,10 @@ int main(int argc, char* argv[])
     {"output", required_argument, nullptr, 1},
     {"max-size", required_argument, nullptr, 2},
     {"skip-non-existing-files", no_argument, nullptr, 3},
-    {"help", no_argument, nullptr, 4},
+    {"no-fast-copy", no_argument, nullptr, 4},
+    {"threads", required_argument, nullptr, 5},
+    {"prefetch", required_argument, nullptr, 6},
+    {"help", no_argument, nullptr, 7},
     {nullptr, 0, nullptr, 0}};
 
   while (true) {
@@ -95,11 +120,20 @@ int main(int argc, char* argv[])
     } else if (c == 3) {
       skipNonExistingFiles = true;
     } else if (c == 4) {
+      fastCopy = false;
+    } else if (c == 5) {
+      nThreads = atoi(optarg);
+    } else if (c == 6) {
+      nPrefetch = atoi(optarg);
+    } else if (c == 7) {
       printf("AO2D merging tool. Options: \n");
       printf("  --input <inputfile.txt>      Contains path to files to be merged. Default: %s\n", inputCollection.c_str());
       printf("  --output <outputfile.root>   Target output ROOT file. Default: %s\n", outputFileName.c_str());
       printf("  --max-size <size in Bytes>   Target directory size. Default: %ld. Set to 0 if file is not self-contained.\n", maxDirSize);
       printf("  --skip-non-existing-files    Flag to allow skipping of non-existing files in the input list.\n");
+      printf("  --no-fast-copy               Always copy entry by entry, also for trees which do not need any index rewriting.\n");
+      printf("  --threads <n>                Number of threads for the decompression of the input and the compression of the output. Default: %d (single-threaded)\n", nThreads);
+      printf("  --prefetch <n>               Number of input files opened and read ahead in background threads. Default: %d\n", nPrefetch);
       return -1;
     } else {
       return -2;
@@ -113,6 +147,17 @@ int main(int argc, char* argv[])
   if (skipNonExistingFiles) {
     printf("  WARNING: Skipping non-existing files.\n");
   }
+  if (!fastCopy) {
+    printf("  Fast copy of compressed baskets disabled.\n");
+  }
+  if (nThreads > 0) {
+    printf("  Threads for (de)compression: %d\n", nThreads);
+    ROOT::EnableImplicitMT(nThreads);
+  }
+  if (nPrefetch > 0) {
+    printf("  Input files read ahead: %d\n", nPrefetch);
+    ROOT::EnableThreadSafety();
+  }
 
   std::map<std::string, TTree*> trees;
   std::map<std::string, int> offsets;
@@ -125,27 +170,48 @@ int main(int argc, char* argv[])
   std::ifstream in;
   in.open(inputCollection);
   TString line;
+  std::vector<TString> inputFiles;
   bool connectedToAliEn = false;
-  TMap* metaData = nullptr;
-  TMap* parentFiles = nullptr;
-  int totalMergedDFs = 0;
-  int mergedDFs = 0;
-  while (in.good() && exitCode == 0) {
+  while (in.good()) {
     in >> line;
 
     if (line.Length() == 0) {
       continue;
     }
 
+    // connect before any file is opened, possibly by the read-ahead threads
     if (line.BeginsWith("alien:") && !connectedToAliEn) {
       printf("Connecting to AliEn...");
       TGrid::Connect("alien:");
       connectedToAliEn = true; // Only try once
     }
+    inputFiles.push_back(line);
+  }
+
+  // Input files are opened in input order, up to nPrefetch files ahead of the one being merged.
+  // Without read-ahead the opening is deferred to the merging loop, as before.
+  std::deque<std::future<TFile*>> openedFiles;
+  size_t nextFileToOpen = 0;
+  auto openAhead = [&]() {
+    while (nextFileToOpen < inputFiles.size() && openedFiles.size() <= static_cast<size_t>(nPrefetch)) {
+      auto fileName = inputFiles[nextFileToOpen++];
+      auto policy = nPrefetch > 0 ? std::launch::async : std::launch::deferred;
+      openedFiles.push_back(std::async(policy, openInputFile, fileName, nPrefetch > 0));
+    }
+  };
+
+  TMap* metaData = nullptr;
+  TMap* parentFiles = nullptr;
+  int totalMergedDFs = 0;
+  int mergedDFs = 0;
+  for (size_t iFile = 0; iFile < inputFiles.size() && exitCode == 0; ++iFile) {
+    line = inputFiles[iFile];
+    openAhead();
+    auto inputFile = openedFiles.front().get();
+    openedFiles.pop_front();
 
     printf("Processing input file: %s\n", line.Data());
 
-    auto inputFile = TFile::Open(line);
     if (!inputFile) {
       printf("Error: Could not open input file %s.\n", line.Data());
       if (skipNonExistingFiles) {
@@ -272,6 +338,7 @@ int main(int argc, char* argv[])
         std::vector<std::pair<int*, int>> indexList;
         std::vector<char*> vlaPointers;
         std::vector<int*> indexPointers;
+        std::vector<TBranch*> indexBranches;
         TObjArray* branches = inputTree->GetListOfBranches();
         for (int i = 0; i < branches->GetEntriesFast(); ++i) {
           TBranch* br = (TBranch*)branches->UncheckedAt(i);
@@ -295,6 +362,7 @@ int main(int argc, char* argv[])
             outputTree->SetBranchAddress(br->GetName(), buffer);
 
             if (branchName.BeginsWith("fIndexArray")) {
+              indexBranches.push_back(br);
               for (int i = 0; i < maximum; i++) {
                 indexList.push_back({reinterpret_cast<int*>(buffer + i * typeSize), offsets[getTableName(branchName, treeName)]});
               }
@@ -306,6 +374,7 @@ int main(int argc, char* argv[])
 
             inputTree->SetBranchAddress(br->GetName(), buffer);
             outputTree->SetBranchAddress(br->GetName(), buffer);
+            indexBranches.push_back(br);
 
             indexList.push_back({buffer, offsets[getTableName(branchName, treeName)]});
             indexList.push_back({buffer + 1, offsets[getTableName(branchName, treeName)]});
@@ -316,6 +385,7 @@ int main(int argc, char* argv[])
 
             inputTree->SetBranchAddress(br->GetName(), buffer);
             outputTree->SetBranchAddress(br->GetName(), buffer);
+            indexBranches.push_back(br);
 
             indexList.push_back({buffer, offsets[getTableName(branchName, treeName)]});
           }
@@ -324,24 +394,49 @@ int main(int argc, char* argv[])
         auto entries = inputTree->GetEntries();
         int minIndexOffset = unassignedIndexOffset[treeName];
         auto newMinIndexOffset = minIndexOffset;
-        for (int i = 0; i < entries; i++) {
-          for (auto& index : indexList) {
-            *(index.first) = 0; // Any positive number will do, in any case it will not be filled in the output. Otherwise the previous entry is used and manipulated in the following.
-          }
-          inputTree->GetEntry(i);
-          // shift index columns by offset
-          for (const auto& idx : indexList) {
-            // if negative, the index is unassigned. In this case, the different unassigned blocks have to get unique negative IDs
-            if (*(idx.first) < 0) {
-              *(idx.first) += minIndexOffset;
+
+        // If no index of this tree has to be shifted (no index column, or first DF of the output folder with no
+        // unassigned index block before), the entries are copied as compressed baskets without being decompressed.
+        // Only the index columns are read, to find the unassigned (negative) indices which define the offset for the next DF.
+        bool shiftIndices = (minIndexOffset != 0);
+        for (const auto& idx : indexList) {
+          shiftIndices |= (idx.second != 0);
+        }
+        if (fastCopy && !shiftIndices) {
+          for (int i = 0; i < entries; i++) {
+            for (auto& index : indexList) {
+              *(index.first) = 0;
+            }
+            for (auto& br : indexBranches) {
+              br->GetEntry(i);
+            }
+            for (const auto& idx : indexList) {
               newMinIndexOffset = std::min(newMinIndexOffset, *(idx.first));
-            } else {
-              *(idx.first) += idx.second;
             }
           }
-          int nbytes = outputTree->Fill();
-          if (nbytes > 0) {
-            currentDirSize += nbytes;
+          // falls back internally to an entry-by-entry copy if the baskets cannot be copied (e.g. different branch layout)
+          outputTree->CopyEntries(inputTree, -1, "fast");
+          currentDirSize += inputTree->GetTotBytes();
+        } else {
+          for (int i = 0; i < entries; i++) {
+            for (auto& index : indexList) {
+              *(index.first) = 0; // Any positive number will do, in any case it will not be filled in the output. Otherwise the previous entry is used and manipulated in the following.
+            }
+            inputTree->GetEntry(i);
+            // shift index columns by offset
+            for (const auto& idx : indexList) {
+              // if negative, the index is unassigned. In this case, the different unassigned blocks have to get unique negative IDs
+              if (*(idx.first) < 0) {
+                *(idx.first) += minIndexOffset;
+                newMinIndexOffset = std::min(newMinIndexOffset, *(idx.first));
+              } else {
+                *(idx.first) += idx.second;
+              }
+            }
+            int nbytes = outputTree->Fill();
+            if (nbytes > 0) {
+              currentDirSize += nbytes;
+            }
           }
         }
         unassignedIndexOffset[treeName] = newMinIndexOffset;
@@ -408,6 +503,14 @@ int main(int argc, char* argv[])
     inputFile->Close();
   }
 
+  // files already opened ahead when the merging was aborted
+  for (auto& openedFile : openedFiles) {
+    auto inputFile = openedFile.get();
+    if (inputFile) {
+      inputFile->Close();
+    }
+  }
+
   if (parentFiles) {
     outputFile->cd();
     parentFiles->Write("parentFiles", TObject::kSingleKey);
@@ -25,6 +25,7 @@
 
 // O2 includes
 #include <CCDB/BasicCCDBManager.h>
+#include <Monitoring/Monitoring.h>
 #include "Framework/AnalysisTask.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "CCDB/CcdbApi.h"
@@ -70,7 +71,13 @@ struct tpcPid {
   o2::pid::tpc::Response* responseptr = nullptr;
   // Network correction for TPC PID response
   Network network;
-  o2::ccdb::CcdbApi ccdbApi;
+  NetworkFetcher networkFetcher;
+  std::vector<o2::track::PID::ID> networkSpecies;           // mass hypotheses evaluated by the network, i.e. those whose table is produced
+  std::array<int, o2::track::PID::NIDs> networkSpeciesSlot; // position of each mass hypothesis in networkSpecies (-1 if not evaluated)
+  std::vector<float> collisionMultTPCNorm;                  // normalised TPC multiplicity of each collision, network input
+  std::vector<float> track_properties;                      // network input
+  std::vector<float> network_prediction;                    // network output
+  Service<o2::monitoring::Monitoring> monitoring;
 
   // Input parameters
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -81,7 +88,7 @@ struct tpcPid {
   // Parameters for loading network from a file / downloading the file
   Configurable<bool> useNetworkCorrection{"useNetworkCorrection", 0, "(bool) Wether or not to use the network correction for the TPC dE/dx signal"};
   Configurable<bool> autofetchNetworks{"autofetchNetworks", 1, "(bool) Automatically fetches networks from CCDB for the correct run number"};
-  Configurable<std::string> networkPathLocally{"networkPathLocally", "network.onnx", "(std::string) Path to the local .onnx file. If autofetching is enabled, then this is where the files will be downloaded"};
+  Configurable<std::string> networkPathLocally{"networkPathLocally", "network.onnx", "(std::string) Path to the local .onnx file, used if autofetching is disabled and no timestamp is given. Networks fetched from CCDB are kept in memory"};
   Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
   Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
@@ -118,6 +125,25 @@ struct tpcPid {
     enableFlag("He", pidHe);
     enableFlag("Al", pidAl);
 
+    // Only the mass hypotheses whose table is produced are evaluated by the network
+    networkSpeciesSlot.fill(-1);
+    auto enableNetworkSpecies = [&](const Configurable<int>& flag, const o2::track::PID::ID pid) {
+      if (flag.value != 1) {
+        return;
+      }
+      networkSpeciesSlot[pid] = networkSpecies.size();
+      networkSpecies.push_back(pid);
+    };
+    enableNetworkSpecies(pidEl, o2::track::PID::Electron);
+    enableNetworkSpecies(pidMu, o2::track::PID::Muon);
+    enableNetworkSpecies(pidPi, o2::track::PID::Pion);
+    enableNetworkSpecies(pidKa, o2::track::PID::Kaon);
+    enableNetworkSpecies(pidPr, o2::track::PID::Proton);
+    enableNetworkSpecies(pidDe, o2::track::PID::Deuteron);
+    enableNetworkSpecies(pidTr, o2::track::PID::Triton);
+    enableNetworkSpecies(pidHe, o2::track::PID::Helium3);
+    enableNetworkSpecies(pidAl, o2::track::PID::Alpha);
+
     /// TPC PID Response
     const TString fname = paramfile.value;
     if (fname != "") { // Loading the parametrization from file
@@ -167,31 +193,15 @@ struct tpcPid {
       }
 
       /// CCDB and auto-fetching
-      ccdbApi.init(url);
+      networkFetcher.init(url.value, networkPathCCDB.value, enableNetworkOptimizations.value, activeThreads);
       if (!autofetchNetworks) {
         if (ccdbTimestamp > 0) {
           /// Fetching network for specific timestamp
-          LOG(info) << "Fetching network for timestamp: " << ccdbTimestamp.value;
-          std::map<std::string, std::string> metadata;
-          bool retrieve_success = ccdbApi.retrieveBlob(networkPathCCDB.value, ".", metadata, ccdbTimestamp.value, false, networkPathLocally.value);
-          if (retrieve_success) {
-            std::map<std::string, std::string> headers = ccdbApi.retrieveHeaders(networkPathCCDB.value, metadata, ccdbTimestamp.value);
-            if (headers.count("Valid-From") == 0) {
-              LOG(fatal) << "Valid-From not found in metadata";
-            }
-            if (headers.count("Valid-Until") == 0) {
-              LOG(fatal) << "Valid-Until not found in metadata";
-            }
-            Network temp_net(networkPathLocally.value,
-                             strtoul(headers["Valid-From"].c_str(), NULL, 0),
-                             strtoul(headers["Valid-Until"].c_str(), NULL, 0),
-                             enableNetworkOptimizations.value,
-                             activeThreads);
-            network = temp_net;
-            network.evalNetwork(std::vector<float>(network.getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
-          } else {
+          auto fetched = networkFetcher.get(ccdbTimestamp.value, false);
+          if (!fetched) {
             LOG(fatal) << "Error encountered while fetching/loading the network from CCDB! Maybe the network doesn't exist yet for this runnumber/timestamp?";
           }
+          network = *fetched;
         } else {
           /// Taking the network from local file
           if (networkPathLocally.value == "") {
@@ -233,7 +243,6 @@ struct tpcPid {
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
 
-    std::vector<float> network_prediction;
     const float nNclNormalization = response.GetNClNormalization();
 
     if (useNetworkCorrection) {
@@ -245,75 +254,67 @@ struct tpcPid {
         auto bc = collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>();
 
         if (bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) { // fetches network only if the runnumbers change
-          LOG(info) << "Fetching network for timestamp: " << bc.timestamp();
-          std::map<std::string, std::string> metadata;
-          bool retrieve_success = ccdbApi.retrieveBlob(networkPathCCDB.value, ".", metadata, bc.timestamp(), false, networkPathLocally.value);
-          if (retrieve_success) {
-            std::map<std::string, std::string> headers = ccdbApi.retrieveHeaders(networkPathCCDB.value, metadata, bc.timestamp());
-            if (headers.count("Valid-From") == 0) {
-              LOG(fatal) << "Valid-From not found in metadata";
-            }
-            if (headers.count("Valid-Until") == 0) {
-              LOG(fatal) << "Valid-Until not found in metadata";
-            }
-            Network temp_net(networkPathLocally.value,
-                             strtoul(headers["Valid-From"].c_str(), NULL, 0),
-                             strtoul(headers["Valid-Until"].c_str(), NULL, 0),
-                             enableNetworkOptimizations.value,
-                             activeThreads);
-            network = temp_net;
-            network.evalNetwork(std::vector<float>(network.getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
-          } else {
+          // The network is normally served from the in-memory cache, filled by the background prefetch of the next range of validity
+          auto fetched = networkFetcher.get(bc.timestamp());
+          if (!fetched) {
             LOG(fatal) << "Error encountered while fetching/loading the network from CCDB! Maybe the network doesn't exist yet for this runnumber/timestamp?";
           }
+          network = *fetched;
         }
       }
 
       // Defining some network parameters
-      int input_dimensions = network.getInputDimensions();
-      int output_dimensions = network.getOutputDimensions();
-      const uint64_t track_prop_size = input_dimensions * tracks_size;
-      const uint64_t prediction_size = output_dimensions * tracks_size;
-
-      network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
-
-      float duration_network = 0;
+      const int input_dimensions = network.getInputDimensions();
+      const uint64_t nSpecies = networkSpecies.size();
+      const uint64_t track_prop_size = input_dimensions * tracks_size * nSpecies;
+
+      // Per-collision input features, computed once per collision
+      collisionMultTPCNorm.resize(collisions.size());
+      for (auto const& collision : collisions) {
+        collisionMultTPCNorm[collision.globalIndex()] = collision.multTPC() / 11000.;
+      }
 
-      std::vector<float> track_properties(track_prop_size);
+      // Filling a std::vector<float> to be evaluated by the network, only for the mass hypotheses whose table is produced
+      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector, with the species stacked along the batch axis
+      track_properties.resize(track_prop_size);
+      const uint64_t species_stride = input_dimensions * tracks_size;
       uint64_t counter_track_props = 0;
-      int loop_counter = 0;
-
-      // Filling a std::vector<float> to be evaluated by the network
-      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector
-      for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
-        for (auto const& trk : tracks) {
-          track_properties[counter_track_props] = trk.tpcInnerParam();
-          track_properties[counter_track_props + 1] = trk.tgl();
-          track_properties[counter_track_props + 2] = trk.signed1Pt();
-          track_properties[counter_track_props + 3] = o2::track::pid_constants::sMasses[i];
-          track_properties[counter_track_props + 4] = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
-          track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
-          counter_track_props += input_dimensions;
+      for (auto const& trk : tracks) {
+        const float tpcInnerParam = trk.tpcInnerParam();
+        const float tgl = trk.tgl();
+        const float signed1Pt = trk.signed1Pt();
+        const float multTPC = trk.has_collision() ? collisionMultTPCNorm[trk.collisionId()] : 0.f;
+        const float nClNorm = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+        for (uint64_t iSpecies = 0; iSpecies < nSpecies; iSpecies++) {
+          float* props = &track_properties[counter_track_props + iSpecies * species_stride];
+          props[0] = tpcInnerParam;
+          props[1] = tgl;
+          props[2] = signed1Pt;
+          props[3] = o2::track::pid_constants::sMasses[networkSpecies[iSpecies]];
+          props[4] = multTPC;
+          props[5] = nClNorm;
         }
+        counter_track_props += input_dimensions;
+      }
 
+      float duration_network = 0;
+      if (track_prop_size > 0) {
         auto start_network_eval = std::chrono::high_resolution_clock::now();
-        float* output_network = network.evalNetwork(track_properties);
-        auto stop_network_eval = std::chrono::high_resolution_clock::now();
-        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-        for (uint64_t i = 0; i < prediction_size; i += output_dimensions) {
-          for (int j = 0; j < output_dimensions; j++) {
-            network_prediction[i + j + prediction_size * loop_counter] = output_network[i + j];
-          }
+        if (!network.evalNetwork(track_properties, network_prediction)) {
+          LOG(fatal) << "Neural Network for the TPC PID response correction: evaluation failed!";
         }
-
-        counter_track_props = 0;
-        loop_counter += 1;
+        auto stop_network_eval = std::chrono::high_resolution_clock::now();
+        duration_network = std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
       }
-      track_properties.clear();
 
       auto stop_network_total = std::chrono::high_resolution_clock::now();
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracks_size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (tracks_size * 9) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
+      const float duration_network_total = std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count();
+      const uint64_t n_evaluations = tracks_size * nSpecies;
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / n_evaluations << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << duration_network_total / n_evaluations << "ns ; Total time (eval + overhead): " << duration_network_total / 1000000000 << " s";
+      monitoring->send(o2::monitoring::Metric{static_cast<double>(duration_network), "tpcpid_network_eval_ns"});
+      monitoring->send(o2::monitoring::Metric{static_cast<double>(duration_network_total), "tpcpid_network_total_ns"});
+      monitoring->send(o2::monitoring::Metric{n_evaluations, "tpcpid_network_evaluations"});
     }
 
     int lastCollisionId = -1; // Last collision ID analysed
@@ -327,7 +328,7 @@ struct tpcPid {
         response.SetParameters(ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp()));
       }
       // Check and fill enabled tables
-      auto makeTable = [&trk, &collisions, &network_prediction, &count_tracks, &tracks_size, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
+      auto makeTable = [&trk, &collisions, &count_tracks, &tracks_size, this](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
         if (flag.value != 1) {
           return;
         }
@@ -336,15 +337,16 @@ struct tpcPid {
 
           // Here comes the application of the network. The output--dimensions of the network dtermine the application: 1: mean, 2: sigma, 3: sigma asymmetric
           // For now only the option 2: sigma will be used. The other options are kept if there would be demand later on
+          const float* prediction = &network_prediction[network.getOutputDimensions() * (count_tracks + tracks_size * networkSpeciesSlot[pid])];
           if (network.getOutputDimensions() == 1) {
-            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid), table);
+            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - prediction[0] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid), table);
           } else if (network.getOutputDimensions() == 2) {
-            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]), table);
+            aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - prediction[0]) / (prediction[1] - prediction[0]), table);
           } else if (network.getOutputDimensions() == 3) {
-            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
-              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]), table);
+            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= prediction[0]) {
+              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - prediction[0]) / (prediction[1] - prediction[0]), table);
             } else {
-              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]), table);
+              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - prediction[0]) / (prediction[0] - prediction[2]), table);
             }
           } else {
             LOGF(fatal, "Network output-dimensions incompatible!");
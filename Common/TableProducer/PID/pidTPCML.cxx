@@ -21,6 +21,7 @@
 // C++ and system includes
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
 #include <vector>
+#include <cstdlib>
 
 // ROOT includes
 #include "TSystem.h"
@@ -140,6 +141,58 @@ Network::Network(std::string path,
 
 } // Network::Network(std::string, uint64_t, uint64_t, bool)
 
+Network::Network(const std::vector<char>& model,
+                 uint64_t start,
+                 uint64_t end,
+                 bool enableOptimization = true,
+                 int numThreads = 0)
+{
+
+  /*
+  Constructor: Creating a class instance from a model in memory and enabling optimizations with the boolean option.
+  - Input:
+    -- model:               std::vector<char> ; Content of the model file;
+    -- start:               uint64_t ; Timestamp validity of model (start)
+    -- end:                 uint64_t ; Timestamp validity of model (end)
+    -- enableOptimization:  bool          ; enabling optimizations for the loaded model in the session options;
+  */
+
+  LOG(info) << "--- Neural Network for the TPC PID response correction ---";
+
+  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-neural-network");
+  if (enableOptimization) {
+    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+  }
+  if (numThreads > 0) {
+    sessionOptions.SetIntraOpNumThreads(numThreads);
+  }
+
+  // The model is parsed when creating the session, the buffer does not need to outlive it
+  mSession.reset(new Ort::Experimental::Session{*mEnv, const_cast<char*>(model.data()), model.size(), sessionOptions});
+
+  mInputNames = mSession->GetInputNames();
+  mInputShapes = mSession->GetInputShapes();
+  mOutputNames = mSession->GetOutputNames();
+  mOutputShapes = mSession->GetOutputShapes();
+
+  LOG(info) << "Input Nodes:";
+  for (size_t i = 0; i < mInputNames.size(); i++) {
+    LOG(info) << "\t" << mInputNames[i] << " : " << printShape(mInputShapes[i]);
+  }
+
+  LOG(info) << "Output Nodes:";
+  for (size_t i = 0; i < mOutputNames.size(); i++) {
+    LOG(info) << "\t" << mOutputNames[i] << " : " << printShape(mOutputShapes[i]);
+  }
+
+  valid_from = start;
+  valid_until = end;
+  LOG(info) << "Range of validity: Valid-From: " << valid_from << " Valid-Until: " << valid_until;
+
+  LOG(info) << "--- Network initialized! ---";
+
+} // Network::Network(const std::vector<char>&, uint64_t, uint64_t, bool)
+
 Network& Network::operator=(Network& inst)
 {
 
@@ -253,4 +306,172 @@ float* Network::evalNetwork(std::vector<float> input)
 
 } // function Network::evalNetwork(std::vector<float>)
 
+bool Network::evalNetwork(const std::vector<float>& input, std::vector<float>& output)
+{
+
+  /*
+ Function: Evaluating the network for a batch of inputs in a single session call
+ - Input:
+   -- input:         const std::vector<float>&  ; The inputs, stored contiguously. The network will evaluate n inputs where n = input.size()/input_nodes;
+   -- output:        std::vector<float>&        ; Resized and filled with the n * output_nodes outputs of the network;
+ - Output:
+   -- success:       bool                       ; false if the inference failed;
+ */
+
+  int64_t size = input.size();
+  std::vector<int64_t> input_shape{size / mInputShapes[0][1], mInputShapes[0][1]};
+  std::vector<Ort::Value> inputTensors;
+  // The tensor only wraps the input memory, which is not modified by the inference
+  inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(const_cast<float*>(input.data()), size, input_shape));
+
+  try {
+
+    LOG(debug) << "Shape of input (batch): " << printShape(input_shape);
+    auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+    const float* output_values = outputTensors[0].GetTensorMutableData<float>();
+    // The output tensors are released when going out of scope: the values are copied
+    output.assign(output_values, output_values + outputTensors[0].GetTensorTypeAndShapeInfo().GetElementCount());
+
+    return true;
+
+  } catch (const Ort::Exception& exception) {
+
+    LOG(error) << "Error running model inference: " << exception.what();
+
+    return false;
+  }
+
+} // function Network::evalNetwork(const std::vector<float>&, std::vector<float>&)
+
+NetworkFetcher::~NetworkFetcher()
+{
+  // Do not leave a prefetch running on a destroyed fetcher
+  if (mPrefetch.valid()) {
+    mPrefetch.wait();
+  }
+}
+
+void NetworkFetcher::init(std::string url, std::string path, bool enableOptimization, int numThreads, int maxCached)
+{
+  mCcdbApi.init(url);
+  mPath = path;
+  mEnableOptimization = enableOptimization;
+  mNumThreads = numThreads;
+  mMaxCached = maxCached > 0 ? maxCached : 1;
+}
+
+std::shared_ptr<Network> NetworkFetcher::fetch(uint64_t timestamp)
+{
+
+  /*
+  Function: Downloading the network valid for a timestamp in memory, creating its session and running a warm-up inference
+  NOTE: also called from the prefetching thread, hence errors are only reported and nullptr is returned
+  */
+
+  std::vector<char> model;
+  std::map<std::string, std::string> metadata;
+  std::map<std::string, std::string> headers;
+  try {
+    mCcdbApi.loadFileToMemory(model, mPath, metadata, timestamp, &headers, "", "", "");
+  } catch (const std::exception& exception) {
+    LOG(warning) << "Error while fetching the network for timestamp " << timestamp << ": " << exception.what();
+    return nullptr;
+  }
+  if (model.empty()) {
+    LOG(info) << "No network found for timestamp " << timestamp;
+    return nullptr;
+  }
+  if (headers.count("Valid-From") == 0 || headers.count("Valid-Until") == 0) {
+    LOG(warning) << "Valid-From or Valid-Until not found in the headers of the network for timestamp " << timestamp;
+    return nullptr;
+  }
+
+  try {
+    auto net = std::make_shared<Network>(model,
+                                         strtoul(headers["Valid-From"].c_str(), NULL, 0),
+                                         strtoul(headers["Valid-Until"].c_str(), NULL, 0),
+                                         mEnableOptimization,
+                                         mNumThreads);
+    net->evalNetwork(std::vector<float>(net->getInputDimensions(), 1.)); // This is an initialisation and might reduce the overhead of the model
+    return net;
+  } catch (const Ort::Exception& exception) {
+    LOG(warning) << "Error while creating the session of the network for timestamp " << timestamp << ": " << exception.what();
+    return nullptr;
+  }
+}
+
+std::shared_ptr<Network> NetworkFetcher::findCached(uint64_t timestamp) const
+{
+  // Last network starting before the timestamp
+  auto it = mCache.upper_bound(timestamp);
+  if (it == mCache.begin()) {
+    return nullptr;
+  }
+  --it;
+  if (timestamp > it->second->getValidityUntil()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void NetworkFetcher::collectPrefetch()
+{
+  if (!mPrefetch.valid()) {
+    return;
+  }
+  auto net = mPrefetch.get();
+  if (net) {
+    insert(net, mPrefetchTimestamp);
+  }
+}
+
+void NetworkFetcher::insert(std::shared_ptr<Network> net, uint64_t current)
+{
+  mCache[net->getValidityFrom()] = net;
+  while (mCache.size() > mMaxCached) {
+    // Evict the network farthest in time from the current timestamp
+    auto distance = [current](const std::shared_ptr<Network>& n) {
+      if (current < n->getValidityFrom()) {
+        return n->getValidityFrom() - current;
+      }
+      return current > n->getValidityUntil() ? current - n->getValidityUntil() : 0;
+    };
+    auto farthest = mCache.begin();
+    for (auto it = mCache.begin(); it != mCache.end(); ++it) {
+      if (distance(it->second) > distance(farthest->second)) {
+        farthest = it;
+      }
+    }
+    mCache.erase(farthest);
+  }
+}
+
+std::shared_ptr<Network> NetworkFetcher::get(uint64_t timestamp, bool prefetchNext)
+{
+  auto net = findCached(timestamp);
+  if (!net && mPrefetch.valid()) {
+    // The prefetched network might be the one needed
+    collectPrefetch();
+    net = findCached(timestamp);
+  }
+  if (!net) {
+    LOG(info) << "Fetching network for timestamp: " << timestamp;
+    collectPrefetch(); // the CCDB API cannot be used concurrently
+    net = fetch(timestamp);
+    if (!net) {
+      return nullptr;
+    }
+    insert(net, timestamp);
+  }
+
+  // Prefetch the network of the following range of validity, if not already available
+  const uint64_t next = net->getValidityUntil() + 1;
+  if (prefetchNext && !mPrefetch.valid() && !findCached(next)) {
+    LOG(info) << "Prefetching in the background the network for timestamp: " << next;
+    mPrefetchTimestamp = next;
+    mPrefetch = std::async(std::launch::async, [this, next]() { return fetch(next); });
+  }
+  return net;
+}
+
 } // namespace o2::pid::tpc
@@ -27,9 +27,12 @@
 #include <array>
 #include <string>
 #include <memory>
+#include <map>
+#include <future>
 
 // O2 includes
 #include "ReconstructionDataFormats/PID.h"
+#include "CCDB/CcdbApi.h"
 
 namespace o2::pid::tpc
 {
@@ -41,6 +44,7 @@ class Network
   Network() = default;
   Network(std::string, bool, int);
   Network(std::string, uint64_t, uint64_t, bool, int); // initialization with timestamps
+  Network(const std::vector<char>&, uint64_t, uint64_t, bool, int); // initialization from a model in memory, with timestamps
   ~Network() = default;
 
   // Operators
@@ -50,6 +54,7 @@ class Network
   std::vector<Ort::Value> createTensor(std::array<float, 6>) const; // create a std::vector<Ort::Value> (= ONNX tensor) for model input
   float* evalNetwork(std::vector<Ort::Value>);                      // evaluate the network on a std::vector<Ort::Value> (= ONNX tensor)
   float* evalNetwork(std::vector<float>);                           // evaluate the network on a std::vector<float>
+  bool evalNetwork(const std::vector<float>&, std::vector<float>&); // evaluate the network on a batch of inputs in a single call, copying the outputs into a std::vector<float>
 
   // Getters & Setters
   int getInputDimensions() const { return mInputShapes[0][1]; }
@@ -83,6 +88,41 @@ class Network
 
 }; // class Network
 
+class NetworkFetcher
+{
+  /*
+  Fetches the networks from CCDB directly in memory and keeps them in a cache keyed by their range of validity.
+  When the network for a new range of validity is requested, the one of the following range is prefetched in the background,
+  so that the swap at the next run boundary does not block on the download, the session creation and the warm-up.
+  */
+
+ public:
+  NetworkFetcher() = default;
+  ~NetworkFetcher();
+
+  void init(std::string url, std::string path, bool enableOptimization, int numThreads, int maxCached = 4);
+
+  // Returns the network valid for the timestamp, fetching it if needed (blocking only if not cached nor prefetched), nullptr if not found
+  // If prefetchNext is set, the network of the following range of validity is fetched in the background
+  std::shared_ptr<Network> get(uint64_t timestamp, bool prefetchNext = true);
+
+ private:
+  std::shared_ptr<Network> fetch(uint64_t timestamp);        // download, session creation and warm-up
+  std::shared_ptr<Network> findCached(uint64_t timestamp) const;
+  void collectPrefetch();                                     // waits for the pending prefetch, if any, and caches its network
+  void insert(std::shared_ptr<Network> net, uint64_t current); // caches a network, evicting the farthest from the current timestamp if needed
+
+  o2::ccdb::CcdbApi mCcdbApi; // only used by one thread at a time: a fetch is never started while a prefetch is pending
+  std::string mPath;
+  bool mEnableOptimization = true;
+  int mNumThreads = 0;
+  size_t mMaxCached = 4;
+
+  std::map<uint64_t, std::shared_ptr<Network>> mCache; // networks keyed by the start of their range of validity
+  std::future<std::shared_ptr<Network>> mPrefetch;      // network being fetched in the background
+  uint64_t mPrefetchTimestamp = 0;                      // timestamp for which the prefetch was started
+}; // class NetworkFetcher
+
 } // namespace o2::pid::tpc
 
 #endif // COMMON_TABLEPRODUCER_PID_PIDTPCML_H_
@@ -24,6 +24,10 @@ using namespace o2::framework;
 #include "Framework/HistogramRegistry.h"
 #include "DataFormatsFT0/Digit.h"
 #include "TH1F.h"
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
 using namespace evsel;
 
 using BCsWithRun2InfosTimestampsAndMatches = soa::Join<aod::BCs, aod::Run2BCInfos, aod::Timestamps, aod::Run2MatchedToBCSparse>;
@@ -35,6 +39,26 @@ struct BcSelectionTask {
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // objects from CCDB and quantities derived from them, cached for the current run
+  int lastRunNumber = -1;
+  EventSelectionParams* par = nullptr;
+  std::vector<std::pair<int, uint64_t>> aliasTriggerMasks;       // (alias, trigger mask) of all the alias definitions
+  std::vector<std::pair<int, uint64_t>> aliasTriggerMasksNext50; // (alias, trigger mask of the next 50 BCs), Run 2 only
+  std::shared_ptr<TH1> hCounterTVX;
+  double counterBinCenter = 0.; // position of the current run in the run-labelled counters
+
+  // times of the last BCs, indexed by global BC modulo the buffer size, to look for beam-gas in the previous BCs
+  struct BcTimes {
+    uint64_t globalBC;
+    float timeV0A;
+    float timeT0A;
+    float timeT0C;
+    float timeFDA;
+    float timeFDC;
+  };
+  static constexpr int kBcRingSize = 8; // power of 2 larger than the 5 BCs looked back
+  std::array<BcTimes, kBcRingSize> bcRing;
+
   void init(InitContext&)
   {
     // ccdb->setURL("http://ccdb-test.cern.ch:8080");
@@ -42,7 +66,31 @@ struct BcSelectionTask {
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
 
-    histos.add("hCounterTVX", "", kTH1F, {{1, 0., 1.}});
+    hCounterTVX = histos.add<TH1>("hCounterTVX", "", kTH1F, {{1, 0., 1.}});
+  }
+
+  void updateRun(int runNumber, uint64_t timestamp)
+  {
+    if (runNumber == lastRunNumber) {
+      return;
+    }
+    lastRunNumber = runNumber;
+    par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", timestamp);
+    TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", timestamp);
+    aliasTriggerMasks.assign(aliases->GetAliasToTriggerMaskMap().begin(), aliases->GetAliasToTriggerMaskMap().end());
+    aliasTriggerMasksNext50.assign(aliases->GetAliasToTriggerMaskNext50Map().begin(), aliases->GetAliasToTriggerMaskNext50Map().end());
+    // adds the run label to the counters if needed, the counters are then filled by position
+    counterBinCenter = hCounterTVX->GetXaxis()->GetBinCenter(hCounterTVX->GetXaxis()->FindBin(Form("%d", runNumber)));
+  }
+
+  // times of the BC deltaBC before globalBC, nullptr if this BC was not processed
+  const BcTimes* findPreviousBc(uint64_t globalBC, uint64_t deltaBC)
+  {
+    if (globalBC < deltaBC) {
+      return nullptr;
+    }
+    const auto& entry = bcRing[(globalBC - deltaBC) & (kBcRingSize - 1)];
+    return entry.globalBC == globalBC - deltaBC ? &entry : nullptr;
   }
 
   void processRun2(
@@ -55,16 +103,15 @@ struct BcSelectionTask {
   {
 
     for (auto& bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      updateRun(bc.runNumber(), bc.timestamp());
       // fill fired aliases
       int32_t alias[kNaliases] = {0};
       uint64_t triggerMask = bc.triggerMask();
-      for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
+      for (auto& al : aliasTriggerMasks) {
         alias[al.first] |= (triggerMask & al.second) > 0;
       }
       uint64_t triggerMaskNext50 = bc.triggerMaskNext50();
-      for (auto& al : aliases->GetAliasToTriggerMaskNext50Map()) {
+      for (auto& al : aliasTriggerMasksNext50) {
         alias[al.first] |= (triggerMaskNext50 & al.second) > 0;
       }
       alias[kALL] = 1;
@@ -171,7 +218,7 @@ struct BcSelectionTask {
 
       // Fill TVX (T0 vertex) counters
       if (selection[kIsTriggerTVX]) {
-        histos.get<TH1>(HIST("hCounterTVX"))->Fill(Form("%d", bc.runNumber()), 1);
+        hCounterTVX->Fill(counterBinCenter);
       }
 
       // Fill bc selection columns
@@ -189,12 +236,16 @@ struct BcSelectionTask {
                    aod::FT0s const&,
                    aod::FDDs const&)
   {
-    for (auto bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+    // global BCs in a DF are not contiguous with the ones of the previous DF
+    for (auto& entry : bcRing) {
+      entry.globalBC = std::numeric_limits<uint64_t>::max();
+    }
+
+    for (auto& bc : bcs) {
+      updateRun(bc.runNumber(), bc.timestamp());
       int32_t alias[kNaliases] = {0};
       uint64_t triggerMask = bc.triggerMask();
-      for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
+      for (auto& al : aliasTriggerMasks) {
         alias[al.first] |= (triggerMask & al.second) > 0;
       }
       alias[kALL] = 1;
@@ -215,28 +266,18 @@ struct BcSelectionTask {
       float znSum = timeZNA + timeZNC;
       float znDif = timeZNA - timeZNC;
 
+      // check beam-gas in FT0, FV0 and FDD in the previous bcs, kept from the previous iterations
       uint64_t globalBC = bc.globalBC();
-      // move to previous bcs to check beam-gas in FT0, FV0 and FDD
-      int64_t backwardMoveCount = 0;
-      int64_t deltaBC = 6; // up to 6 bcs back
-      while (bc.globalBC() + deltaBC >= globalBC) {
-        if (bc == bcs.begin()) {
-          break;
-        }
-        --bc;
-        backwardMoveCount++;
-        if (bc.globalBC() + 1 == globalBC) {
-          timeV0ABG = bc.has_fv0a() ? bc.fv0a().time() : -999.f;
-          timeT0ABG = bc.has_ft0() ? bc.ft0().timeA() : -999.f;
-          timeT0CBG = bc.has_ft0() ? bc.ft0().timeC() : -999.f;
-        }
-        if (bc.globalBC() + 5 == globalBC) {
-          timeFDABG = bc.has_fdd() ? bc.fdd().timeA() : -999.f;
-          timeFDCBG = bc.has_fdd() ? bc.fdd().timeC() : -999.f;
-        }
+      if (auto prev = findPreviousBc(globalBC, 1)) {
+        timeV0ABG = prev->timeV0A;
+        timeT0ABG = prev->timeT0A;
+        timeT0CBG = prev->timeT0C;
       }
-      // move back to initial position
-      bc.moveByIndex(backwardMoveCount);
+      if (auto prev = findPreviousBc(globalBC, 5)) {
+        timeFDABG = prev->timeFDA;
+        timeFDCBG = prev->timeFDC;
+      }
+      bcRing[globalBC & (kBcRingSize - 1)] = {globalBC, timeV0A, timeT0A, timeT0C, timeFDA, timeFDC};
 
       // applying timing selections
       bool bbV0A = timeV0A > par->fV0ABBlower && timeV0A < par->fV0ABBupper;
@@ -292,7 +333,7 @@ struct BcSelectionTask {
 
       // Fill TVX (T0 vertex) counters
       if (selection[kIsTriggerTVX]) {
-        histos.get<TH1>(HIST("hCounterTVX"))->Fill(Form("%d", bc.runNumber()), 1);
+        hCounterTVX->Fill(counterBinCenter);
       }
 
       // Fill bc selection columns
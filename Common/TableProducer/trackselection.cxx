@@ -22,6 +22,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/TrackSelectionDefaults.h"
+#include "Common/Core/TrackSelectionFused.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/trackUtilities.h"
 
@@ -54,6 +55,15 @@ struct TrackSelectionTask {
   TrackSelection filtBit3;
   TrackSelection filtBit4;
 
+  // all the selections above, evaluated in one pass with the cuts they share computed once
+  TrackSelectionFused fusedSelection;
+  int iGlobalTracks = -1;
+  int iGlobalTracksSDD = -1;
+  int iFiltBit1 = -1;
+  int iFiltBit2 = -1;
+  int iFiltBit3 = -1;
+  int iFiltBit4 = -1;
+
   void init(InitContext&)
   {
     switch (itsMatching) {
@@ -106,20 +116,33 @@ struct TrackSelectionTask {
     filtBit3 = getGlobalTrackSelectionRun3HF();
 
     filtBit4 = getGlobalTrackSelectionRun3Nuclei();
+
+    iGlobalTracks = fusedSelection.AddSelection(globalTracks);
+    if (!isRun3) {
+      iGlobalTracksSDD = fusedSelection.AddSelection(globalTracksSDD);
+    }
+    iFiltBit1 = fusedSelection.AddSelection(filtBit1);
+    iFiltBit2 = fusedSelection.AddSelection(filtBit2);
+    iFiltBit3 = fusedSelection.AddSelection(filtBit3);
+    iFiltBit4 = fusedSelection.AddSelection(filtBit4);
+    LOG(info) << "Evaluating " << fusedSelection.GetNSelections() << " track selections with " << fusedSelection.GetNUniqueCuts() << " unique cuts";
   }
 
   void process(soa::Join<aod::FullTracks, aod::TracksDCA> const& tracks)
   {
+    fusedSelection.Evaluate(tracks);
+    const int64_t nTracks = fusedSelection.GetNTracks();
+
     if (isRun3) {
-      for (auto& track : tracks) {
-        o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-        o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(track);
-        o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(track);
-        // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = filtBit3.IsSelectedMask(track); // only temporarily commented, will be used
-        // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
+      for (int64_t iTrack = 0; iTrack < nTracks; ++iTrack) {
+        o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = fusedSelection.GetMask(iGlobalTracks, iTrack);
+        o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = fusedSelection.GetMask(iFiltBit1, iTrack);
+        o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = fusedSelection.GetMask(iFiltBit2, iTrack);
+        // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = fusedSelection.GetMask(iFiltBit3, iTrack); // only temporarily commented, will be used
+        // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = fusedSelection.GetMask(iFiltBit4, iTrack);
 
         filterTable((uint8_t)0,
-                    globalTracks.IsSelectedMask(track), filtBit1.IsSelected(track), filtBit2.IsSelected(track), filtBit3.IsSelected(track), filtBit4.IsSelected(track));
+                    trackflagGlob, fusedSelection.IsSelected(iFiltBit1, iTrack), fusedSelection.IsSelected(iFiltBit2, iTrack), fusedSelection.IsSelected(iFiltBit3, iTrack), fusedSelection.IsSelected(iFiltBit4, iTrack));
         if (produceFBextendedTable) {
           filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
                             o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
@@ -143,10 +166,10 @@ struct TrackSelectionTask {
       return;
     }
 
-    for (auto& track : tracks) {
-      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-      filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                  globalTracks.IsSelectedMask(track), filtBit1.IsSelected(track), filtBit2.IsSelected(track), filtBit3.IsSelected(track), filtBit4.IsSelected(track));
+    for (int64_t iTrack = 0; iTrack < nTracks; ++iTrack) {
+      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = fusedSelection.GetMask(iGlobalTracks, iTrack);
+      filterTable((uint8_t)fusedSelection.IsSelected(iGlobalTracksSDD, iTrack),
+                  trackflagGlob, fusedSelection.IsSelected(iFiltBit1, iTrack), fusedSelection.IsSelected(iFiltBit2, iTrack), fusedSelection.IsSelected(iFiltBit3, iTrack), fusedSelection.IsSelected(iFiltBit4, iTrack));
       if (produceFBextendedTable) {
         filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
                           o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
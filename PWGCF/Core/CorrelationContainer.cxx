@@ -27,8 +27,11 @@
 #include "TCanvas.h"
 #include "TF1.h"
 #include "THn.h"
+#include "TArrayF.h"
+#include "TArrayD.h"
 #include "Framework/HistogramSpec.h"
 #include "CommonConstants/MathConstants.h"
+#include <algorithm>
 
 using namespace o2;
 using namespace o2::framework;
@@ -111,6 +114,13 @@ CorrelationContainer::CorrelationContainer(const char* name, const char* objTitl
 
   mPairHist = HistFactory::createHist<StepTHnF>({"mPairHist", "d^{2}N_{ch}/d#varphid#eta", {HistType::kStepTHnF, pairAxis, fgkCFSteps}}).release();
 
+  for (const auto& axis : pairAxis) {
+    mPairAxisNBins.push_back(axis.getNbins());
+    mPairAxisMin.push_back(axis.binEdges.front());
+    mPairAxisMax.push_back(axis.binEdges.back());
+    mPairAxisEdges.push_back(axis.nBins.has_value() ? std::vector<double>() : axis.binEdges);
+  }
+
   std::vector<o2::framework::AxisSpec> triggerAxis({correlationAxis[2], correlationAxis[3], correlationAxis[5]});
   triggerAxis.insert(triggerAxis.end(), userAxis.begin(), userAxis.end());
   mTriggerHist = HistFactory::createHist<StepTHnF>({"mTriggerHist", "d^{2}N_{ch}/d#varphid#eta", {HistType::kStepTHnF, triggerAxis, fgkCFSteps}}).release();
@@ -224,6 +234,105 @@ void CorrelationContainer::Copy(TObject& c) const
   target.mSkipScaleMixedEvent = mSkipScaleMixedEvent;
 }
 
+//____________________________________________________________________
+void CorrelationContainer::bufferPair(CFStep step, int nParams, const double* valuesAndWeight)
+{
+  // buffers one pair, valuesAndWeight contains the values of all axes followed by the (optional) weight
+
+  const int nAxes = mPairAxisNBins.size();
+  if (nAxes == 0) {
+    // axes unknown (e.g. object copied or read from file): direct filling
+    mPairHist->Fill(step, nParams, const_cast<double*>(valuesAndWeight));
+    return;
+  }
+  if (nParams != nAxes && nParams != nAxes + 1) {
+    LOGF(fatal, "bufferPair: %d values given for %d axes", nParams, nAxes);
+  }
+
+  // same bin definition as TAxis::FindBin and the same global index as StepTHn
+  Long64_t bin = 0;
+  for (int i = 0; i < nAxes; i++) {
+    const double x = valuesAndWeight[i];
+    const int nBins = mPairAxisNBins[i];
+    if (x < mPairAxisMin[i] || !(x < mPairAxisMax[i])) {
+      return; // under/overflow not supported
+    }
+    int tmpBin;
+    if (mPairAxisEdges[i].empty()) {
+      tmpBin = 1 + int(nBins * (x - mPairAxisMin[i]) / (mPairAxisMax[i] - mPairAxisMin[i]));
+    } else {
+      tmpBin = std::upper_bound(mPairAxisEdges[i].begin(), mPairAxisEdges[i].end(), x) - mPairAxisEdges[i].begin();
+    }
+    bin = bin * nBins + tmpBin - 1;
+  }
+
+  if (mPairBuffer.capacity() == 0) {
+    mPairBuffer.reserve(1 << 20);
+  }
+  mPairBuffer.push_back({step, bin, (nParams > nAxes) ? valuesAndWeight[nAxes] : 1.});
+  if (mPairBuffer.size() == mPairBuffer.capacity()) {
+    flushPairBuffer();
+  }
+}
+
+namespace
+{
+template <typename TArrayType, typename TEntry>
+void addBufferedPair(TArray* values, TArray* sumw2, const TEntry& entry)
+{
+  static_cast<TArrayType*>(values)->GetArray()[entry.bin] += entry.weight;
+  if (sumw2) {
+    static_cast<TArrayType*>(sumw2)->GetArray()[entry.bin] += entry.weight * entry.weight;
+  }
+}
+} // namespace
+
+//____________________________________________________________________
+void CorrelationContainer::flushPairBuffer()
+{
+  // fills the buffered pairs into mPairHist, sorted by step and bin for a sequential memory access
+
+  if (mPairBuffer.empty()) {
+    return;
+  }
+
+  std::sort(mPairBuffer.begin(), mPairBuffer.end(), [](const BufferedPair& a, const BufferedPair& b) {
+    return a.step < b.step || (a.step == b.step && a.bin < b.bin);
+  });
+
+  const int nAxes = mPairAxisNBins.size();
+  std::vector<double> valuesAndWeight(nAxes + 1);
+  for (const auto& entry : mPairBuffer) {
+    TArray* values = mPairHist->getValues(entry.step);
+    TArray* sumw2 = mPairHist->getSumw2(entry.step);
+
+    // the containers are created by StepTHn::Fill (on first fill, and for the sum of weights squared on the first weight != 1):
+    // such entries are filled through it at their bin center
+    if (values == nullptr || (entry.weight != 1. && sumw2 == nullptr)) {
+      Long64_t bin = entry.bin;
+      for (int i = nAxes - 1; i >= 0; i--) {
+        const int tmpBin = bin % mPairAxisNBins[i] + 1;
+        bin /= mPairAxisNBins[i];
+        if (mPairAxisEdges[i].empty()) {
+          valuesAndWeight[i] = mPairAxisMin[i] + (tmpBin - 0.5) * (mPairAxisMax[i] - mPairAxisMin[i]) / mPairAxisNBins[i];
+        } else {
+          valuesAndWeight[i] = 0.5 * (mPairAxisEdges[i][tmpBin - 1] + mPairAxisEdges[i][tmpBin]);
+        }
+      }
+      valuesAndWeight[nAxes] = entry.weight;
+      mPairHist->Fill(entry.step, nAxes + 1, valuesAndWeight.data());
+      continue;
+    }
+
+    if (dynamic_cast<TArrayF*>(values)) {
+      addBufferedPair<TArrayF>(values, sumw2, entry);
+    } else {
+      addBufferedPair<TArrayD>(values, sumw2, entry);
+    }
+  }
+  mPairBuffer.clear();
+}
+
 //____________________________________________________________________
 Long64_t CorrelationContainer::Merge(TCollection* list)
 {
@@ -239,6 +348,8 @@ Long64_t CorrelationContainer::Merge(TCollection* list)
     return 1;
   }
 
+  flushPairBuffer();
+
   TIterator* iter = list->MakeIterator();
   TObject* obj = nullptr;
 
@@ -14,6 +14,7 @@
 
 // encapsulate histogram and corrections for correlation analysis
 
+#include <vector>
 #include "TNamed.h"
 #include "TString.h"
 #include "Framework/HistogramSpec.h"
@@ -73,6 +74,18 @@ class CorrelationContainer : public TNamed
 
   void deepCopy(CorrelationContainer* from);
 
+  // Buffered filling of the pair histogram, same arguments as getPairHist()->Fill(step, ...)
+  // The global bin is computed from cached axis limits and the filling is deferred to flushPairBuffer(), where the
+  // bins are filled in increasing order. The buffer is flushed when full, flushPairBuffer() has to be called before
+  // the pair histogram is used (e.g. at the end of each event)
+  template <typename... Ts>
+  void fillPairBuffered(CFStep step, const Ts&... valuesAndWeight)
+  {
+    const double values[] = {static_cast<double>(valuesAndWeight)...};
+    bufferPair(step, sizeof...(Ts), values);
+  }
+  void flushPairBuffer();
+
   void getHistsZVtxMult(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, THnBase** trackHist, TH2** eventHist);
   TH2* getPerTriggerYield(CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, Bool_t normalizePerTrigger = kTRUE);
   TH2* getSumOfRatios(CorrelationContainer* mixed, CorrelationContainer::CFStep step, Float_t ptTriggerMin, Float_t ptTriggerMax, Bool_t normalizePerTrigger = kTRUE, Int_t stepForMixed = -1, Int_t* trigger = nullptr);
@@ -150,6 +163,7 @@ class CorrelationContainer : public TNamed
   THnBase* changeToThn(THnBase* sparse);
 
  protected:
+  void bufferPair(CFStep step, int nParams, const double* valuesAndWeight);
   void weightHistogram(TH3* hist1, TH1* hist2);
   void multiplyHistograms(THnBase* grid, THnBase* target, TH1* histogram, Int_t var1, Int_t var2);
 
@@ -178,6 +192,19 @@ class CorrelationContainer : public TNamed
   Bool_t mGetMultCacheOn; //! cache for getHistsZVtxMult function active
   THnBase* mGetMultCache; //! cache for getHistsZVtxMult function
 
+  // pair histogram axes, cached to compute the global bin in fillPairBuffered (empty if not constructed from axis specs)
+  std::vector<int> mPairAxisNBins;                //! number of bins
+  std::vector<double> mPairAxisMin;               //! lower limit
+  std::vector<double> mPairAxisMax;               //! upper limit
+  std::vector<std::vector<double>> mPairAxisEdges; //! bin edges for variable binning, empty for fixed binning
+
+  struct BufferedPair {
+    int step;
+    Long64_t bin;
+    double weight;
+  };
+  std::vector<BufferedPair> mPairBuffer; //! pairs waiting to be filled into mPairHist
+
   ClassDef(CorrelationContainer, 2) // underlying event histogram container
 };
 
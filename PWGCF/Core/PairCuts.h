@@ -65,6 +65,9 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  // twoTrackCut can only reject pairs within this eta distance, it can be skipped for the other pairs
+  bool isInTwoTrackWindow(float deta) const { return std::fabs(deta) < mTwoTrackDistance * 2.5 * 3; }
+
  protected:
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
@@ -121,7 +124,7 @@ bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField)
   auto deta = track1.eta() - track2.eta();
 
   // optimization
-  if (std::fabs(deta) < mTwoTrackDistance * 2.5 * 3) {
+  if (isInTwoTrackWindow(deta)) {
     // check first boundaries to see if is worth to loop and find the minimum
     float dphistar1 = getDPhiStar(track1, track2, mTwoTrackRadius, magField);
     float dphistar2 = getDPhiStar(track1, track2, 2.5, magField);
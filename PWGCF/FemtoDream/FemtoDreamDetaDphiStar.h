@@ -16,10 +16,15 @@
 #ifndef PWGCF_FEMTODREAM_FEMTODREAMDETADPHISTAR_H_
 #define PWGCF_FEMTODREAM_FEMTODREAMDETADPHISTAR_H_
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "CommonConstants/MathConstants.h"
 #include "Framework/HistogramRegistry.h"
 
 using namespace o2;
@@ -41,11 +46,13 @@ class FemtoDreamDetaDphiStar
   /// Destructor
   virtual ~FemtoDreamDetaDphiStar() = default;
   /// Initialization of the histograms and setting required values
-  void init(HistogramRegistry* registry, HistogramRegistry* registryQA, float ldeltaPhiMax, float ldeltaEtaMax, bool lplotForEveryRadii)
+  /// \param lfillHistos Fill the Δη-Δφ* histograms; when disabled (and without plots per radius), the pairs far apart in η are rejected before computing Δφ*
+  void init(HistogramRegistry* registry, HistogramRegistry* registryQA, float ldeltaPhiMax, float ldeltaEtaMax, bool lplotForEveryRadii, bool lfillHistos = true)
   {
     deltaPhiMax = ldeltaPhiMax;
     deltaEtaMax = ldeltaEtaMax;
     plotForEveryRadii = lplotForEveryRadii;
+    fillHistos = lfillHistos || lplotForEveryRadii;
     mHistogramRegistry = registry;
     mHistogramRegistryQA = registryQA;
 
@@ -72,11 +79,27 @@ class FemtoDreamDetaDphiStar
       }
     }
   }
+  /// Start the pairs of a new event: the phi* computed for the particles of the event are cached from now on
+  /// \param lmagfield Magnetic field of the event in Tesla
+  void setEvent(float lmagfield)
+  {
+    magfield = lmagfield;
+    useCache = true;
+    phiStarSlots.clear();
+    phiStarCache.clear();
+  }
+
   ///  Check if pair is close or not
   template <typename Part, typename Parts>
   bool isClosePair(Part const& part1, Part const& part2, Parts const& particles, float lmagfield)
   {
-    magfield = lmagfield;
+    if (lmagfield != magfield) {
+      // the cached phi* are only valid for the magnetic field they were computed with
+      if (useCache) {
+        setEvent(lmagfield);
+      }
+      magfield = lmagfield;
+    }
 
     if constexpr (mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kTrack) {
       /// Track-Track combination
@@ -85,15 +108,12 @@ class FemtoDreamDetaDphiStar
         LOG(fatal) << "FemtoDreamDetaDphiStar: passed arguments don't agree with FemtoDreamDetaDphiStar instantiation! Please provide kTrack,kTrack candidates.";
         return false;
       }
+      std::array<float, NRadii> tmpPhiStar1, tmpPhiStar2;
       auto deta = part1.eta() - part2.eta();
-      auto dphiAvg = AveragePhiStar(part1, part2, 0);
-      histdetadpi[0][0]->Fill(deta, dphiAvg);
-      if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
-        return true;
-      } else {
-        histdetadpi[0][1]->Fill(deta, dphiAvg);
+      if (!fillHistos && !isCloseInEta(deta)) {
         return false;
       }
+      return isClosePairPhiStar(deta, getPhiStar(part1, tmpPhiStar1.data()), getPhiStar(part2, tmpPhiStar2.data()), 0);
 
     } else if constexpr (mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kV0) {
       /// Track-V0 combination
@@ -103,18 +123,20 @@ class FemtoDreamDetaDphiStar
         return false;
       }
 
+      std::array<float, NRadii> tmpPhiStar1, tmpPhiStar2;
+      const float* phiStar1 = nullptr;
       bool pass = false;
       for (int i = 0; i < 2; i++) {
         auto indexOfDaughter = part2.index() - 2 + i;
         auto daughter = particles.begin() + indexOfDaughter;
         auto deta = part1.eta() - daughter.eta();
-        auto dphiAvg = AveragePhiStar(part1, *daughter, i);
-        histdetadpi[i][0]->Fill(deta, dphiAvg);
-        if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
-          pass = true;
-        } else {
-          histdetadpi[i][1]->Fill(deta, dphiAvg);
+        if (!fillHistos && !isCloseInEta(deta)) {
+          continue;
+        }
+        if (!phiStar1) {
+          phiStar1 = getPhiStar(part1, tmpPhiStar1.data());
         }
+        pass |= isClosePairPhiStar(deta, phiStar1, getPhiStar(*daughter, tmpPhiStar2.data()), i);
       }
       return pass;
     } else {
@@ -123,6 +145,63 @@ class FemtoDreamDetaDphiStar
     }
   }
 
+  /// Check if pair is close or not, from phi* computed beforehand with PhiAtRadiiTPC
+  /// \param deta Difference of the pseudorapidities of the two particles
+  /// \param phiStar1 phi* of particle 1 at the NRadii radii
+  /// \param phiStar2 phi* of particle 2 at the NRadii radii
+  /// \param iHist Index of the histograms to be filled (V0 daughter for the Track-V0 combination)
+  bool isClosePairPhiStar(float deta, const float* phiStar1, const float* phiStar2, int iHist = 0)
+  {
+    if (!fillHistos) {
+      if (!isCloseInEta(deta)) {
+        return false;
+      }
+      float dphiAvg = AveragePhiStar(phiStar1, phiStar2);
+      return isInEllipse(deta, dphiAvg);
+    }
+    std::array<float, NRadii> dphi;
+    float dphiAvg = AveragePhiStar(phiStar1, phiStar2, dphi.data());
+    if (plotForEveryRadii) {
+      for (int i = 0; i < NRadii; i++) {
+        histdetadpiRadii[iHist][i]->Fill(deta, dphi[i]);
+      }
+    }
+    histdetadpi[iHist][0]->Fill(deta, dphiAvg);
+    if (isInEllipse(deta, dphiAvg)) {
+      return true;
+    }
+    histdetadpi[iHist][1]->Fill(deta, dphiAvg);
+    return false;
+  }
+
+  ///  Calculate phi at all required radii stored in tmpRadiiTPC
+  /// \param part Particle
+  /// \param lmagfield Magnetic field in Tesla
+  /// \param phiStar Output array of NRadii phi* values
+  template <typename T>
+  static void PhiAtRadiiTPC(const T& part, float lmagfield, float* phiStar)
+  {
+    float phi0 = part.phi();
+    // Start: Get the charge from cutcontainer using masks
+    float charge = 0.;
+    if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
+      charge = 0;
+    } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
+      charge = 1;
+    } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
+      charge = -1;
+    } else {
+      LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
+    }
+    // End: Get the charge from cutcontainer using masks
+    float pt = part.pt();
+    for (int i = 0; i < NRadii; i++) {
+      phiStar[i] = phi0 - std::asin(0.3 * charge * 0.1 * lmagfield * tmpRadiiTPC[i] * 0.01 / (2. * pt));
+    }
+  }
+
+  static constexpr int NRadii = 9; ///< Number of TPC radii at which phi* is computed
+
  private:
   HistogramRegistry* mHistogramRegistry = nullptr;   ///< For main output
   HistogramRegistry* mHistogramRegistryQA = nullptr; ///< For QA output
@@ -148,56 +227,57 @@ class FemtoDreamDetaDphiStar
 
   float deltaPhiMax;
   float deltaEtaMax;
-  float magfield;
+  float magfield = 0.f;
   bool plotForEveryRadii = false;
+  bool fillHistos = true; ///< Fill the Δη-Δφ* histograms
 
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpi{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
-  ///  Calculate phi at all required radii stored in tmpRadiiTPC
-  /// Magnetic field to be provided in Tesla
-  template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  bool useCache = false;                            ///< Cache the phi* of the particles, enabled by setEvent
+  std::unordered_map<int64_t, int> phiStarSlots;    ///< Position in phiStarCache of the phi* of each particle, by global index
+  std::vector<float> phiStarCache;                  ///< phi* of the cached particles, NRadii values per particle
+
+  /// Pairs further apart than deltaEtaMax in η cannot be in the ellipse, whatever their Δφ*
+  bool isCloseInEta(float deta) const { return std::abs(deta) < deltaEtaMax; }
+
+  bool isInEllipse(float deta, float dphiAvg) const
   {
+    return dphiAvg * dphiAvg / (deltaPhiMax * deltaPhiMax) + deta * deta / (deltaEtaMax * deltaEtaMax) < 1.;
+  }
 
-    float phi0 = part.phi();
-    // Start: Get the charge from cutcontainer using masks
-    float charge = 0.;
-    if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
-      charge = 0;
-    } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
-      charge = 1;
-    } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
-      charge = -1;
-    } else {
-      LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
+  /// phi* of a particle, from the cache if enabled (and computed on first use), in tmpPhiStar otherwise
+  template <typename T>
+  const float* getPhiStar(const T& part, float* tmpPhiStar)
+  {
+    if (!useCache) {
+      PhiAtRadiiTPC(part, magfield, tmpPhiStar);
+      return tmpPhiStar;
     }
-    // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+    auto [slot, inserted] = phiStarSlots.try_emplace(part.globalIndex(), phiStarCache.size());
+    if (inserted) {
+      phiStarCache.resize(phiStarCache.size() + NRadii);
+      PhiAtRadiiTPC(part, magfield, phiStarCache.data() + slot->second);
     }
+    return phiStarCache.data() + slot->second;
   }
 
   ///  Calculate average phi
-  template <typename T1, typename T2>
-  float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
+  /// \param dphi Optional output array of the NRadii Δφ*
+  static float AveragePhiStar(const float* phiStar1, const float* phiStar2, float* dphi = nullptr)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
+    std::array<float, NRadii> tmpDphi;
+    // branch-free wrapping in [-π, π], so that the loop over the radii can be vectorised
     float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
-      }
+    for (int i = 0; i < NRadii; i++) {
+      float d = phiStar1[i] - phiStar2[i];
+      tmpDphi[i] = d - o2::constants::math::TwoPI * std::nearbyint(d * (1.f / o2::constants::math::TwoPI));
+      dPhiAvg += tmpDphi[i];
+    }
+    if (dphi) {
+      std::copy(tmpDphi.begin(), tmpDphi.end(), dphi);
     }
-    return dPhiAvg / num;
+    return dPhiAvg / NRadii;
   }
 };
 
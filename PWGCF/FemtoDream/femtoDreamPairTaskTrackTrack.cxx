@@ -13,6 +13,7 @@
 /// \brief Tasks that reads the track tables used for the pairing and builds pairs of two tracks
 /// \author Andi Mathis, TU München, andreas.mathis@ph.tum.de
 
+#include <array>
 #include <vector>
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -22,6 +23,7 @@
 #include "Framework/StepTHn.h"
 
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "Common/Core/EventMixingPool.h"
 #include "FemtoDreamParticleHisto.h"
 #include "FemtoDreamEventHisto.h"
 #include "FemtoDreamPairCleaner.h"
@@ -44,6 +46,14 @@ static const std::vector<std::string> cutNames{"MaxPt", "PIDthr", "nSigmaTPC", "
 static const float cutsTable[nPart][nCuts]{
   {4.05f, 1.f, 3.f, 3.f, 100.f},
   {4.05f, 1.f, 3.f, 3.f, 100.f}};
+
+/// Track stored in a mixing pool, with the accessors of a femtodreamparticle used for the mixed pairs
+struct PoolParticle {
+  eventmixing::PoolTrack track;
+  float pt() const { return track.pt(); }
+  float eta() const { return track.eta(); }
+  float phi() const { return track.phi(); }
+};
 } // namespace
 
 struct femtoDreamPairTaskTrackTrack {
@@ -100,11 +110,16 @@ struct femtoDreamPairTaskTrackTrack {
   Configurable<int> ConfNEventsMix{"ConfNEventsMix", 5, "Number of events for mixing"};
   Configurable<bool> ConfIsCPR{"ConfIsCPR", true, "Close Pair Rejection"};
   Configurable<bool> ConfCPRPlotPerRadii{"ConfCPRPlotPerRadii", false, "Plot CPR per radii"};
+  Configurable<bool> ConfCPRFillHistos{"ConfCPRFillHistos", true, "Fill the #Delta#eta-#Delta#phi* histograms of the CPR"};
 
   FemtoDreamContainer<femtoDreamContainer::EventType::same, femtoDreamContainer::Observable::kstar> sameEventCont;
   FemtoDreamContainer<femtoDreamContainer::EventType::mixed, femtoDreamContainer::Observable::kstar> mixedEventCont;
   FemtoDreamPairCleaner<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCleaner;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCloseRejection;
+  /// Pool of the selected particles 1 of the past collisions of each mixing bin, with the magnetic field, multiplicity and QA bin of the collision
+  eventmixing::MixingPool poolPartsOne;
+  eventmixing::PoolEvent currentPartsOne;
+  eventmixing::PoolEvent currentPartsTwo;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry resultRegistry{"Correlations", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -127,7 +142,7 @@ struct femtoDreamPairTaskTrackTrack {
     mixedEventCont.setPDGCodes(ConfPDGCodePartOne, ConfPDGCodePartTwo);
     pairCleaner.init(&qaRegistry);
     if (ConfIsCPR) {
-      pairCloseRejection.init(&resultRegistry, &qaRegistry, 0.01, 0.01, ConfCPRPlotPerRadii); /// \todo add config for Δη and ΔΦ cut values
+      pairCloseRejection.init(&resultRegistry, &qaRegistry, 0.01, 0.01, ConfCPRPlotPerRadii, ConfCPRFillHistos); /// \todo add config for Δη and ΔΦ cut values
     }
 
     vPIDPartOne = ConfPIDPartOne;
@@ -143,6 +158,7 @@ struct femtoDreamPairTaskTrackTrack {
     MixQaRegistry.fill(HIST("MixingQA/hSECollisionBins"), colBinning.getBin({col.posZ(), col.multNtrPV()}));
 
     const auto& magFieldTesla = col.magField();
+    pairCloseRejection.setEvent(magFieldTesla);
 
     auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
     auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
@@ -224,59 +240,84 @@ struct femtoDreamPairTaskTrackTrack {
 
   PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processSameEvent, "Enable processing same event", true);
 
+  /// Copy the particles passing the momentum and PID selections into a pool event, with their phi* at the TPC radii if the CPR is enabled
+  template <typename PartitionType>
+  void fillPoolParticles(PartitionType const& parts, const char* partName, std::vector<int> const& vPID, float magFieldTesla, eventmixing::PoolEvent& poolEvent)
+  {
+    std::array<float, decltype(pairCloseRejection)::NRadii> phiStar;
+    for (auto& part : parts) {
+      if (part.p() > cfgCutTable->get(partName, "MaxP") || part.pt() > cfgCutTable->get(partName, "MaxPt")) {
+        continue;
+      }
+      if (!isFullPIDSelected(part.pidcut(),
+                             part.p(),
+                             cfgCutTable->get(partName, "PIDthr"),
+                             vPID,
+                             cfgNspecies,
+                             kNsigma,
+                             cfgCutTable->get(partName, "nSigmaTPC"),
+                             cfgCutTable->get(partName, "nSigmaTPCTOF"))) {
+        continue;
+      }
+      poolEvent.addTrack(part.pt(), part.eta(), part.phi(), 0, part.cut());
+      if (ConfIsCPR) {
+        pairCloseRejection.PhiAtRadiiTPC(part, magFieldTesla, phiStar.data());
+        poolEvent.addTrackValues(phiStar.data(), phiStar.size());
+      }
+    }
+  }
+
   /// This function processes the mixed event
-  /// \todo the trivial loops over the collisions and tracks should be factored out since they will be common to all combinations of T-T, T-V0, V0-V0, ...
+  /// Each collision is paired with the previous ConfNEventsMix collisions of its mixing bin in the dataframe: the particles 1 of
+  /// the earlier collision with the particles 2 of the later one. The selected particles are kept in a pool, so that they are
+  /// read and selected only once
   void processMixedEvent(o2::aod::FemtoDreamCollisions& cols,
                          o2::aod::FemtoDreamParticles& parts)
   {
-
-    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, 5, -1, cols, cols)) {
-
-      MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), colBinning.getBin({collision1.posZ(), collision1.multNtrPV()}));
-
-      auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, collision1.globalIndex());
-      auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, collision2.globalIndex());
-
-      const auto& magFieldTesla1 = collision1.magField();
-      const auto& magFieldTesla2 = collision2.magField();
-
-      if (magFieldTesla1 != magFieldTesla2) {
+    poolPartsOne.setDepth(ConfNEventsMix);
+    for (auto& collision : cols) {
+      const int mixingBin = colBinning.getBin({collision.posZ(), collision.multV0M()});
+      if (mixingBin < 0) {
         continue;
       }
 
-      /// \todo before mixing we should check whether both collisions contain a pair of particles!
-      // if (partsOne.size() == 0 || nPart2Evt1 == 0 || nPart1Evt2 == 0 || partsTwo.size() == 0 ) continue;
-
-      for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(groupPartsOne, groupPartsTwo))) {
-        if (p1.p() > cfgCutTable->get("PartOne", "MaxP") || p1.pt() > cfgCutTable->get("PartOne", "MaxPt") || p2.p() > cfgCutTable->get("PartTwo", "MaxP") || p2.pt() > cfgCutTable->get("PartTwo", "MaxPt")) {
-          continue;
-        }
-        if (!isFullPIDSelected(p1.pidcut(),
-                               p1.p(),
-                               cfgCutTable->get("PartOne", "PIDthr"),
-                               vPIDPartOne,
-                               cfgNspecies,
-                               kNsigma,
-                               cfgCutTable->get("PartOne", "nSigmaTPC"),
-                               cfgCutTable->get("PartOne", "nSigmaTPCTOF")) ||
-            !isFullPIDSelected(p2.pidcut(),
-                               p2.p(),
-                               cfgCutTable->get("PartTwo", "PIDthr"),
-                               vPIDPartTwo,
-                               cfgNspecies,
-                               kNsigma,
-                               cfgCutTable->get("PartTwo", "nSigmaTPC"),
-                               cfgCutTable->get("PartTwo", "nSigmaTPCTOF"))) {
+      auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, collision.globalIndex());
+      auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, collision.globalIndex());
+      currentPartsOne.clear();
+      currentPartsTwo.clear();
+      const auto& magFieldTesla2 = collision.magField();
+      fillPoolParticles(groupPartsOne, "PartOne", vPIDPartOne, magFieldTesla2, currentPartsOne);
+      fillPoolParticles(groupPartsTwo, "PartTwo", vPIDPartTwo, magFieldTesla2, currentPartsTwo);
+      currentPartsOne.addValue(collision.magField());
+      currentPartsOne.addValue(collision.multNtrPV());
+      currentPartsOne.addValue(colBinning.getBin({collision.posZ(), collision.multNtrPV()}));
+
+      for (int iEvent = 0; iEvent < poolPartsOne.getNEvents(mixingBin); ++iEvent) {
+        const auto& poolEvent = poolPartsOne.getEvent(mixingBin, iEvent);
+        const auto& magFieldTesla1 = poolEvent.values()[0];
+        const int multCol1 = poolEvent.values()[1];
+
+        MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), poolEvent.values()[2]);
+
+        if (magFieldTesla1 != magFieldTesla2) {
           continue;
         }
 
-        if (ConfIsCPR) {
-          if (pairCloseRejection.isClosePair(p1, p2, parts, magFieldTesla1)) {
-            continue;
+        for (auto track1 : poolEvent) {
+          for (auto track2 : currentPartsTwo) {
+            // the phi* of both particles were computed once when filling the pool events
+            if (ConfIsCPR) {
+              if (pairCloseRejection.isClosePairPhiStar(track1.eta() - track2.eta(), track1.values(), track2.values())) {
+                continue;
+              }
+            }
+            PoolParticle p1{track1};
+            PoolParticle p2{track2};
+            mixedEventCont.setPair(p1, p2, multCol1);
           }
         }
-        mixedEventCont.setPair(p1, p2, collision1.multNtrPV());
       }
+      poolPartsOne.addEvent(mixingBin, currentPartsOne);
     }
   }
 
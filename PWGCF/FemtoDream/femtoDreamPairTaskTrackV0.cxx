@@ -92,6 +92,7 @@ struct femtoDreamPairTaskTrackV0 {
   Configurable<int> ConfNEventsMix{"ConfNEventsMix", 5, "Number of events for mixing"};
   Configurable<bool> ConfIsCPR{"ConfIsCPR", true, "Close Pair Rejection"};
   Configurable<bool> ConfCPRPlotPerRadii{"ConfCPRPlotPerRadii", false, "Plot CPR per radii"};
+  Configurable<bool> ConfCPRFillHistos{"ConfCPRFillHistos", true, "Fill the #Delta#eta-#Delta#phi* histograms of the CPR"};
 
   FemtoDreamContainer<femtoDreamContainer::EventType::same, femtoDreamContainer::Observable::kstar> sameEventCont;
   FemtoDreamContainer<femtoDreamContainer::EventType::mixed, femtoDreamContainer::Observable::kstar> mixedEventCont;
@@ -113,7 +114,7 @@ struct femtoDreamPairTaskTrackV0 {
     mixedEventCont.setPDGCodes(ConfPDGCodePartOne, ConfPDGCodePartTwo);
     pairCleaner.init(&qaRegistry);
     if (ConfIsCPR) {
-      pairCloseRejection.init(&resultRegistry, &qaRegistry, 0.01, 0.01, ConfCPRPlotPerRadii); /// \todo add config for Δη and ΔΦ cut values
+      pairCloseRejection.init(&resultRegistry, &qaRegistry, 0.01, 0.01, ConfCPRPlotPerRadii, ConfCPRFillHistos); /// \todo add config for Δη and ΔΦ cut values
     }
 
     vPIDPartOne = ConfPIDPartOne;
@@ -125,6 +126,7 @@ struct femtoDreamPairTaskTrackV0 {
                         o2::aod::FemtoDreamParticles& parts)
   {
     const auto& magFieldTesla = col.magField();
+    pairCloseRejection.setEvent(magFieldTesla);
 
     auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
     auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::femtoDreamCollisionId, col.globalIndex());
@@ -186,6 +188,7 @@ struct femtoDreamPairTaskTrackV0 {
       if (magFieldTesla1 != magFieldTesla2) {
         continue;
       }
+      pairCloseRejection.setEvent(magFieldTesla1);
 
       for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(groupPartsOne, groupPartsTwo))) {
         if (p1.p() > cfgCutTable->get("PartOne", "MaxP") || p1.pt() > cfgCutTable->get("PartOne", "MaxPt")) {
@@ -10,7 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "GFW.h"
-GFW::GFW() : fInitialized(kFALSE){};
+GFW::GFW() : fInitialized(kFALSE), fPlanEvaluated(kFALSE){};
 
 GFW::~GFW()
 {
@@ -103,11 +103,40 @@ void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double
     CreateRegions();
   if (!fInitialized)
     return;
+  fPlanEvaluated = kFALSE;
   for (int i = 0; i < (int)fRegions.size(); ++i) {
     if (fRegions.at(i).EtaMin < eta && fRegions.at(i).EtaMax > eta && (fRegions.at(i).BitMask & mask))
       fCumulants.at(i).FillArray(eta, ptin, phi, weight, SecondWeight);
   };
 };
+void GFW::Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* SecondWeight)
+{
+  if (!fInitialized)
+    CreateRegions();
+  if (!fInitialized)
+    return;
+  fPlanEvaluated = kFALSE;
+  fBatchEta.resize(nParticles);
+  fBatchPt.resize(nParticles);
+  fBatchPhi.resize(nParticles);
+  fBatchWeight.resize(nParticles);
+  fBatchSecond.resize(nParticles);
+  for (int i = 0; i < (int)fRegions.size(); ++i) {
+    // Gather the particles of the region, then fill its Q-vectors in one go
+    int nInRegion = 0;
+    for (int j = 0; j < nParticles; ++j) {
+      if (!(fRegions.at(i).EtaMin < eta[j] && fRegions.at(i).EtaMax > eta[j] && (fRegions.at(i).BitMask & mask[j])))
+        continue;
+      fBatchEta[nInRegion] = eta[j];
+      fBatchPt[nInRegion] = ptin[j];
+      fBatchPhi[nInRegion] = phi[j];
+      fBatchWeight[nInRegion] = weight[j];
+      fBatchSecond[nInRegion] = SecondWeight ? SecondWeight[j] : -1;
+      nInRegion++;
+    };
+    fCumulants.at(i).FillArrays(nInRegion, fBatchEta.data(), fBatchPt.data(), fBatchPhi.data(), fBatchWeight.data(), fBatchSecond.data());
+  };
+};
 TComplex GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
 {
   TComplex part1 = r1->Vec(n1, p1, ptbin);
@@ -172,8 +201,7 @@ void GFW::Clear()
 {
   for (auto ptr = fCumulants.begin(); ptr != fCumulants.end(); ++ptr)
     ptr->ResetQs();
-  fCalculatedNames.clear();
-  fCalculatedQs.clear();
+  fPlanEvaluated = kFALSE;
 };
 TComplex GFW::Calculate(TString config, bool SetHarmsToZero)
 {
@@ -181,20 +209,28 @@ TComplex GFW::Calculate(TString config, bool SetHarmsToZero)
     printf("Configuration empty!\n");
     return TComplex(0, 0);
   };
+  // The configuration is only parsed the first time it is seen
+  std::string key = (SetHarmsToZero ? "0" : "") + std::string(config.Data());
+  auto itCompiled = fCompiledStrings.find(key);
+  int index = (itCompiled != fCompiledStrings.end()) ? itCompiled->second : (fCompiledStrings[key] = CompileString(config, SetHarmsToZero));
+  return CalculateCompiled(index);
+};
+int GFW::CompileString(TString config, bool SetHarmsToZero)
+{
+  CompiledCorr lCorr;
+  lCorr.FirstSubevent = fPlanSubevents.size();
   TString tmp;
   Ssiz_t sz1 = 0;
-  TComplex ret(1, 0);
   while (config.Tokenize(tmp, sz1, "}")) {
     if (SetHarmsToZero)
       SetHarmonicsToZero(tmp);
-    TComplex val = CalculateSingle(tmp);
-    ret *= val;
-    fCalculatedQs.push_back(val);
-    fCalculatedNames.push_back(tmp);
+    fPlanSubevents.push_back(CompileSingle(tmp));
   };
-  return ret;
+  lCorr.NSubevents = (int)fPlanSubevents.size() - lCorr.FirstSubevent;
+  fCompiledCorrs.push_back(lCorr);
+  return (int)fCompiledCorrs.size() - 1;
 };
-TComplex GFW::CalculateSingle(TString config)
+GFW::PlanSubevent GFW::CompileSingle(TString config)
 {
   // First remove all ; and ,:
   config.ReplaceAll(",", " ");
@@ -202,6 +238,7 @@ TComplex GFW::CalculateSingle(TString config)
   // Then make sure we don't have any double-spaces:
   while (config.Index("  ") > -1)
     config.ReplaceAll("  ", " ");
+  PlanSubevent lSubevent{-1, -1, 0, 0, -1, kFALSE};
   vector<int> regs;
   vector<int> hars;
   int ptbin = 0;
@@ -218,7 +255,7 @@ TComplex GFW::CalculateSingle(TString config)
     sz1 = 0;
   if (!config.Tokenize(ts, szend, "{")) {
     printf("Could not find harmonics!\n");
-    return TComplex(0, 0);
+    return lSubevent;
   };
   // Fetch regions
   while (ts.Tokenize(ts2, sz1, " ")) {
@@ -236,9 +273,16 @@ TComplex GFW::CalculateSingle(TString config)
   // Fetch harmonics
   while (config.Tokenize(ts, szend, " "))
     hars.push_back(ts.Atoi());
+  if (regs.size() < 1 || hars.size() < 1)
+    return lSubevent;
+  lSubevent.Poi = regs.at(0);
+  lSubevent.Ref = (regs.size() == 1) ? regs.at(0) : regs.at(1);
+  vector<int> pows(hars.size(), 1);
   if (regs.size() == 1)
-    return Calculate(regs.at(0), hars);
-  return Calculate(regs.at(0), regs.at(1), hars, ptbin);
+    lSubevent.Node = CompileRecursive(lSubevent.Poi, lSubevent.Poi, lSubevent.Poi, 0, hars, pows); // same as Calculate(poi, hars)
+  else
+    lSubevent.Node = CompileRecursive(lSubevent.Poi, lSubevent.Ref, lSubevent.Poi, ptbin, hars, pows); // same as Calculate(poi, ref, hars, ptbin)
+  return lSubevent;
 };
 GFW::CorrConfig GFW::GetCorrelatorConfig(TString config, TString head, bool ptdif)
 {
@@ -359,6 +403,159 @@ TComplex GFW::Calculate(int poi, vector<int> hars)
   GFWCumulant* qpoi = &fCumulants.at(poi);
   return RecursiveCorr(qpoi, qpoi, qpoi, 0, hars);
 };
+int GFW::Compile(const CorrConfig& corconf, int ptbin, bool SetHarmsToZero, bool DisableOverlap)
+{
+  // Mirrors Calculate(CorrConfig, ...); the checks on the filled pT bins and number of entries are done in CalculateCompiled
+  CompiledCorr lCorr;
+  lCorr.FirstSubevent = fPlanSubevents.size();
+  for (int i = 0; i < (int)corconf.Regs.size(); i++) {
+    PlanSubevent lSubevent{-1, -1, ptbin, 0, -1, kTRUE};
+    if (corconf.Regs.at(i).size() == 0) {
+      fPlanSubevents.push_back(lSubevent); // no regions in the subevent, the correlator is always 0
+      continue;
+    };
+    int poi = corconf.Regs.at(i).at(0);
+    int ref = (corconf.Regs.at(i).size() > 1) ? corconf.Regs.at(i).at(1) : corconf.Regs.at(i).at(0);
+    int ovl = corconf.Overlap.at(i);
+    int qovl = -1;
+    if (ovl > -1)
+      qovl = DisableOverlap ? -1 : ovl;
+    else if (ref == poi)
+      qovl = ref;
+    vector<int> hars = corconf.Hars.at(i);
+    if (SetHarmsToZero)
+      std::fill(hars.begin(), hars.end(), 0);
+    vector<int> pows(hars.size(), 1);
+    lSubevent.Poi = poi;
+    lSubevent.Ref = ref;
+    lSubevent.MinN = (poi != ref) ? (int)hars.size() - 1 : (int)hars.size();
+    lSubevent.Node = CompileRecursive(poi, ref, qovl, ptbin, hars, pows);
+    fPlanSubevents.push_back(lSubevent);
+  };
+  lCorr.NSubevents = (int)fPlanSubevents.size() - lCorr.FirstSubevent;
+  fCompiledCorrs.push_back(lCorr);
+  return (int)fCompiledCorrs.size() - 1;
+};
+TComplex GFW::CalculateCompiled(int index)
+{
+  if (!fInitialized)
+    return TComplex(0, 0);
+  const CompiledCorr& lCorr = fCompiledCorrs.at(index);
+  if (lCorr.NSubevents == 0)
+    return TComplex(0, 0);
+  if (!fPlanEvaluated)
+    EvaluatePlan();
+  TComplex retval(1, 0);
+  for (int i = lCorr.FirstSubevent; i < lCorr.FirstSubevent + lCorr.NSubevents; i++) {
+    const PlanSubevent& lSubevent = fPlanSubevents[i];
+    if (lSubevent.Node < 0)
+      return TComplex(0, 0);
+    if (lSubevent.Check) {
+      GFWCumulant& qref = fCumulants[lSubevent.Ref];
+      if (!qref.IsPtBinFilled(lSubevent.PtBin) || !fCumulants[lSubevent.Poi].IsPtBinFilled(lSubevent.PtBin))
+        return TComplex(0, 0);
+      if (qref.GetN() < lSubevent.MinN)
+        return TComplex(0, 0);
+    };
+    retval *= fPlanValues[lSubevent.Node];
+  };
+  return retval;
+};
+void GFW::EvaluatePlan()
+{
+  // Nodes are stored after the nodes they depend on, so that a single pass is enough
+  for (int i = 0; i < (int)fPlanNodes.size(); i++) {
+    const PlanNode& lNode = fPlanNodes[i];
+    if (lNode.Cumulant >= 0) {
+      fPlanValues[i] = fCumulants[lNode.Cumulant].Vec(lNode.Har, lNode.Pow, lNode.PtBin);
+      continue;
+    };
+    TComplex lValue(0, 0);
+    for (int j = lNode.FirstTerm; j < lNode.FirstTerm + lNode.NTerms; j++) {
+      const PlanTerm& lTerm = fPlanTerms[j];
+      if (lTerm.B < 0)
+        lValue += lTerm.Coef * fPlanValues[lTerm.A];
+      else
+        lValue += lTerm.Coef * fPlanValues[lTerm.A] * fPlanValues[lTerm.B];
+    };
+    fPlanValues[i] = lValue;
+  };
+  fPlanEvaluated = kTRUE;
+};
+int GFW::AddPlanNode(const vector<int>& key, const vector<PlanTerm>& terms)
+{
+  PlanNode lNode{-1, 0, 0, 0, (int)fPlanTerms.size(), (int)terms.size()};
+  fPlanTerms.insert(fPlanTerms.end(), terms.begin(), terms.end());
+  fPlanNodes.push_back(lNode);
+  fPlanValues.push_back(TComplex(0, 0));
+  fPlanEvaluated = kFALSE;
+  return fPlanNodeIndex[key] = (int)fPlanNodes.size() - 1;
+};
+int GFW::CompileVec(int cumulant, int har, int pow, int ptbin)
+{
+  vector<int> key{-1, cumulant, har, pow, ptbin};
+  auto itNode = fPlanNodeIndex.find(key);
+  if (itNode != fPlanNodeIndex.end())
+    return itNode->second;
+  PlanNode lNode{cumulant, har, pow, ptbin, 0, 0};
+  fPlanNodes.push_back(lNode);
+  fPlanValues.push_back(TComplex(0, 0));
+  fPlanEvaluated = kFALSE;
+  return fPlanNodeIndex[key] = (int)fPlanNodes.size() - 1;
+};
+int GFW::CompileTwoRec(int n1, int n2, int p1, int p2, int ptbin, int r1, int r2, int r3)
+{
+  // Same as TwoRec
+  vector<int> key{-2, n1, n2, p1, p2, ptbin, r1, r2, r3};
+  auto itNode = fPlanNodeIndex.find(key);
+  if (itNode != fPlanNodeIndex.end())
+    return itNode->second;
+  vector<PlanTerm> terms{{1., CompileVec(r1, n1, p1, ptbin), CompileVec(r2, n2, p2, ptbin)}};
+  if (r3 >= 0)
+    terms.push_back({-1., CompileVec(r3, n1 + n2, p1 + p2, ptbin), -1});
+  return AddPlanNode(key, terms);
+};
+int GFW::CompileRecursive(int poi, int ref, int ol, int ptbin, vector<int>& hars, vector<int>& pows)
+{
+  // Same as RecursiveCorr, with the regions given by index (-1 if not defined)
+  if ((pows.at(0) != 1) && ol >= 0)
+    poi = ol;
+  if (hars.size() < 2)
+    return CompileVec(poi, hars.at(0), pows.at(0), ptbin);
+  if (hars.size() < 3)
+    return CompileTwoRec(hars.at(0), hars.at(1), pows.at(0), pows.at(1), ptbin, poi, ref, ol);
+  vector<int> key{-3, poi, ref, ol, ptbin};
+  key.insert(key.end(), hars.begin(), hars.end());
+  key.insert(key.end(), pows.begin(), pows.end());
+  auto itNode = fPlanNodeIndex.find(key);
+  if (itNode != fPlanNodeIndex.end())
+    return itNode->second;
+  int harlast = hars.at(hars.size() - 1);
+  int powlast = pows.at(pows.size() - 1);
+  hars.erase(hars.end() - 1);
+  pows.erase(pows.end() - 1);
+  vector<PlanTerm> terms{{1., CompileRecursive(poi, ref, ol, ptbin, hars, pows), CompileVec(ref, harlast, powlast, 0)}};
+  int lDegeneracy = 1;
+  int harSize = (int)hars.size();
+  for (int i = harSize - 1; i >= 0; i--) {
+    // same permutation check as in RecursiveCorr
+    if (i > 2) {
+      if (hars.at(i) == hars.at(i - 1) && pows.at(i) == pows.at(i - 1)) {
+        lDegeneracy++;
+        continue;
+      };
+    }
+    hars.at(i) += harlast;
+    pows.at(i) += powlast;
+    terms.push_back({-1. * lDegeneracy, CompileRecursive(poi, ref, ol, ptbin, hars, pows), -1});
+    lDegeneracy = 1;
+    hars.at(i) -= harlast;
+    pows.at(i) -= powlast;
+  };
+  hars.push_back(harlast);
+  pows.push_back(powlast);
+  return AddPlanNode(key, terms);
+};
 int GFW::FindRegionByName(TString refName)
 {
   for (int i = 0; i < (int)fRegions.size(); i++)
@@ -366,16 +563,6 @@ int GFW::FindRegionByName(TString refName)
       return i;
   return -1;
 };
-int GFW::FindCalculated(TString identifier)
-{
-  if (fCalculatedNames.size() == 0)
-    return -1;
-  for (int i = 0; i < (int)fCalculatedNames.size(); i++) {
-    if (fCalculatedNames.at(i).EqualTo(identifier))
-      return i;
-  };
-  return -1;
-};
 bool GFW::SetHarmonicsToZero(TString& instr)
 {
   TString tmp;
@@ -15,6 +15,8 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <map>
+#include <string>
 #include "TString.h"
 #include "TObjArray.h"
 using std::vector;
@@ -69,16 +71,29 @@ class GFW
   void AddRegion(TString refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT = 1, int BitMask = 1);
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  // Fill a batch of particles; secondWeight can be null (no second weight for any particle)
+  void Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight = nullptr);
   void Clear(); // { for(auto ptr = fCumulants.begin(); ptr!=fCumulants.end(); ++ptr) ptr->ResetQs(); };
   GFWCumulant GetCumulant(int index) { return fCumulants.at(index); };
   TComplex Calculate(TString config, bool SetHarmsToZero = kFALSE);
   CorrConfig GetCorrelatorConfig(TString config, TString head = "", bool ptdif = kFALSE);
   TComplex Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero, bool DisableOverlap = kFALSE);
+  // Compiled correlators: each correlator is turned once into nodes of an evaluation plan shared by all the compiled
+  // correlators (common sub-terms are evaluated only once), and the plan is evaluated in one pass per event
+  int Compile(const CorrConfig& corconf, int ptbin = 0, bool SetHarmsToZero = kFALSE, bool DisableOverlap = kFALSE); // returns the index for CalculateCompiled
+  TComplex CalculateCompiled(int index); // same as Calculate(corconf, ptbin, SetHarmsToZero, DisableOverlap)
+  int GetNPlanNodes() { return fPlanNodes.size(); };
 
  private:
   bool fInitialized;
   void SplitRegions();
   GFWCumulant fEmptyCumulant;
+  // Scratch arrays for the batch Fill, holding the particles of one region
+  vector<double> fBatchEta;    //!
+  vector<int> fBatchPt;        //!
+  vector<double> fBatchPhi;    //!
+  vector<double> fBatchWeight; //!
+  vector<double> fBatchSecond; //!
   TComplex TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   TComplex RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, vector<int>& hars, vector<int>& pows); // POI, Ref. flow, overlapping region
   TComplex RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, vector<int>& hars);                    // POI, Ref. flow, overlapping region
@@ -86,14 +101,43 @@ class GFW
   void AddRegion(Region inreg) { fRegions.push_back(inreg); };
   Region GetRegion(int index) { return fRegions.at(index); };
   int FindRegionByName(TString refName);
-  vector<TString> fCalculatedNames;
-  vector<TComplex> fCalculatedQs;
-  int FindCalculated(TString identifier);
   // Calculateing functions:
   TComplex Calculate(int poi, int ref, vector<int> hars, int ptbin = 0); // For differential, need POI and reference
   TComplex Calculate(int poi, vector<int> hars);                         // For integrated case
+  // Evaluation plan. A node is either a Q-vector (Cumulant >= 0) or a sum of terms Coef*node A*node B
+  struct PlanTerm {
+    double Coef;
+    int A;
+    int B; // -1 if the term has a single factor
+  };
+  struct PlanNode {
+    int Cumulant, Har, Pow, PtBin; // Q-vector
+    int FirstTerm, NTerms;         // sum of terms
+  };
+  struct PlanSubevent {
+    int Poi, Ref, PtBin, MinN;
+    int Node;   // -1 if the subevent is not valid (value 0)
+    bool Check; // whether POI/REF have to be filled in PtBin and REF needs at least MinN entries
+  };
+  struct CompiledCorr {
+    int FirstSubevent, NSubevents;
+  };
+  vector<PlanTerm> fPlanTerms;                    //!
+  vector<PlanNode> fPlanNodes;                    //!
+  vector<PlanSubevent> fPlanSubevents;            //!
+  vector<CompiledCorr> fCompiledCorrs;            //!
+  std::map<vector<int>, int> fPlanNodeIndex;      //! node of each Q-vector/recursion, to share common sub-terms
+  std::map<std::string, int> fCompiledStrings;    //! compiled correlator of each configuration string
+  vector<TComplex> fPlanValues;                   //! node values for the current event
+  bool fPlanEvaluated;                            //!
+  void EvaluatePlan();
+  int AddPlanNode(const vector<int>& key, const vector<PlanTerm>& terms);
+  int CompileVec(int cumulant, int har, int pow, int ptbin);
+  int CompileTwoRec(int n1, int n2, int p1, int p2, int ptbin, int r1, int r2, int r3);
+  int CompileRecursive(int poi, int ref, int ol, int ptbin, vector<int>& hars, vector<int>& pows);
+  int CompileString(TString config, bool SetHarmsToZero);
   // Process one string (= one region)
-  TComplex CalculateSingle(TString config);
+  PlanSubevent CompileSingle(TString config);
 
   bool SetHarmonicsToZero(TString& instr);
 };
@@ -10,14 +10,16 @@
 // or submit itself to any jurisdiction.
 
 #include "GFWCumulant.h"
+#include <algorithm>
+#include <cmath>
 
-GFWCumulant::GFWCumulant() : fQvector(0),
-                             fUsed(kBlank),
+GFWCumulant::GFWCumulant() : fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
+                             fPtStride(0),
+                             fMaxPow(0),
                              fInitialized(kFALSE){};
 
 GFWCumulant::~GFWCumulant(){
@@ -33,53 +35,118 @@ void GFWCumulant::FillArray(double eta, int ptin, double phi, double weight, dou
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = kTRUE;
+  // Harmonics are obtained by rotating the previous one by phi, so that sin/cos are only evaluated once
+  const double lSin1 = std::sin(phi);
+  const double lCos1 = std::cos(phi);
+  // If second weight is specified, then keep the first weight with power no more than 1, and use the other weight otherwise
+  // this is important when POIs are a subset of REFs and have different weights than REFs
+  const double lMult = (SecondWeight > 0) ? SecondWeight : weight;
+  double lSin = 0;
+  double lCos = 1;
+  double* lQRe = fQRe.data() + ptin * fPtStride;
+  double* lQIm = fQIm.data() + ptin * fPtStride;
   for (int lN = 0; lN < fN; lN++) {
-    double lSin = TMath::Sin(lN * phi); // No need to recalculate for each power
-    double lCos = TMath::Cos(lN * phi); // No need to recalculate for each power
+    if (lN > 0) {
+      const double lSinPrev = lSin;
+      lSin = lSinPrev * lCos1 + lCos * lSin1;
+      lCos = lCos * lCos1 - lSinPrev * lSin1;
+    }
+    // Powers of the weight as running products; multiplication is cheaper than power
+    double lPrefactor = 1;
     for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = TMath::Power(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = TMath::Power(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow](fQvector[ptin][lN][lPow].Re() + qcos, fQvector[ptin][lN][lPow].Im() + qsin); //+=TComplex(qcos,qsin);
+      lQRe[fHarOffset[lN] + lPow] += lPrefactor * lCos;
+      lQIm[fHarOffset[lN] + lPow] += lPrefactor * lSin;
+      lPrefactor *= (lPow == 0) ? weight : lMult;
     };
   };
   Inc();
 };
-void GFWCumulant::ResetQs()
+void GFWCumulant::FillArrays(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const double* SecondWeight)
 {
-  if (!fNEntries)
-    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = kFALSE;
-    for (int lN = 0; lN < fN; lN++) {
-      for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow](0., 0.);
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  if (nParticles <= 0)
+    return;
+  fBatchPt.resize(nParticles);
+  fBatchCos1.resize(nParticles);
+  fBatchSin1.resize(nParticles);
+  fBatchCos.resize(nParticles);
+  fBatchSin.resize(nParticles);
+  fBatchPref.resize(static_cast<size_t>(fMaxPow) * nParticles);
+  // Keep only the particles in range and compute their first harmonic and weight powers
+  int nFill = 0;
+  for (int i = 0; i < nParticles; i++) {
+    int lPt = (fPt == 1) ? 0 : ptin[i];
+    if (lPt < 0 || lPt >= fPt)
+      continue;
+    fFilledPts[lPt] = kTRUE;
+    fBatchPt[nFill] = lPt;
+    fBatchSin1[nFill] = std::sin(phi[i]);
+    fBatchCos1[nFill] = std::cos(phi[i]);
+    const double lMult = (SecondWeight && SecondWeight[i] > 0) ? SecondWeight[i] : weight[i];
+    double lPrefactor = 1;
+    for (int lPow = 0; lPow < fMaxPow; lPow++) {
+      fBatchPref[lPow * nParticles + nFill] = lPrefactor;
+      lPrefactor *= (lPow == 0) ? weight[i] : lMult;
+    };
+    nFill++;
+  };
+  double* lCos = fBatchCos.data();
+  double* lSin = fBatchSin.data();
+  const double* lCos1 = fBatchCos1.data();
+  const double* lSin1 = fBatchSin1.data();
+  std::fill(lCos, lCos + nFill, 1.);
+  std::fill(lSin, lSin + nFill, 0.);
+  // Loops over particles are innermost, so that the rotation and the accumulation can be vectorised
+  for (int lN = 0; lN < fN; lN++) {
+    if (lN > 0) {
+      for (int i = 0; i < nFill; i++) {
+        const double lSinPrev = lSin[i];
+        lSin[i] = lSinPrev * lCos1[i] + lCos[i] * lSin1[i];
+        lCos[i] = lCos[i] * lCos1[i] - lSinPrev * lSin1[i];
       };
+    }
+    for (int lPow = 0; lPow < PW(lN); lPow++) {
+      const double* lPref = fBatchPref.data() + lPow * nParticles;
+      const int lIndex = fHarOffset[lN] + lPow;
+      if (fPt == 1) {
+        double lSumRe = 0;
+        double lSumIm = 0;
+        for (int i = 0; i < nFill; i++) {
+          lSumRe += lPref[i] * lCos[i];
+          lSumIm += lPref[i] * lSin[i];
+        };
+        fQRe[lIndex] += lSumRe;
+        fQIm[lIndex] += lSumIm;
+      } else {
+        for (int i = 0; i < nFill; i++) {
+          fQRe[fBatchPt[i] * fPtStride + lIndex] += lPref[i] * lCos[i];
+          fQIm[fBatchPt[i] * fPtStride + lIndex] += lPref[i] * lSin[i];
+        };
+      }
     };
   };
+  fNEntries += nFill;
+};
+void GFWCumulant::ResetQs()
+{
+  if (!fNEntries)
+    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
+  std::fill(fFilledPts.begin(), fFilledPts.end(), kFALSE);
+  std::fill(fQRe.begin(), fQRe.end(), 0.);
+  std::fill(fQIm.begin(), fQIm.end(), 0.);
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    };
-  };
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  };
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQRe.clear();
+  fQIm.clear();
+  fFilledPts.clear();
+  fHarOffset.clear();
+  fPtStride = 0;
+  fMaxPow = 0;
   fInitialized = kFALSE;
   fNEntries = -1;
 };
@@ -98,17 +165,19 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
   fPowVec = PowVec;
-  fQvector = new TComplex**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new TComplex*[fN];
-  };
+  // Contiguous [pt][harmonic][power] layout; harmonics can have different numbers of powers
+  fHarOffset.resize(fN);
+  fPtStride = 0;
+  fMaxPow = 0;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new TComplex[PW(l_n)];
-    };
+    fHarOffset[l_n] = fPtStride;
+    fPtStride += PW(l_n);
+    fMaxPow = std::max(fMaxPow, PW(l_n));
   };
+  fQRe.assign(static_cast<size_t>(fPt) * fPtStride, 0.);
+  fQIm.assign(static_cast<size_t>(fPt) * fPtStride, 0.);
+  fFilledPts.assign(fPt, kFALSE);
   ResetQs();
   fInitialized = kTRUE;
 };
@@ -119,6 +188,6 @@ TComplex GFWCumulant::Vec(int n, int p, int ptbin)
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
   if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return TComplex::Conjugate(fQvector[ptbin][-n][p]);
-};
\ No newline at end of file
+    return TComplex(fQRe[ptbin * fPtStride + fHarOffset[n] + p], fQIm[ptbin * fPtStride + fHarOffset[n] + p]);
+  return TComplex(fQRe[ptbin * fPtStride + fHarOffset[-n] + p], -fQIm[ptbin * fPtStride + fHarOffset[-n] + p]);
+};
@@ -15,6 +15,7 @@
 #include "TNamed.h"
 #include "TMath.h"
 #include "TAxis.h"
+#include <vector>
 using std::vector;
 class GFWCumulant
 {
@@ -23,6 +24,8 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(double eta, int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  // Fill a batch of particles at once. SecondWeight can be null (no second weight for any particle)
+  void FillArrays(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const double* SecondWeight = nullptr);
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -34,7 +37,9 @@ class GFWCumulant
   void Inc() { fNEntries++; };
   int GetN() { return fNEntries; };
   // protected:
-  TComplex*** fQvector;
+  // Q-vectors, stored contiguously as [pt][harmonic][power] in separate real and imaginary arrays
+  vector<double> fQRe; //! Real parts
+  vector<double> fQIm; //! Imaginary parts
   unsigned int fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
@@ -43,7 +48,10 @@ class GFWCumulant
   int fPow;                              //! Power
   vector<int> fPowVec;                   //! Powers array
   int fPt;                               //! fPt bins
-  bool* fFilledPts;
+  vector<int> fHarOffset;                //! Offset of each harmonic within a pt bin
+  int fPtStride;                         //! Number of (harmonic, power) entries per pt bin
+  int fMaxPow;                           //! Largest number of powers of all harmonics
+  vector<bool> fFilledPts;
   bool fInitialized; // Arrays are initialized
   void CreateComplexVectorArray(int N = 1, int P = 1, int Pt = 1);
   void CreateComplexVectorArrayVarPower(int N = 1, vector<int> Pvec = {1}, int Pt = 1);
@@ -51,10 +59,19 @@ class GFWCumulant
   void DestroyComplexVectorArray();
   bool IsPtBinFilled(int ptb)
   {
-    if (!fFilledPts)
+    if (!fInitialized)
       return kFALSE;
     return fFilledPts[ptb];
   };
+
+ private:
+  // Scratch arrays for FillArrays, one entry per particle (and per power for fBatchPref)
+  vector<int> fBatchPt;       //!
+  vector<double> fBatchCos1;  //!
+  vector<double> fBatchSin1;  //!
+  vector<double> fBatchCos;   //!
+  vector<double> fBatchSin;   //!
+  vector<double> fBatchPref;  //!
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -29,7 +29,10 @@
 #include "DataFormatsParameters/GRPMagField.h"
 
 #include <TH1F.h>
+#include <algorithm>
 #include <cmath>
+#include <numeric>
+#include <vector>
 #include <TDirectory.h>
 #include <THn.h>
 
@@ -229,17 +232,69 @@ struct CorrelationTask {
     return true;
   }
 
+  // Associated tracks of an event passing the single-track selections, in a structure of arrays sorted in pT
+  struct AssociatedTracks {
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<float> efficiency; // efficiency correction, 1 if not applied
+    std::vector<int> sign;
+    std::vector<int64_t> globalIndex;
+    std::vector<int> order;   // sorting permutation
+    std::vector<float> ptRaw; // pT in table order, used for the sorting
+
+    void resize(size_t size)
+    {
+      pt.resize(size);
+      eta.resize(size);
+      phi.resize(size);
+      efficiency.resize(size);
+      sign.resize(size);
+      globalIndex.resize(size);
+    }
+  } mAssociated;
+
   template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
   void fillCorrelations(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
   {
-    // Cache efficiency for particles (too many FindBin lookups)
-    float* efficiencyAssociated = nullptr;
-    if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-      if (cfg.mEfficiencyAssociated) {
-        efficiencyAssociated = new float[tracks2.size()];
-        int i = 0;
-        for (auto& track : tracks2) {
-          efficiencyAssociated[i++] = getEfficiencyCorrection(cfg.mEfficiencyAssociated, track.eta(), track.pt(), multiplicity, posZ);
+    // Pre-pass over the associated tracks: the single-track selections are applied once per event and the efficiency
+    // is cached (too many FindBin lookups otherwise). The tracks are sorted in pT so that the pT ordering becomes a range bound.
+    std::vector<decltype(tracks2.begin())> associatedTracks; // kept for the pair cuts
+    associatedTracks.reserve(tracks2.size());
+    mAssociated.ptRaw.clear();
+    for (auto& track2 : tracks2) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track2)) {
+          continue;
+        }
+      }
+      if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+        continue;
+      }
+      associatedTracks.push_back(track2);
+      mAssociated.ptRaw.push_back(track2.pt());
+    }
+
+    const size_t nAssociated = associatedTracks.size();
+    mAssociated.order.resize(nAssociated);
+    std::iota(mAssociated.order.begin(), mAssociated.order.end(), 0);
+    std::stable_sort(mAssociated.order.begin(), mAssociated.order.end(), [this](int a, int b) { return mAssociated.ptRaw[a] < mAssociated.ptRaw[b]; });
+
+    mAssociated.resize(nAssociated);
+    std::vector<decltype(tracks2.begin())> sortedTracks;
+    sortedTracks.reserve(nAssociated);
+    for (size_t i = 0; i < nAssociated; i++) {
+      auto& track2 = associatedTracks[mAssociated.order[i]];
+      sortedTracks.push_back(track2);
+      mAssociated.pt[i] = track2.pt();
+      mAssociated.eta[i] = track2.eta();
+      mAssociated.phi[i] = track2.phi();
+      mAssociated.sign[i] = track2.sign();
+      mAssociated.globalIndex[i] = track2.globalIndex();
+      mAssociated.efficiency[i] = 1.0f;
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (cfg.mEfficiencyAssociated) {
+          mAssociated.efficiency[i] = getEfficiencyCorrection(cfg.mEfficiencyAssociated, track2.eta(), track2.pt(), multiplicity, posZ);
         }
       }
     }
@@ -266,47 +321,42 @@ struct CorrelationTask {
 
       target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
 
-      for (auto& track2 : tracks2) {
-        if (track1.globalIndex() == track2.globalIndex()) {
-          // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
-          continue;
-        }
+      const float pt1 = track1.pt();
+      const float eta1 = track1.eta();
+      const float phi1 = track1.phi();
+      const int sign1 = track1.sign();
+      const int64_t globalIndex1 = track1.globalIndex();
 
-        if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-          if (!checkObject<step>(track2)) {
-            continue;
-          }
-        }
+      // with pT ordering only associated tracks with lower pT than the trigger are used
+      size_t nPaired = nAssociated;
+      if (cfgPtOrder != 0) {
+        nPaired = std::lower_bound(mAssociated.pt.begin(), mAssociated.pt.end(), pt1) - mAssociated.pt.begin();
+      }
 
-        if (cfgPtOrder != 0 && track2.pt() >= track1.pt()) {
+      for (size_t i = 0; i < nPaired; i++) {
+        if (globalIndex1 == mAssociated.globalIndex[i]) {
           continue;
         }
 
-        if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
-          continue;
-        }
-        if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * track2.sign() < 0) {
+        if (cfgPairCharge != 0 && cfgPairCharge * sign1 * mAssociated.sign[i] < 0) {
           continue;
         }
 
         if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
-          if (cfg.mPairCuts && mPairCuts.conversionCuts(track1, track2)) {
+          // conversion cuts only apply to unlike-sign pairs
+          if (cfg.mPairCuts && sign1 * mAssociated.sign[i] <= 0 && mPairCuts.conversionCuts(track1, sortedTracks[i])) {
             continue;
           }
 
-          if (cfgTwoTrackCut > 0 && mPairCuts.twoTrackCut(track1, track2, magField)) {
+          // the two-track cut, which needs the B field, can only remove pairs close in eta
+          if (cfgTwoTrackCut > 0 && mPairCuts.isInTwoTrackWindow(eta1 - mAssociated.eta[i]) && mPairCuts.twoTrackCut(track1, sortedTracks[i], magField)) {
             continue;
           }
         }
 
-        float associatedWeight = triggerWeight;
-        if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-          if (cfg.mEfficiencyAssociated) {
-            associatedWeight *= efficiencyAssociated[track2.filteredIndex()];
-          }
-        }
+        float associatedWeight = triggerWeight * mAssociated.efficiency[i];
 
-        float deltaPhi = track1.phi() - track2.phi();
+        float deltaPhi = phi1 - mAssociated.phi[i];
         if (deltaPhi > 1.5f * PI) {
           deltaPhi -= TwoPI;
         }
@@ -314,12 +364,10 @@ struct CorrelationTask {
           deltaPhi += TwoPI;
         }
 
-        target->getPairHist()->Fill(step,
-                                    track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+        target->fillPairBuffered(step, eta1 - mAssociated.eta[i], mAssociated.pt[i], pt1, multiplicity, deltaPhi, posZ, associatedWeight);
       }
     }
-
-    delete[] efficiencyAssociated;
+    target->flushPairBuffer();
   }
 
   void loadEfficiency(uint64_t timestamp)
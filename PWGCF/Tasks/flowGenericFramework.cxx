@@ -71,6 +71,10 @@ struct GenericFramework {
   // define global variables
   GFW* fGFW = new GFW();
   std::vector<GFW::CorrConfig> corrconfigs;
+  std::vector<std::pair<int, int>> compiledconfigs; // compiled (denominator, numerator) of each correlator
+  // particles of the collision, filled into the GFW in one batch
+  std::vector<double> fEta, fPhi, fWeight;
+  std::vector<int> fPtIn, fMask;
   TRandom3* fRndm = new TRandom3(0);
 
   void init(InitContext const&)
@@ -120,16 +124,19 @@ struct GenericFramework {
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {4} refN {-4}", "ChGap42", kFALSE));
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {2 4} refN {-2 -4}", "ChSC244", kFALSE));
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {2 3} refN {-2 -3}", "ChSC234", kFALSE));
+    for (const auto& corrconf : corrconfigs) {
+      compiledconfigs.emplace_back(fGFW->Compile(corrconf, 0, kTRUE), fGFW->Compile(corrconf, 0, kFALSE));
+    }
   }
 
-  void FillFC(const GFW::CorrConfig& corrconf, const double& cent, const double& rndm)
+  void FillFC(const GFW::CorrConfig& corrconf, const std::pair<int, int>& compiled, const double& cent, const double& rndm)
   {
     double dnx, val;
-    dnx = fGFW->Calculate(corrconf, 0, kTRUE).Re();
+    dnx = fGFW->CalculateCompiled(compiled.first).Re();
     if (dnx == 0)
       return;
     if (!corrconf.pTDif) {
-      val = fGFW->Calculate(corrconf, 0, kFALSE).Re() / dnx;
+      val = fGFW->CalculateCompiled(compiled.second).Re() / dnx;
       if (TMath::Abs(val) < 1)
         fFC->FillProfile(corrconf.Head.Data(), cent, val, 1, rndm);
       return;
@@ -164,6 +171,11 @@ struct GenericFramework {
     float l_Random = fRndm->Rndm();
     float weff = 1, wacc = 1;
 
+    fEta.clear();
+    fPtIn.clear();
+    fPhi.clear();
+    fWeight.clear();
+    fMask.clear();
     for (auto& track : tracks) {
       registry.fill(HIST("hPhi"), track.phi());
       registry.fill(HIST("hEta"), track.eta());
@@ -180,10 +192,15 @@ struct GenericFramework {
       else
         wacc = 1;
 
-      fGFW->Fill(track.eta(), 1, track.phi(), wacc * weff, 3);
+      fEta.push_back(track.eta());
+      fPtIn.push_back(1);
+      fPhi.push_back(track.phi());
+      fWeight.push_back(wacc * weff);
+      fMask.push_back(3);
     }
+    fGFW->Fill(fEta.size(), fEta.data(), fPtIn.data(), fPhi.data(), fWeight.data(), fMask.data());
     for (unsigned long int l_ind = 0; l_ind < corrconfigs.size(); l_ind++) {
-      FillFC(corrconfigs.at(l_ind), centrality, l_Random);
+      FillFC(corrconfigs.at(l_ind), compiledconfigs.at(l_ind), centrality, l_Random);
     };
   }
 };
@@ -68,3 +68,34 @@ bool AnalysisCompositeCut::IsSelected(float* values)
     return false;
   }
 }
+
+//____________________________________________________________________________
+void AnalysisCompositeCut::IsSelected(const ValuesBatch& batch, uint8_t* decisions)
+{
+  //
+  // apply cuts on all the rows of a batch
+  //
+  const int nRows = batch.GetNRows();
+  for (int i = 0; i < nRows; ++i) {
+    decisions[i] = (fOptionUseAND ? 1 : 0);
+  }
+
+  std::vector<uint8_t> cutDecisions(nRows);
+  auto combine = [&]() {
+    for (int i = 0; i < nRows; ++i) {
+      if (fOptionUseAND) {
+        decisions[i] &= cutDecisions[i];
+      } else {
+        decisions[i] |= cutDecisions[i];
+      }
+    }
+  };
+  for (std::vector<AnalysisCut>::iterator it = fCutList.begin(); it < fCutList.end(); ++it) {
+    (*it).IsSelected(batch, cutDecisions.data());
+    combine();
+  }
+  for (std::vector<AnalysisCompositeCut>::iterator it = fCompositeCutList.begin(); it < fCompositeCutList.end(); ++it) {
+    (*it).IsSelected(batch, cutDecisions.data());
+    combine();
+  }
+}
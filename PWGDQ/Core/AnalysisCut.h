@@ -18,7 +18,9 @@
 #define AnalysisCut_H
 
 #include <TF1.h>
+#include <cstdint>
 #include <vector>
+#include "PWGDQ/Core/ValuesBatch.h"
 
 //_________________________________________________________________________
 class AnalysisCut : public TNamed
@@ -39,6 +41,8 @@ class AnalysisCut : public TNamed
               int dependentVar2 = -1, float depCut2Low = 0., float depCut2High = 0., bool depCut2Exclude = false);
 
   virtual bool IsSelected(float* values);
+  // Apply the cuts on all the rows of a batch, reading the columns of the variables: decisions[i] is set to 1 if row i passes the cuts, to 0 otherwise
+  virtual void IsSelected(const ValuesBatch& batch, uint8_t* decisions);
 
   static std::vector<int> fgUsedVars; //! vector of used variables
 
@@ -174,4 +178,52 @@ inline bool AnalysisCut::IsSelected(float* values)
   return true;
 }
 
+//____________________________________________________________________________
+inline void AnalysisCut::IsSelected(const ValuesBatch& batch, uint8_t* decisions)
+{
+  //
+  // apply the configured cuts on a batch, one cut at a time over the columns of its variables
+  //
+  const int nRows = batch.GetNRows();
+  for (int i = 0; i < nRows; ++i) {
+    decisions[i] = 1;
+  }
+
+  // iterate over cuts
+  for (std::vector<CutContainer>::iterator it = fCuts.begin(); it != fCuts.end(); ++it) {
+    const float* var = batch.GetColumn((*it).fVar);
+    const float* depVar = ((*it).fDepVar != -1 ? batch.GetColumn((*it).fDepVar) : nullptr);
+    const float* depVar2 = ((*it).fDepVar2 != -1 ? batch.GetColumn((*it).fDepVar2) : nullptr);
+    if (!var || ((*it).fDepVar != -1 && !depVar) || ((*it).fDepVar2 != -1 && !depVar2)) {
+      // a variable of the cut is not stored in the batch, i.e. it is not among the used variables of the VarManager: nothing can pass
+      for (int i = 0; i < nRows; ++i) {
+        decisions[i] = 0;
+      }
+      return;
+    }
+
+    for (int i = 0; i < nRows; ++i) {
+      // the cut is applied only if the dependent variables are in the requested range (or outside, if excluded)
+      if (depVar) {
+        bool inRange = (depVar[i] > (*it).fDepLow && depVar[i] <= (*it).fDepHigh);
+        if (inRange == (*it).fDepExclude) {
+          continue;
+        }
+      }
+      if (depVar2) {
+        bool inRange = (depVar2[i] > (*it).fDep2Low && depVar2[i] <= (*it).fDep2High);
+        if (inRange == (*it).fDep2Exclude) {
+          continue;
+        }
+      }
+      float cutLow = ((*it).fFuncLow ? ((*it).fFuncLow)->Eval(depVar[i]) : (*it).fLow);
+      float cutHigh = ((*it).fFuncHigh ? ((*it).fFuncHigh)->Eval(depVar[i]) : (*it).fHigh);
+      bool inRange = (var[i] >= cutLow && var[i] <= cutHigh);
+      if (inRange == (*it).fExclude) {
+        decisions[i] = 0;
+      }
+    }
+  }
+}
+
 #endif
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <string_view>
 using namespace std;
 
 #include <TObject.h>
@@ -31,6 +32,143 @@ using namespace std;
 
 ClassImp(HistogramManager);
 
+namespace
+{
+// Type specific fill functions used in the fill plan of the HistogramManager
+// NOTE: At the moment, maximum 20 dimensions are foreseen for the THn histograms
+constexpr int kMaxTHnDimensions = 20;
+
+template <typename T>
+void fill1D(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]]);
+}
+template <typename T>
+void fill1DWeighted(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVarW]);
+}
+template <typename T>
+void fill2D(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]]);
+}
+template <typename T>
+void fill2DWeighted(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]], values[r.fVarW]);
+}
+template <typename T>
+void fill3D(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]], values[r.fVars[2]]);
+}
+template <typename T>
+void fill3DWeighted(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]], values[r.fVars[2]], values[r.fVarW]);
+}
+template <typename T>
+void fill4D(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]], values[r.fVars[2]], values[r.fVars[3]]);
+}
+template <typename T>
+void fill4DWeighted(const HistogramManager::FillRecord& r, const float* values)
+{
+  static_cast<T*>(r.fHist)->Fill(values[r.fVars[0]], values[r.fVars[1]], values[r.fVars[2]], values[r.fVars[3]], values[r.fVarW]);
+}
+void fillTHn(const HistogramManager::FillRecord& r, const float* values)
+{
+  double fillValues[kMaxTHnDimensions];
+  for (int i = 0; i < r.fNVars; i++) {
+    fillValues[i] = values[r.fVars[i]];
+  }
+  static_cast<THnBase*>(r.fHist)->Fill(fillValues);
+}
+void fillTHnWeighted(const HistogramManager::FillRecord& r, const float* values)
+{
+  double fillValues[kMaxTHnDimensions];
+  for (int i = 0; i < r.fNVars; i++) {
+    fillValues[i] = values[r.fVars[i]];
+  }
+  static_cast<THnBase*>(r.fHist)->Fill(fillValues, values[r.fVarW]);
+}
+
+// Fill functions reading the values of all the rows of a batch directly from the columns of the variables
+// NOTE: histograms with a variable which is not stored in the batch are not filled
+template <typename T, int nVars, bool isWeighted>
+void fillColumns(const HistogramManager::FillRecord& r, const ValuesBatch& batch, const uint8_t* selected)
+{
+  const float* x[nVars];
+  for (int j = 0; j < nVars; j++) {
+    x[j] = batch.GetColumn(r.fVars[j]);
+    if (!x[j]) {
+      return;
+    }
+  }
+  const float* w = (isWeighted ? batch.GetColumn(r.fVarW) : nullptr);
+  if (isWeighted && !w) {
+    return;
+  }
+  T* h = static_cast<T*>(r.fHist);
+  const int nRows = batch.GetNRows();
+  for (int i = 0; i < nRows; i++) {
+    if (selected && !selected[i]) {
+      continue;
+    }
+    if constexpr (nVars == 1 && !isWeighted) {
+      h->Fill(x[0][i]);
+    } else if constexpr (nVars == 1) {
+      h->Fill(x[0][i], w[i]);
+    } else if constexpr (nVars == 2 && !isWeighted) {
+      h->Fill(x[0][i], x[1][i]);
+    } else if constexpr (nVars == 2) {
+      h->Fill(x[0][i], x[1][i], w[i]);
+    } else if constexpr (nVars == 3 && !isWeighted) {
+      h->Fill(x[0][i], x[1][i], x[2][i]);
+    } else if constexpr (nVars == 3) {
+      h->Fill(x[0][i], x[1][i], x[2][i], w[i]);
+    } else if constexpr (!isWeighted) {
+      h->Fill(x[0][i], x[1][i], x[2][i], x[3][i]);
+    } else {
+      h->Fill(x[0][i], x[1][i], x[2][i], x[3][i], w[i]);
+    }
+  }
+}
+template <bool isWeighted>
+void fillTHnColumns(const HistogramManager::FillRecord& r, const ValuesBatch& batch, const uint8_t* selected)
+{
+  const float* x[kMaxTHnDimensions];
+  for (int j = 0; j < r.fNVars; j++) {
+    x[j] = batch.GetColumn(r.fVars[j]);
+    if (!x[j]) {
+      return;
+    }
+  }
+  const float* w = (isWeighted ? batch.GetColumn(r.fVarW) : nullptr);
+  if (isWeighted && !w) {
+    return;
+  }
+  THnBase* h = static_cast<THnBase*>(r.fHist);
+  double fillValues[kMaxTHnDimensions];
+  const int nRows = batch.GetNRows();
+  for (int i = 0; i < nRows; i++) {
+    if (selected && !selected[i]) {
+      continue;
+    }
+    for (int j = 0; j < r.fNVars; j++) {
+      fillValues[j] = x[j][i];
+    }
+    if constexpr (isWeighted) {
+      h->Fill(fillValues, w[i]);
+    } else {
+      h->Fill(fillValues);
+    }
+  }
+}
+} // namespace
+
 //_______________________________________________________________________________
 HistogramManager::HistogramManager() : TNamed("", ""),
                                        fMainList(nullptr),
@@ -40,7 +178,13 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fUseDefaultVariableNames(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
-                                       fVariableUnits(nullptr)
+                                       fVariableUnits(nullptr),
+                                       fHistClassHandles(),
+                                       fHistClassNames(),
+                                       fFillPlan(),
+                                       fFillPlanVars(),
+                                       fFillPlanRanges(),
+                                       fFillPlanReady(false)
 {
   //
   // Constructor
@@ -56,7 +200,13 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fUseDefaultVariableNames(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
-                                                                                              fVariableUnits()
+                                                                                              fVariableUnits(),
+                                                                                              fHistClassHandles(),
+                                                                                              fHistClassNames(),
+                                                                                              fFillPlan(),
+                                                                                              fFillPlanVars(),
+                                                                                              fFillPlanRanges(),
+                                                                                              fFillPlanReady(false)
 {
   //
   // Constructor
@@ -108,6 +258,9 @@ void HistogramManager::AddHistClass(const char* histClass)
   fMainList->Add(hList);
   std::list<std::vector<int>> varList;
   fVariablesMap[histClass] = varList;
+  fHistClassHandles[histClass] = static_cast<int>(fHistClassNames.size());
+  fHistClassNames.push_back(histClass);
+  fFillPlanReady = false;
   cout << "Adding histogram class " << histClass << endl;
   cout << "Variable map size :: " << fVariablesMap.size() << endl;
 }
@@ -182,6 +335,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanReady = false;
 
   // create and configure histograms according to required options
   TH1* h = nullptr;
@@ -381,6 +535,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanReady = false;
 
   TH1* h = nullptr;
   switch (dimension) {
@@ -549,6 +704,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanReady = false;
 
   unsigned long int nbins = 1;
   THnBase* h = nullptr;
@@ -628,6 +784,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanReady = false;
 
   // get the min and max for each axis
   double* xmin = new double[nDimensions];
@@ -678,130 +835,174 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
 }
 
 //__________________________________________________________________
-void HistogramManager::FillHistClass(const char* className, Float_t* values)
+int HistogramManager::GetHistClassHandle(const char* className) const
 {
   //
-  //  fill a class of histograms
+  // get the integer handle of a histogram class
   //
-
-  // get the needed histogram list
-  TList* hList = (TList*)fMainList->FindObject(className);
-  if (!hList) {
-    // TODO: add some meaningfull error message
-    /*cout << "Warning in HistogramManager::FillHistClass(): Histogram list " << className << " not found!" << endl;
-    cout << "         Histogram list not filled" << endl; */
-    return;
+  auto it = fHistClassHandles.find(std::string_view(className));
+  if (it == fHistClassHandles.end()) {
+    return kNothing;
   }
+  return it->second;
+}
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
-
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
-  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
-  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
-  double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = ((TH1*)h)->GetDimension();
-    }
+//__________________________________________________________________
+void HistogramManager::CompileFillPlan()
+{
+  //
+  // decode, for all the histogram classes, the information needed to fill each histogram
+  //   into a flat array of fill records, so that this is not redone at every fill
+  //
+  fFillPlan.clear();
+  fFillPlanVars.clear();
+  fFillPlanRanges.assign(fHistClassNames.size(), std::make_pair(0, 0));
+  std::vector<int> varsOffsets;
 
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
-      }
-    } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
+  for (size_t handle = 0; handle < fHistClassNames.size(); ++handle) {
+    const std::string& className = fHistClassNames[handle];
+    fFillPlanRanges[handle].first = fFillPlan.size();
+    TList* hList = (TList*)fMainList->FindObject(className.c_str());
+    if (!hList) {
+      fFillPlanRanges[handle].second = fFillPlan.size();
+      continue;
     }
 
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile*)h)->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              ((TProfile*)h)->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              ((TH1F*)h)->Fill(values[varX], values[varW]);
-            } else {
-              ((TH1F*)h)->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile2D*)h)->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              ((TProfile2D*)h)->Fill(values[varX], values[varY], values[varZ]);
-            }
-          } else {
-            if (varW > kNothing) {
-              ((TH2F*)h)->Fill(values[varX], values[varY], values[varW]);
+    // loop over the histogram and std::list
+    // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
+    const std::list<std::vector<int>>& varList = fVariablesMap[className];
+    TIter next(hList);
+    for (const auto& varVector : varList) {
+      TObject* h = next(); // get the histogram
+      bool isProfile = (varVector[0] == 1 ? true : false);
+      bool isTHn = (varVector[1] > 0 ? true : false);
+      int dimension = (isTHn ? varVector[1] : ((TH1*)h)->GetDimension());
+
+      FillRecord record;
+      record.fFill = nullptr;
+      record.fFillColumns = nullptr;
+      record.fHist = h;
+      record.fVars = nullptr;
+      record.fVarW = varVector[2];
+      bool isWeighted = (record.fVarW > kNothing);
+      if (isTHn) {
+        if (dimension > kMaxTHnDimensions) {
+          cout << "Warning in HistogramManager::CompileFillPlan(): Histogram " << h->GetName() << " has more than "
+               << kMaxTHnDimensions << " dimensions and will not be filled" << endl;
+          continue;
+        }
+        record.fNVars = dimension;
+        record.fFill = (isWeighted ? &fillTHnWeighted : &fillTHn);
+        record.fFillColumns = (isWeighted ? &fillTHnColumns<true> : &fillTHnColumns<false>);
+      } else {
+        // profiles have one more variable than the histogram dimension, which is the averaged one
+        record.fNVars = (isProfile ? dimension + 1 : dimension);
+        switch (dimension) {
+          case 1:
+            if (isProfile) {
+              record.fFill = (isWeighted ? &fill2DWeighted<TProfile> : &fill2D<TProfile>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TProfile, 2, true> : &fillColumns<TProfile, 2, false>);
             } else {
-              ((TH2F*)h)->Fill(values[varX], values[varY]);
+              record.fFill = (isWeighted ? &fill1DWeighted<TH1F> : &fill1D<TH1F>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TH1F, 1, true> : &fillColumns<TH1F, 1, false>);
             }
-          }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              ((TProfile3D*)h)->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
+            break;
+          case 2:
+            if (isProfile) {
+              record.fFill = (isWeighted ? &fill3DWeighted<TProfile2D> : &fill3D<TProfile2D>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TProfile2D, 3, true> : &fillColumns<TProfile2D, 3, false>);
             } else {
-              ((TProfile3D*)h)->Fill(values[varX], values[varY], values[varZ], values[varT]);
+              record.fFill = (isWeighted ? &fill2DWeighted<TH2F> : &fill2D<TH2F>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TH2F, 2, true> : &fillColumns<TH2F, 2, false>);
             }
-          } else {
-            if (varW > kNothing) {
-              ((TH3F*)h)->Fill(values[varX], values[varY], values[varZ], values[varW]);
+            break;
+          case 3:
+            if (isProfile) {
+              record.fFill = (isWeighted ? &fill4DWeighted<TProfile3D> : &fill4D<TProfile3D>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TProfile3D, 4, true> : &fillColumns<TProfile3D, 4, false>);
             } else {
-              ((TH3F*)h)->Fill(values[varX], values[varY], values[varZ]);
+              record.fFill = (isWeighted ? &fill3DWeighted<TH3F> : &fill3D<TH3F>);
+              record.fFillColumns = (isWeighted ? &fillColumns<TH3F, 3, true> : &fillColumns<TH3F, 3, false>);
             }
-          }
-          break;
-
-        default:
-          break;
-      } // end switch
-    }   // end if(!isTHn)
-    else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          ((THnSparseF*)h)->Fill(fillValues, values[varW]);
-        } else {
-          ((THnF*)h)->Fill(fillValues, values[varW]);
-        }
-      } else {
-        if (isSparse) {
-          ((THnSparseF*)h)->Fill(fillValues);
-        } else {
-          ((THnF*)h)->Fill(fillValues);
-        }
+            break;
+
+          default:
+            break;
+        } // end switch
+      }
+      if (!record.fFill) {
+        continue;
       }
-    } // end else
-  }   // end loop over histograms
+
+      // the variables on the axes follow the weight in the vector of indices
+      varsOffsets.push_back(fFillPlanVars.size());
+      fFillPlanVars.insert(fFillPlanVars.end(), varVector.begin() + 3, varVector.begin() + 3 + record.fNVars);
+      fFillPlan.push_back(record);
+    } // end loop over histograms
+    fFillPlanRanges[handle].second = fFillPlan.size();
+  }
+
+  // point the records to their variables only once the storage of the variables is final
+  for (size_t i = 0; i < fFillPlan.size(); ++i) {
+    fFillPlan[i].fVars = fFillPlanVars.data() + varsOffsets[i];
+  }
+  fFillPlanReady = true;
+}
+
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, Float_t* values)
+{
+  //
+  //  fill a class of histograms, using the fill plan
+  //
+  if (!fFillPlanReady) {
+    CompileFillPlan();
+  }
+  if (classHandle < 0 || classHandle >= static_cast<int>(fFillPlanRanges.size())) {
+    return;
+  }
+
+  const auto& range = fFillPlanRanges[classHandle];
+  const FillRecord* records = fFillPlan.data();
+  for (int i = range.first; i < range.second; ++i) {
+    records[i].fFill(records[i], values);
+  }
+}
+
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, const ValuesBatch& batch, const uint8_t* selected)
+{
+  //
+  //  fill a class of histograms for all the (selected) rows of a batch, reading the values from the columns of the batch
+  //
+  if (!fFillPlanReady) {
+    CompileFillPlan();
+  }
+  if (classHandle < 0 || classHandle >= static_cast<int>(fFillPlanRanges.size())) {
+    return;
+  }
+
+  const auto& range = fFillPlanRanges[classHandle];
+  const FillRecord* records = fFillPlan.data();
+  for (int i = range.first; i < range.second; ++i) {
+    records[i].fFillColumns(records[i], batch, selected);
+  }
+}
+
+//__________________________________________________________________
+void HistogramManager::FillHistClass(const char* className, Float_t* values)
+{
+  //
+  //  fill a class of histograms
+  //
+  int classHandle = GetHistClassHandle(className);
+  if (classHandle == kNothing) {
+    // TODO: add some meaningfull error message
+    /*cout << "Warning in HistogramManager::FillHistClass(): Histogram list " << className << " not found!" << endl;
+    cout << "         Histogram list not filled" << endl; */
+    return;
+  }
+  FillHistClass(classHandle, values);
 }
 
 //____________________________________________________________________________________
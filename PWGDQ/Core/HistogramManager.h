@@ -24,10 +24,15 @@
 #include <TAxis.h>
 #include <TArrayD.h>
 
+#include "PWGDQ/Core/ValuesBatch.h"
+
+#include <cstdint>
 #include <string>
+#include <functional>
 #include <map>
 #include <vector>
 #include <list>
+#include <utility>
 
 class HistogramManager : public TNamed
 {
@@ -41,12 +46,23 @@ class HistogramManager : public TNamed
     kNothing = -1
   };
 
+  // Pre-decoded information needed to fill one histogram
+  struct FillRecord {
+    void (*fFill)(const FillRecord& record, const float* values);                                      // fill function specific to the histogram type
+    void (*fFillColumns)(const FillRecord& record, const ValuesBatch& batch, const uint8_t* selected); // same, for all the (selected) rows of a batch
+    TObject* fHist;                                                                                    // histogram to be filled
+    const int* fVars;                                                                                  // indices of the variables on the histogram axes (points into fFillPlanVars)
+    int fNVars;                                                                                        // number of variables on the histogram axes
+    int fVarW;                                                                                         // index of the weight variable, kNothing if not weighted
+  };
+
   void SetMainHistogramList(THashList* list)
   {
     if (fMainList) {
       delete fMainList;
     }
     fMainList = list;
+    fFillPlanReady = false;
   }
 
   // Create a new histogram class
@@ -84,7 +100,16 @@ class HistogramManager : public TNamed
                     int nDimensions, int* vars, TArrayD* binLimits,
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE);
 
+  // Get the integer handle of a histogram class, to be resolved once at init and used with FillHistClass(int, float*)
+  // Returns kNothing if the class does not exist
+  int GetHistClassHandle(const char* className) const;
+  // Fill all the histograms in a class, using the handle obtained from GetHistClassHandle()
+  void FillHistClass(int classHandle, float* values);
+  // Fill all the histograms in a class, looking up the class by name
   void FillHistClass(const char* className, float* values);
+  // Fill all the histograms in a class once for each row of a batch, reading the values directly from the columns of the batch
+  // If specified, only the rows with a non-zero entry in the selected array are used (e.g. decisions from AnalysisCut::IsSelected())
+  void FillHistClass(int classHandle, const ValuesBatch& batch, const uint8_t* selected = nullptr);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; };
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -108,7 +133,15 @@ class HistogramManager : public TNamed
   TString* fVariableNames;          //! variable names
   TString* fVariableUnits;          //! variable units
 
+  std::map<std::string, int, std::less<>> fHistClassHandles; //! histogram class name -> handle
+  std::vector<std::string> fHistClassNames;                  //! histogram class names, indexed by handle
+  std::vector<FillRecord> fFillPlan;                         //! fill records of all histogram classes, grouped per class
+  std::vector<int> fFillPlanVars;                            //! variable indices used by the fill records
+  std::vector<std::pair<int, int>> fFillPlanRanges;          //! range [first, last) in fFillPlan for each histogram class handle
+  bool fFillPlanReady;                                       //! whether the fill plan is up to date with the defined histograms
+
   void MakeAxisLabels(TAxis* ax, const char* labels);
+  void CompileFillPlan();
 
   HistogramManager& operator=(const HistogramManager& c);
   HistogramManager(const HistogramManager& c);
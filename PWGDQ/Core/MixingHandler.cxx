@@ -26,7 +26,8 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fBinning()
 {
   //
   // default constructor
@@ -37,7 +38,8 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fBinning()
 {
   //
   // Named constructor
@@ -63,6 +65,7 @@ void MixingHandler::AddMixingVariable(int var, int nBins, float* binLims)
   varBins.Set(nBins, binLims);
   fVariableLimits.push_back(varBins);
   VarManager::SetUseVariable(var);
+  fBinning.addAxis(std::vector<float>(binLims, binLims + nBins));
 }
 
 //_________________________________________________________________________
@@ -111,11 +114,10 @@ void MixingHandler::Init()
   // Initialization of pools
   //       The correct event category will be retrieved using the function FindEventCategory()
   //
-  int size = 1;
-  for (auto v : fVariableLimits) {
-    size *= (v.GetSize() - 1);
+  fBinning.clear();
+  for (auto& v : fVariableLimits) {
+    fBinning.addAxis(std::vector<float>(v.GetArray(), v.GetArray() + v.GetSize()));
   }
-  (void)size;
   fIsInitialized = kTRUE;
 }
 
@@ -131,34 +133,8 @@ int MixingHandler::FindEventCategory(float* values)
   if (!fIsInitialized) {
     Init();
   }
-
-  std::vector<int> bin;
-  int iVar = 0;
-  for (auto v = fVariableLimits.begin(); v != fVariableLimits.end(); v++, iVar++) {
-    int binValue = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
-    bin.push_back(binValue);
-    if (bin[iVar] == -1 || bin[iVar] == (*v).GetSize() - 1) {
-      return -1; // all variables must be inside limits
-    }
-  }
-
-  int category = 0;
-  int tempCategory = 1;
-  int iv1 = 0;
-  int iv2 = 0;
-  for (auto v1 = fVariables.begin(); v1 != fVariables.end(); v1++, iv1++) {
-    tempCategory = 1;
-    iv2 = iv1;
-    for (auto v2 = v1; v2 != fVariables.end(); v2++, iv2++) {
-      if (iv2 == iv1) {
-        tempCategory *= bin[iv2];
-      } else {
-        tempCategory *= (fVariableLimits[iv2].GetSize() - 1);
-      }
-    }
-    category += tempCategory;
-  }
-  return category;
+  // all variables must be inside limits, otherwise -1
+  return fBinning.getCategory(values, fVariables.data());
 }
 
 //_________________________________________________________________________
@@ -180,11 +156,8 @@ int MixingHandler::GetBinFromCategory(VarManager::Variables var, int category) c
   }
 
   // extract the bin position in variable "var" from the category
-  int norm = 1;
-  for (int i = fVariables.size() - 1; i > tempVar; --i) {
-    norm *= (fVariableLimits[i].GetSize() - 1);
+  if (tempVar >= fBinning.getNAxes()) {
+    return -1;
   }
-  int truncatedCategory = category - (category % norm);
-  truncatedCategory /= norm;
-  return truncatedCategory % (fVariableLimits[tempVar].GetSize() - 1);
+  return fBinning.getBinFromCategory(tempVar, category);
 }
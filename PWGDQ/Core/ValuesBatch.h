@@ -0,0 +1,96 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Class holding the values of a set of variables (typically the used variables of the VarManager)
+//   for a batch of objects (e.g. the tracks of an event), in a structure-of-arrays layout:
+//   the values of each variable for all the objects are contiguous in memory (one column per variable)
+//
+
+#ifndef ValuesBatch_H
+#define ValuesBatch_H
+
+#include <algorithm>
+#include <vector>
+
+//_________________________________________________________________________
+class ValuesBatch
+{
+ public:
+  ValuesBatch() = default;
+
+  // Define the variables stored in the batch, out of the nVars variables which can be addressed
+  // The configuration tag allows the owner of the batch to detect when the variables must be redefined
+  // NOTE: this resets the batch content
+  void SetVariables(int nVars, const bool* usedVars, int configTag = 0)
+  {
+    fVariables.clear();
+    for (int var = 0; var < nVars; ++var) {
+      if (usedVars[var]) {
+        fVariables.push_back(var);
+      }
+    }
+    fColumnOfVar.assign(nVars, -1);
+    for (int col = 0; col < static_cast<int>(fVariables.size()); ++col) {
+      fColumnOfVar[fVariables[col]] = col;
+    }
+    fRowValues.assign(nVars, 0.0);
+    fConfigTag = configTag;
+    Reset(0);
+  }
+
+  // Set the number of objects (rows) in the batch, the content of the columns is undefined afterwards
+  void Reset(int nRows)
+  {
+    fNRows = nRows;
+    if (fData.size() < static_cast<size_t>(nRows) * fVariables.size()) {
+      fData.resize(static_cast<size_t>(nRows) * fVariables.size());
+    }
+  }
+
+  int GetNRows() const { return fNRows; }
+  int GetNVariables() const { return fColumnOfVar.size(); }
+  int GetConfigTag() const { return fConfigTag; }
+  const std::vector<int>& GetVariables() const { return fVariables; }
+  bool HasVariable(int var) const { return var >= 0 && var < static_cast<int>(fColumnOfVar.size()) && fColumnOfVar[var] >= 0; }
+
+  // Values of variable var for all the rows, nullptr if the variable is not stored in the batch
+  float* GetColumn(int var) { return HasVariable(var) ? fData.data() + static_cast<size_t>(fColumnOfVar[var]) * fNRows : nullptr; }
+  const float* GetColumn(int var) const { return HasVariable(var) ? fData.data() + static_cast<size_t>(fColumnOfVar[var]) * fNRows : nullptr; }
+
+  // Set the stored variables of all the rows from an array indexed by variable (e.g. the event variables, common to all the tracks)
+  void SetAllRows(const float* values)
+  {
+    for (int col = 0; col < static_cast<int>(fVariables.size()); ++col) {
+      float* data = fData.data() + static_cast<size_t>(col) * fNRows;
+      std::fill(data, data + fNRows, values[fVariables[col]]);
+    }
+  }
+  // Scatter the given variables from an array indexed by variable into a row
+  void SetRow(int row, const float* values, const std::vector<int>& vars)
+  {
+    for (auto var : vars) {
+      GetColumn(var)[row] = values[var];
+    }
+  }
+
+  // Array indexed by variable, used as scratch space when filling one row
+  float* GetRowValues() { return fRowValues.data(); }
+
+ private:
+  int fNRows = 0;                // number of rows
+  int fConfigTag = 0;            // tag of the configuration of the stored variables
+  std::vector<int> fVariables;   // stored variables, in column order
+  std::vector<int> fColumnOfVar; // column of each variable, -1 if not stored
+  std::vector<float> fData;      // values, column after column
+  std::vector<float> fRowValues; // scratch array indexed by variable
+};
+
+#endif
@@ -11,6 +11,7 @@
 
 #include "PWGDQ/Core/VarManager.h"
 
+#include <algorithm>
 #include <cmath>
 
 ClassImp(VarManager);
@@ -18,15 +19,72 @@ ClassImp(VarManager);
 TString VarManager::fgVariableNames[VarManager::kNVars] = {""};
 TString VarManager::fgVariableUnits[VarManager::kNVars] = {""};
 bool VarManager::fgUsedVars[VarManager::kNVars] = {false};
+int VarManager::fgUsedVarsVersion = 0;
 float VarManager::fgValues[VarManager::kNVars] = {0.0f};
 std::map<int, int> VarManager::fgRunMap;
 TString VarManager::fgRunStr = "";
-o2::vertexing::DCAFitterN<2> VarManager::fgFitterTwoProngBarrel;
-o2::vertexing::DCAFitterN<3> VarManager::fgFitterThreeProngBarrel;
-o2::vertexing::FwdDCAFitterN<2> VarManager::fgFitterTwoProngFwd;
-o2::vertexing::FwdDCAFitterN<3> VarManager::fgFitterThreeProngFwd;
-std::map<VarManager::CalibObjects, TObject*> VarManager::fgCalibs;
-bool VarManager::fgRunTPCPostCalibration[4] = {false, false, false, false};
+VarManager::Context VarManager::fgDefaultContext(VarManager::fgValues);
+
+//__________________________________________________________________
+VarManager::Context::Context() : fValues(nullptr),
+                                 fValuesStorage(VarManager::kNVars, 0.0f),
+                                 fCalibs(),
+                                 fRunTPCPostCalibration{false, false, false, false}
+{
+  //
+  // constructor, with own values array
+  //
+  fValues = fValuesStorage.data();
+}
+
+//__________________________________________________________________
+VarManager::Context::Context(float* values) : fValues(values),
+                                              fValuesStorage(),
+                                              fCalibs(),
+                                              fRunTPCPostCalibration{false, false, false, false}
+{
+  //
+  // constructor, writing into an external values array
+  //
+}
+
+//__________________________________________________________________
+VarManager::Context::Context(const Context& other) : fValues(nullptr),
+                                                     fValuesStorage(other.fValues, other.fValues + VarManager::kNVars),
+                                                     fFitterTwoProngBarrel(other.fFitterTwoProngBarrel),
+                                                     fFitterThreeProngBarrel(other.fFitterThreeProngBarrel),
+                                                     fFitterTwoProngFwd(other.fFitterTwoProngFwd),
+                                                     fFitterThreeProngFwd(other.fFitterThreeProngFwd),
+                                                     fCalibs(other.fCalibs)
+{
+  //
+  // copy constructor: the configuration is copied, but the values are always kept in an own array
+  //
+  fValues = fValuesStorage.data();
+  for (int i = 0; i < 4; ++i) {
+    fRunTPCPostCalibration[i] = other.fRunTPCPostCalibration[i];
+  }
+}
+
+//__________________________________________________________________
+VarManager::Context& VarManager::Context::operator=(const Context& other)
+{
+  //
+  // assignment: the configuration and values are copied, the values array of this context is kept
+  //
+  if (this != &other) {
+    std::copy(other.fValues, other.fValues + VarManager::kNVars, fValues);
+    fFitterTwoProngBarrel = other.fFitterTwoProngBarrel;
+    fFitterThreeProngBarrel = other.fFitterThreeProngBarrel;
+    fFitterTwoProngFwd = other.fFitterTwoProngFwd;
+    fFitterThreeProngFwd = other.fFitterThreeProngFwd;
+    fCalibs = other.fCalibs;
+    for (int i = 0; i < 4; ++i) {
+      fRunTPCPostCalibration[i] = other.fRunTPCPostCalibration[i];
+    }
+  }
+  return *this;
+}
 
 //__________________________________________________________________
 VarManager::VarManager() : TObject()
@@ -59,7 +117,7 @@ void VarManager::ResetValues(int startValue, int endValue, float* values)
   // reset all variables to an "innocent" value
   // NOTE: here we use -9999.0 as a neutral value, but depending on situation, this may not be the case
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
   for (Int_t i = startValue; i < endValue; ++i) {
     values[i] = -9999.;
@@ -113,6 +171,25 @@ void VarManager::FillTrackDerived(float* values)
   }
 }
 
+//__________________________________________________________________
+void VarManager::FillTrackDerivedBatch(ValuesBatch& batch)
+{
+  //
+  // Fill track-wise derived quantities for all the rows of a batch, from the columns already filled in FillTrackBatch()
+  //
+  if (fgUsedVars[kP]) {
+    float* p = batch.GetColumn(kP);
+    const float* pt = batch.GetColumn(kPt);
+    const float* eta = batch.GetColumn(kEta);
+    if (!pt || !eta) { // pt and eta are not used, e.g. if the used variables were set without their dependencies
+      return;
+    }
+    for (int i = 0; i < batch.GetNRows(); ++i) {
+      p[i] = pt[i] * std::cosh(eta[i]);
+    }
+  }
+}
+
 //_________________________________________________________________________________________________________________________________________________________________________________
 float VarManager::GetTPCPostCalibMap(float pin, float eta, int particle_type, TString period)
 {
@@ -43,6 +43,8 @@
 #include "DetectorsVertexing/FwdDCAFitterN.h"
 #include "CommonConstants/PhysicsConstants.h"
 
+#include "PWGDQ/Core/ValuesBatch.h"
+
 using std::cout;
 using std::endl;
 using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
@@ -355,6 +357,7 @@ class VarManager : public TObject
       fgUsedVars[var] = kTRUE;
     }
     SetVariableDependencies();
+    fgUsedVarsVersion++;
   }
   static void SetUseVars(const bool* usedVars)
   {
@@ -364,12 +367,14 @@ class VarManager : public TObject
       }
     }
     SetVariableDependencies();
+    fgUsedVarsVersion++;
   }
   static void SetUseVars(const std::vector<int> usedVars)
   {
     for (auto& var : usedVars) {
       fgUsedVars[var] = true;
     }
+    fgUsedVarsVersion++;
   }
   static bool GetUsedVar(int var)
   {
@@ -393,24 +398,26 @@ class VarManager : public TObject
   // Setup the 2 prong DCAFitterN
   static void SetupTwoProngDCAFitter(float magField, bool propagateToPCA, float maxR, float maxDZIni, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngBarrel.setBz(magField);
-    fgFitterTwoProngBarrel.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngBarrel.setMaxR(maxR);
-    fgFitterTwoProngBarrel.setMaxDZIni(maxDZIni);
-    fgFitterTwoProngBarrel.setMinParamChange(minParamChange);
-    fgFitterTwoProngBarrel.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngBarrel.setUseAbsDCA(useAbsDCA);
+    auto& fitter = GetContext().fFitterTwoProngBarrel;
+    fitter.setBz(magField);
+    fitter.setPropagateToPCA(propagateToPCA);
+    fitter.setMaxR(maxR);
+    fitter.setMaxDZIni(maxDZIni);
+    fitter.setMinParamChange(minParamChange);
+    fitter.setMinRelChi2Change(minRelChi2Change);
+    fitter.setUseAbsDCA(useAbsDCA);
   }
 
   // Setup the 2 prong FwdDCAFitterN
   static void SetupTwoProngFwdDCAFitter(float magField, bool propagateToPCA, float maxR, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngFwd.setBz(magField);
-    fgFitterTwoProngFwd.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngFwd.setMaxR(maxR);
-    fgFitterTwoProngFwd.setMinParamChange(minParamChange);
-    fgFitterTwoProngFwd.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngFwd.setUseAbsDCA(useAbsDCA);
+    auto& fitter = GetContext().fFitterTwoProngFwd;
+    fitter.setBz(magField);
+    fitter.setPropagateToPCA(propagateToPCA);
+    fitter.setMaxR(maxR);
+    fitter.setMinParamChange(minParamChange);
+    fitter.setMinRelChi2Change(minRelChi2Change);
+    fitter.setUseAbsDCA(useAbsDCA);
   }
   static auto getEventPlane(int harm, float qnxa, float qnya)
   {
@@ -440,31 +447,69 @@ class VarManager : public TObject
   static void FillQVectorFromGFW(C const& collision, A const& compA2, A const& compB2, A const& compC2, A const& compA3, A const& compB3, A const& compC3, float normA = 1.0, float normB = 1.0, float normC = 1.0, float* values = nullptr);
   template <int pairType, typename T1, typename T2>
   static void FillPairVn(T1 const& t1, T2 const& t2, float* values = nullptr);
+  // Batched version of FillTrack(): the used variables are computed for all the tracks of a table and stored in the batch,
+  //   one row per track and one column per used variable. The columns of the variables not computed for tracks (e.g. event variables)
+  //   are filled for all the rows from the values array (by default the one of the current context, e.g. after FillEvent())
+  template <uint32_t fillMap, typename T>
+  static void FillTrackBatch(T const& tracks, ValuesBatch& batch, float* values = nullptr);
 
   static void SetCalibrationObject(CalibObjects calib, TObject* obj)
   {
-    fgCalibs[calib] = obj;
+    auto& calibs = GetContext().fCalibs;
+    calibs[calib] = obj;
     // Check whether all the needed objects for TPC postcalibration are available
-    if (fgCalibs.find(kTPCElectronMean) != fgCalibs.end() && fgCalibs.find(kTPCElectronSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[0] = true;
+    if (calibs.find(kTPCElectronMean) != calibs.end() && calibs.find(kTPCElectronSigma) != calibs.end()) {
+      GetContext().fRunTPCPostCalibration[0] = true;
     }
-    if (fgCalibs.find(kTPCPionMean) != fgCalibs.end() && fgCalibs.find(kTPCPionSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[1] = true;
+    if (calibs.find(kTPCPionMean) != calibs.end() && calibs.find(kTPCPionSigma) != calibs.end()) {
+      GetContext().fRunTPCPostCalibration[1] = true;
     }
-    if (fgCalibs.find(kTPCProtonMean) != fgCalibs.end() && fgCalibs.find(kTPCProtonSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[3] = true;
+    if (calibs.find(kTPCProtonMean) != calibs.end() && calibs.find(kTPCProtonSigma) != calibs.end()) {
+      GetContext().fRunTPCPostCalibration[3] = true;
     }
   }
   static TObject* GetCalibrationObject(CalibObjects calib)
   {
-    auto obj = fgCalibs.find(calib);
-    if (obj == fgCalibs.end()) {
+    auto& calibs = GetContext().fCalibs;
+    auto obj = calibs.find(calib);
+    if (obj == calibs.end()) {
       return 0x0;
     } else {
       return obj->second;
     }
   }
 
+  // State used while computing the variables: the values array, the DCA fitters and the calibration objects
+  // The static API uses a default context, which writes into fgValues. Each thread can switch to its own context with
+  //   SetThreadContext() (e.g. to split a pair loop across threads), typically copied from the default one once it is configured.
+  // NOTE: the used variables flags (fgUsedVars) are configuration shared by all the contexts and should not be changed while filling
+  struct Context {
+    Context();
+    explicit Context(float* values);
+    Context(const Context& other); // copies the fitters and calibrations, while using its own values array
+    Context& operator=(const Context& other);
+
+    float* fValues;                    // array holding all variables, either fValuesStorage or external
+    std::vector<float> fValuesStorage; // own storage of the values
+
+    o2::vertexing::DCAFitterN<2> fFitterTwoProngBarrel;
+    o2::vertexing::DCAFitterN<3> fFitterThreeProngBarrel;
+    o2::vertexing::FwdDCAFitterN<2> fFitterTwoProngFwd;
+    o2::vertexing::FwdDCAFitterN<3> fFitterThreeProngFwd;
+
+    std::map<CalibObjects, TObject*> fCalibs; // map of calibration histograms
+    bool fRunTPCPostCalibration[4];           // 0-electron, 1-pion, 2-kaon, 3-proton
+  };
+  // Context used by the calling thread (the default context, unless set otherwise with SetThreadContext())
+  // NOTE: inline, as it is called by all the Fill functions
+  static Context& GetContext()
+  {
+    Context* context = ThreadContext();
+    return context ? *context : fgDefaultContext;
+  }
+  // Set the context used by the calling thread; nullptr restores the default context
+  static void SetThreadContext(Context* context) { ThreadContext() = context; }
+
  public:
   VarManager();
   ~VarManager() override;
@@ -474,8 +519,30 @@ class VarManager : public TObject
 
  private:
   static bool fgUsedVars[kNVars];        // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
+  static int fgUsedVarsVersion;          // incremented at each change of the used variables, to recompile what depends on them
   static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
 
+  // Kernel computing one variable for all the tracks of a table, into the column of the variable
+  template <typename T>
+  using TrackKernel = void (*)(T const& tracks, float* column);
+  // Kernels of the used track variables, for a fill map and a table type
+  template <typename T>
+  struct TrackKernels {
+    int fVersion = -1;                                    // version of the used variables the kernels are compiled for
+    std::vector<std::pair<int, TrackKernel<T>>> fKernels; // (variable, kernel) of the used variables with a kernel
+    std::vector<int> fRowVars;                            // used variables without kernel, computed row by row with FillTrack()
+  };
+  template <uint32_t fillMap, typename T>
+  static void CompileTrackKernels(TrackKernels<T>& kernels);
+  template <typename T, typename F>
+  static void FillColumn(T const& tracks, float* column, F const& value)
+  {
+    for (auto const& track : tracks) {
+      *(column++) = value(track);
+    }
+  }
+  static void FillTrackDerivedBatch(ValuesBatch& batch);
+
   static std::map<int, int> fgRunMap; // map of runs to be used in histogram axes
   static TString fgRunStr;            // semi-colon separated list of runs, to be used for histogram axis labels
 
@@ -486,13 +553,13 @@ class VarManager : public TObject
   template <typename T, typename U, typename V>
   static auto getRotatedCovMatrixXX(const T& matrix, U phi, V theta);
 
-  static o2::vertexing::DCAFitterN<2> fgFitterTwoProngBarrel;
-  static o2::vertexing::DCAFitterN<3> fgFitterThreeProngBarrel;
-  static o2::vertexing::FwdDCAFitterN<2> fgFitterTwoProngFwd;
-  static o2::vertexing::FwdDCAFitterN<3> fgFitterThreeProngFwd;
-
-  static std::map<CalibObjects, TObject*> fgCalibs; // map of calibration histograms
-  static bool fgRunTPCPostCalibration[4];           // 0-electron, 1-pion, 2-kaon, 3-proton
+  static Context fgDefaultContext; // context used by the static API, unless a thread sets its own
+  // Context set by the calling thread, if any (constant-initialised, so that no guard is needed)
+  static Context*& ThreadContext()
+  {
+    static thread_local Context* context = nullptr;
+    return context;
+  }
 
   VarManager& operator=(const VarManager& c);
   VarManager(const VarManager& c);
@@ -519,7 +586,7 @@ template <uint32_t fillMap, typename T>
 void VarManager::FillEvent(T const& event, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   if constexpr ((fillMap & CollisionTimestamp) > 0) {
@@ -695,7 +762,7 @@ template <uint32_t fillMap, typename T>
 void VarManager::FillTrack(T const& track, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   // Quantities based on the basic table (contains just kine information and filter bits)
@@ -862,9 +929,9 @@ void VarManager::FillTrack(T const& track, float* values)
     }
 
     // compute TPC postcalibrated electron nsigma based on calibration histograms from CCDB
-    if (fgUsedVars[kTPCnSigmaEl_Corr] && fgRunTPCPostCalibration[0]) {
-      TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCElectronMean]);
-      TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCElectronSigma]);
+    if (fgUsedVars[kTPCnSigmaEl_Corr] && GetContext().fRunTPCPostCalibration[0]) {
+      TH3F* calibMean = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCElectronMean]);
+      TH3F* calibSigma = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCElectronSigma]);
 
       int binTPCncls = calibMean->GetXaxis()->FindBin(values[kTPCncls]);
       binTPCncls = (binTPCncls == 0 ? 1 : binTPCncls);
@@ -881,9 +948,9 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTPCnSigmaEl_Corr] = (values[kTPCnSigmaEl] - mean) / width;
     }
     // compute TPC postcalibrated pion nsigma if required
-    if (fgUsedVars[kTPCnSigmaPi_Corr] && fgRunTPCPostCalibration[1]) {
-      TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCPionMean]);
-      TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCPionSigma]);
+    if (fgUsedVars[kTPCnSigmaPi_Corr] && GetContext().fRunTPCPostCalibration[1]) {
+      TH3F* calibMean = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCPionMean]);
+      TH3F* calibSigma = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCPionSigma]);
 
       int binTPCncls = calibMean->GetXaxis()->FindBin(values[kTPCncls]);
       binTPCncls = (binTPCncls == 0 ? 1 : binTPCncls);
@@ -900,9 +967,9 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTPCnSigmaPi_Corr] = (values[kTPCnSigmaPi] - mean) / width;
     }
     // compute TPC postcalibrated proton nsigma if required
-    if (fgUsedVars[kTPCnSigmaPr_Corr] && fgRunTPCPostCalibration[3]) {
-      TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCProtonMean]);
-      TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCProtonSigma]);
+    if (fgUsedVars[kTPCnSigmaPr_Corr] && GetContext().fRunTPCPostCalibration[3]) {
+      TH3F* calibMean = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCProtonMean]);
+      TH3F* calibSigma = reinterpret_cast<TH3F*>(GetContext().fCalibs[kTPCProtonSigma]);
 
       int binTPCncls = calibMean->GetXaxis()->FindBin(values[kTPCncls]);
       binTPCncls = (binTPCncls == 0 ? 1 : binTPCncls);
@@ -975,11 +1042,239 @@ void VarManager::FillTrack(T const& track, float* values)
   FillTrackDerived(values);
 }
 
+template <uint32_t fillMap, typename T>
+void VarManager::CompileTrackKernels(TrackKernels<T>& kernels)
+{
+  //
+  // Compile the list of kernels of the used track variables, following the same fill map conditions as FillTrack()
+  // NOTE: a variable set in several places of FillTrack() takes the last definition, as in FillTrack()
+  //
+  std::vector<TrackKernel<T>> kernelOfVar(kNVars, nullptr);
+  std::vector<bool> isRowVar(kNVars, false);
+  auto setKernel = [&](int var, TrackKernel<T> kernel) {
+    kernelOfVar[var] = kernel;
+    isRowVar[var] = false;
+  };
+  auto setRowVar = [&](int var) {
+    kernelOfVar[var] = nullptr;
+    isRowVar[var] = true;
+  };
+
+  // Quantities based on the basic table (contains just kine information and filter bits)
+  if constexpr ((fillMap & Track) > 0 || (fillMap & Muon) > 0 || (fillMap & ReducedTrack) > 0 || (fillMap & ReducedMuon) > 0) {
+    setKernel(kPt, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.pt(); }); });
+    setKernel(kPx, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.px(); }); });
+    setKernel(kPy, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.py(); }); });
+    setKernel(kPz, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.pz(); }); });
+    setKernel(kEta, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.eta(); }); });
+    setKernel(kPhi, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.phi(); }); });
+    setKernel(kCharge, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.sign(); }); });
+
+    if constexpr ((fillMap & ReducedTrack) > 0 && !((fillMap & Pair) > 0)) {
+      setKernel(kIsGlobalTrack, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.filteringFlags() & (uint64_t(1) << 0); }); });
+      setKernel(kIsGlobalTrackSDD, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.filteringFlags() & (uint64_t(1) << 1); }); });
+      setKernel(kIsLegFromGamma, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return static_cast<bool>(track.filteringFlags() & (uint64_t(1) << 2)); }); });
+      setKernel(kIsLegFromK0S, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return static_cast<bool>(track.filteringFlags() & (uint64_t(1) << 3)); }); });
+      setKernel(kIsLegFromLambda, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return static_cast<bool>(track.filteringFlags() & (uint64_t(1) << 4)); }); });
+      setKernel(kIsLegFromAntiLambda, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return static_cast<bool>(track.filteringFlags() & (uint64_t(1) << 5)); }); });
+      setKernel(kIsLegFromOmega, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return static_cast<bool>(track.filteringFlags() & (uint64_t(1) << 6)); }); });
+      setKernel(kIsProtonFromLambdaAndAntiLambda, [](T const& tracks, float* column) {
+        FillColumn(tracks, column, [](auto const& track) {
+          bool isLegFromLambda = track.filteringFlags() & (uint64_t(1) << 4);
+          bool isLegFromAntiLambda = track.filteringFlags() & (uint64_t(1) << 5);
+          return static_cast<bool>((isLegFromLambda * track.sign() > 0) || (isLegFromAntiLambda * (-track.sign()) > 0));
+        });
+      });
+      for (int i = 0; i < 8; i++) {
+        setRowVar(kIsDalitzLeg + i);
+      }
+    }
+  }
+
+  // Quantities based on the barrel tables
+  if constexpr ((fillMap & TrackExtra) > 0 || (fillMap & ReducedTrackBarrel) > 0) {
+    setKernel(kPin, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcInnerParam(); }); });
+    setKernel(kIsITSrefit, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::ITSrefit) > 0; }); });
+    setKernel(kTrackTimeResIsRange, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; }); });
+    setKernel(kIsTPCrefit, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::TPCrefit) > 0; }); });
+    setKernel(kPVContributor, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::PVContributor) > 0; }); });
+    setKernel(kIsGoldenChi2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::GoldenChi2) > 0; }); });
+    setKernel(kOrphanTrack, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.flags() & o2::aod::track::OrphanTrack) > 0; }); });
+    setKernel(kIsSPDfirst, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.itsClusterMap() & uint8_t(1)) > 0; }); });
+    setKernel(kIsSPDboth, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.itsClusterMap() & uint8_t(3)) > 0; }); });
+    setKernel(kIsSPDany, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2)); }); });
+    setKernel(kITSClusterMap, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.itsClusterMap(); }); });
+    setKernel(kITSchi2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.itsChi2NCl(); }); });
+    setKernel(kTPCncls, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNClsFound(); }); });
+    setKernel(kTPCchi2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcChi2NCl(); }); });
+    setKernel(kTrackLength, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.length(); }); });
+    setKernel(kTPCnclsCR, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNClsCrossedRows(); }); });
+    setKernel(kTRDPattern, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.trdPattern(); }); });
+
+    if constexpr ((fillMap & TrackExtra) > 0) {
+      setKernel(kITSncls, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.itsNCls(); }); });
+    }
+    if constexpr ((fillMap & ReducedTrackBarrel) > 0) {
+      setKernel(kITSncls, [](T const& tracks, float* column) {
+        FillColumn(tracks, column, [](auto const& track) {
+          float nITS = 0.0;
+          for (int i = 0; i < 7; ++i) {
+            nITS += ((track.itsClusterMap() & (1 << i)) ? 1 : 0);
+          }
+          return nITS;
+        });
+      });
+      setKernel(kTrackDCAxy, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaXY(); }); });
+      setKernel(kTrackDCAz, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaZ(); }); });
+      if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
+        setKernel(kTrackDCAsigXY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaXY() / std::sqrt(track.cYY()); }); });
+        setKernel(kTrackDCAsigZ, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaZ() / std::sqrt(track.cZZ()); }); });
+        setKernel(kTrackDCAresXY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return std::sqrt(track.cYY()); }); });
+        setKernel(kTrackDCAresZ, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return std::sqrt(track.cZZ()); }); });
+      }
+    }
+  }
+
+  // Quantities based on the barrel track selection table
+  if constexpr ((fillMap & TrackDCA) > 0) {
+    setKernel(kTrackDCAxy, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaXY(); }); });
+    setKernel(kTrackDCAz, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaZ(); }); });
+    if constexpr ((fillMap & TrackCov) > 0) {
+      setKernel(kTrackDCAsigXY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaXY() / std::sqrt(track.cYY()); }); });
+      setKernel(kTrackDCAsigZ, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.dcaZ() / std::sqrt(track.cZZ()); }); });
+      setKernel(kTrackDCAresXY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return std::sqrt(track.cYY()); }); });
+      setKernel(kTrackDCAresZ, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return std::sqrt(track.cZZ()); }); });
+    }
+  }
+
+  // Quantities based on the barrel track selection table
+  if constexpr ((fillMap & TrackSelection) > 0) {
+    setKernel(kIsGlobalTrack, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.isGlobalTrack(); }); });
+    setKernel(kIsGlobalTrackSDD, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.isGlobalTrackSDD(); }); });
+  }
+
+  // Quantities based on the barrel covariance tables
+  if constexpr ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0) {
+    setKernel(kTrackCYY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cYY(); }); });
+    setKernel(kTrackCZZ, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cZZ(); }); });
+    setKernel(kTrackCSnpSnp, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cSnpSnp(); }); });
+    setKernel(kTrackCTglTgl, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cTglTgl(); }); });
+    setKernel(kTrackC1Pt21Pt2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.c1Pt21Pt2(); }); });
+  }
+
+  // Quantities based on the dalitz selections
+  if constexpr ((fillMap & DalitzBits) > 0) {
+    for (int i = 0; i < 8; i++) {
+      setRowVar(kIsDalitzLeg + i);
+    }
+  }
+
+  // Quantities based on the barrel PID tables
+  if constexpr ((fillMap & TrackPID) > 0 || (fillMap & ReducedTrackBarrelPID) > 0) {
+    setKernel(kTPCnSigmaEl, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNSigmaEl(); }); });
+    setKernel(kTPCnSigmaMu, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNSigmaMu(); }); });
+    setKernel(kTPCnSigmaPi, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNSigmaPi(); }); });
+    setKernel(kTPCnSigmaKa, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNSigmaKa(); }); });
+    setKernel(kTPCnSigmaPr, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcNSigmaPr(); }); });
+    // the post-calibrated and randomized n-sigmas depend on the calibration objects and on several other variables
+    for (int var : {kTPCnSigmaEl_Corr, kTPCnSigmaPi_Corr, kTPCnSigmaPr_Corr,
+                    kTPCsignalRandomized, kTPCsignalRandomizedDelta, kTPCnSigmaElRandomized, kTPCnSigmaElRandomizedDelta,
+                    kTPCnSigmaPiRandomized, kTPCnSigmaPiRandomizedDelta, kTPCnSigmaPrRandomized, kTPCnSigmaPrRandomizedDelta}) {
+      setRowVar(var);
+    }
+    setKernel(kTOFnSigmaEl, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tofNSigmaEl(); }); });
+    setKernel(kTOFnSigmaMu, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tofNSigmaMu(); }); });
+    setKernel(kTOFnSigmaPi, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tofNSigmaPi(); }); });
+    setKernel(kTOFnSigmaKa, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tofNSigmaKa(); }); });
+    setKernel(kTOFnSigmaPr, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tofNSigmaPr(); }); });
+    setKernel(kTPCsignal, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.tpcSignal(); }); });
+    setKernel(kTRDsignal, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.trdSignal(); }); });
+    setKernel(kTOFbeta, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.beta(); }); });
+  }
+
+  // Quantities based on the muon extra table
+  if constexpr ((fillMap & ReducedMuonExtra) > 0 || (fillMap & Muon) > 0) {
+    setKernel(kMuonNClusters, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.nClusters(); }); });
+    setKernel(kMuonPDca, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.pDca(); }); });
+    setKernel(kMCHBitMap, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.mchBitMap(); }); });
+    setKernel(kMuonRAtAbsorberEnd, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.rAtAbsorberEnd(); }); });
+    setKernel(kMuonChi2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.chi2(); }); });
+    setKernel(kMuonChi2MatchMCHMID, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.chi2MatchMCHMID(); }); });
+    setKernel(kMuonChi2MatchMCHMFT, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.chi2MatchMCHMFT(); }); });
+    setKernel(kMuonMatchScoreMCHMFT, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.matchScoreMCHMFT(); }); });
+    setKernel(kMuonTrackType, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.trackType(); }); });
+    setKernel(kMuonDCAx, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.fwdDcaX(); }); });
+    setKernel(kMuonDCAy, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.fwdDcaY(); }); });
+  }
+  // Quantities based on the muon covariance table
+  if constexpr ((fillMap & ReducedMuonCov) > 0 || (fillMap & MuonCov) > 0) {
+    setKernel(kMuonCXX, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cXX(); }); });
+    setKernel(kMuonCYY, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cYY(); }); });
+    setKernel(kMuonCPhiPhi, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cPhiPhi(); }); });
+    setKernel(kMuonCTglTgl, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.cTglTgl(); }); });
+    setKernel(kMuonC1Pt21Pt2, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.c1Pt21Pt2(); }); });
+  }
+
+  // Quantities based on the pair table(s)
+  if constexpr ((fillMap & Pair) > 0) {
+    setKernel(kMass, [](T const& tracks, float* column) { FillColumn(tracks, column, [](auto const& track) { return track.mass(); }); });
+  }
+
+  // keep only the used variables
+  kernels.fKernels.clear();
+  kernels.fRowVars.clear();
+  for (int var = 0; var < kNVars; ++var) {
+    if (!fgUsedVars[var]) {
+      continue;
+    }
+    if (kernelOfVar[var]) {
+      kernels.fKernels.emplace_back(var, kernelOfVar[var]);
+    } else if (isRowVar[var]) {
+      kernels.fRowVars.push_back(var);
+    }
+  }
+  kernels.fVersion = fgUsedVarsVersion;
+}
+
+template <uint32_t fillMap, typename T>
+void VarManager::FillTrackBatch(T const& tracks, ValuesBatch& batch, float* values)
+{
+  if (!values) {
+    values = GetContext().fValues;
+  }
+  // the kernels are compiled once for each fill map and table type, and again only if the used variables change
+  static thread_local TrackKernels<T> kernels;
+  if (kernels.fVersion != fgUsedVarsVersion) {
+    CompileTrackKernels<fillMap>(kernels);
+  }
+  if (batch.GetNVariables() != kNVars || batch.GetConfigTag() != fgUsedVarsVersion) {
+    batch.SetVariables(kNVars, fgUsedVars, fgUsedVarsVersion);
+  }
+
+  batch.Reset(tracks.size());
+  batch.SetAllRows(values);
+  for (auto const& [var, kernel] : kernels.fKernels) {
+    kernel(tracks, batch.GetColumn(var));
+  }
+  FillTrackDerivedBatch(batch);
+
+  // variables without kernel, only if used
+  if (!kernels.fRowVars.empty()) {
+    float* rowValues = batch.GetRowValues();
+    std::copy(values, values + kNVars, rowValues);
+    int row = 0;
+    for (auto const& track : tracks) {
+      FillTrack<fillMap>(track, rowValues);
+      batch.SetRow(row++, rowValues, kernels.fRowVars);
+    }
+  }
+}
+
 template <typename U, typename T>
 void VarManager::FillTrackMC(const U& mcStack, T const& track, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   // Quantities based on the mc particle table
@@ -1009,7 +1304,7 @@ template <int pairType, uint32_t fillMap, typename T1, typename T2>
 void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   float m1 = MassElectron;
@@ -1068,7 +1363,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     // u = v12 / |v12|            , the unit vector of v12
     // v = v1 x v2 / |v1 x v2|    , unit vector perpendicular to v1 and v2
 
-    float bz = fgFitterTwoProngBarrel.getBz();
+    float bz = GetContext().fFitterTwoProngBarrel.getBz();
 
     // momentum of e+ and e- in (ax,ay,az) axis. Note that az=0 by definition.
     // vector product of pep X pem
@@ -1127,7 +1422,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
   // Lightweight fill function called from the innermost event mixing loop
   //
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   float m1 = MassElectron;
@@ -1155,7 +1450,7 @@ template <typename T1, typename T2>
 void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values, PairCandidateType pairType)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   float m1 = MassElectron;
@@ -1189,7 +1484,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
 
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   int procCode = 0;
@@ -1209,7 +1504,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                     t2.cSnpSnp(), t2.cTglY(), t2.cTglZ(), t2.cTglSnp(), t2.cTglTgl(),
                                     t2.c1PtY(), t2.c1PtZ(), t2.c1PtSnp(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
     o2::track::TrackParCov pars2{t2.x(), t2.alpha(), t2pars, t2covs};
-    procCode = fgFitterTwoProngBarrel.process(pars1, pars2);
+    procCode = GetContext().fFitterTwoProngBarrel.process(pars1, pars2);
   } else if constexpr ((pairType == kDecayToMuMu) && muonHasCov) {
     // Initialize track parameters for forward
     double chi21 = t1.chi2();
@@ -1226,7 +1521,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                            t2.c1PtX(), t2.c1PtY(), t2.c1PtPhi(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
     SMatrix55 t2covs(v2.begin(), v2.end());
     o2::track::TrackParCovFwd pars2{t2.z(), t2pars, t2covs, chi22};
-    procCode = fgFitterTwoProngFwd.process(pars1, pars2);
+    procCode = GetContext().fFitterTwoProngFwd.process(pars1, pars2);
   } else {
     return;
   }
@@ -1269,12 +1564,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
     auto covMatrixPV = primaryVertex.getCov();
 
     if constexpr (pairType == kDecayToEE && trackHasCov) {
-      secondaryVertex = fgFitterTwoProngBarrel.getPCACandidate();
-      bz = fgFitterTwoProngBarrel.getBz();
-      covMatrixPCA = fgFitterTwoProngBarrel.calcPCACovMatrixFlat();
-      auto chi2PCA = fgFitterTwoProngBarrel.getChi2AtPCACandidate();
-      auto trackParVar0 = fgFitterTwoProngBarrel.getTrack(0);
-      auto trackParVar1 = fgFitterTwoProngBarrel.getTrack(1);
+      secondaryVertex = GetContext().fFitterTwoProngBarrel.getPCACandidate();
+      bz = GetContext().fFitterTwoProngBarrel.getBz();
+      covMatrixPCA = GetContext().fFitterTwoProngBarrel.calcPCACovMatrixFlat();
+      auto chi2PCA = GetContext().fFitterTwoProngBarrel.getChi2AtPCACandidate();
+      auto trackParVar0 = GetContext().fFitterTwoProngBarrel.getTrack(0);
+      auto trackParVar1 = GetContext().fFitterTwoProngBarrel.getTrack(1);
       values[kVertexingChi2PCA] = chi2PCA;
       trackParVar0.getPxPyPzGlo(pvec0);
       trackParVar1.getPxPyPzGlo(pvec1);
@@ -1285,12 +1580,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       m1 = MassMuon;
       m2 = MassMuon;
 
-      secondaryVertex = fgFitterTwoProngFwd.getPCACandidate();
-      bz = fgFitterTwoProngFwd.getBz();
-      covMatrixPCA = fgFitterTwoProngFwd.calcPCACovMatrixFlat();
-      auto chi2PCA = fgFitterTwoProngFwd.getChi2AtPCACandidate();
-      auto trackParVar0 = fgFitterTwoProngFwd.getTrack(0);
-      auto trackParVar1 = fgFitterTwoProngFwd.getTrack(1);
+      secondaryVertex = GetContext().fFitterTwoProngFwd.getPCACandidate();
+      bz = GetContext().fFitterTwoProngFwd.getBz();
+      covMatrixPCA = GetContext().fFitterTwoProngFwd.calcPCACovMatrixFlat();
+      auto chi2PCA = GetContext().fFitterTwoProngFwd.getChi2AtPCACandidate();
+      auto trackParVar0 = GetContext().fFitterTwoProngFwd.getTrack(0);
+      auto trackParVar1 = GetContext().fFitterTwoProngFwd.getTrack(1);
       values[kVertexingChi2PCA] = chi2PCA;
       pvec0[0] = trackParVar0.getPx();
       pvec0[1] = trackParVar0.getPy();
@@ -1341,7 +1636,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   float mtrack;
@@ -1377,8 +1672,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                            track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
     SMatrix55 t3covs(v3.begin(), v3.end());
     o2::track::TrackParCovFwd pars3{track.z(), t3pars, t3covs, chi23};
-    procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
+    procCode = GetContext().fFitterThreeProngFwd.process(pars1, pars2, pars3);
+    procCodeJpsi = GetContext().fFitterTwoProngFwd.process(pars1, pars2);
   } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
     mlepton = MassElectron;
     mtrack = MassKaonCharged;
@@ -1397,8 +1692,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                                          track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
                                          track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
     o2::track::TrackParCov pars3{track.x(), track.alpha(), lepton3pars, lepton3covs};
-    procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
+    procCode = GetContext().fFitterThreeProngBarrel.process(pars1, pars2, pars3);
+    procCodeJpsi = GetContext().fFitterTwoProngBarrel.process(pars1, pars2);
   } else {
     return;
   }
@@ -1448,11 +1743,11 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
     auto covMatrixPV = primaryVertex.getCov();
 
     if constexpr (candidateType == kBtoJpsiEEK && trackHasCov) {
-      secondaryVertex = fgFitterThreeProngBarrel.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngBarrel.calcPCACovMatrixFlat();
+      secondaryVertex = GetContext().fFitterThreeProngBarrel.getPCACandidate();
+      covMatrixPCA = GetContext().fFitterThreeProngBarrel.calcPCACovMatrixFlat();
     } else if constexpr (candidateType == kBcToThreeMuons && muonHasCov) {
-      secondaryVertex = fgFitterThreeProngFwd.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngFwd.calcPCACovMatrixFlat();
+      secondaryVertex = GetContext().fFitterThreeProngFwd.getPCACandidate();
+      covMatrixPCA = GetContext().fFitterThreeProngFwd.calcPCACovMatrixFlat();
     }
 
     double phi = std::atan2(secondaryVertex[1] - collision.posY(), secondaryVertex[0] - collision.posX());
@@ -1489,7 +1784,7 @@ template <typename C, typename A>
 void VarManager::FillQVectorFromGFW(C const& collision, A const& compA2, A const& compB2, A const& compC2, A const& compA3, A const& compB3, A const& compC3, float normA, float normB, float normC, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   // Fill Qn vectors from generic flow framework for different eta gap A, B, C (n=2,3)
@@ -1530,7 +1825,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
 {
 
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   float m1 = MassElectron;
@@ -1556,7 +1851,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   values[kU3Q3] = values[kQ3X0A] * std::cos(3 * v12.Phi()) + values[kQ3Y0A] * std::sin(3 * v12.Phi());
   values[kCos2DeltaPhi] = std::cos(2 * (v12.Phi() - getEventPlane(2, values[kQ2X0A], values[kQ2Y0A])));
   values[kCos3DeltaPhi] = std::cos(3 * (v12.Phi() - getEventPlane(3, values[kQ3X0A], values[kQ3Y0A])));
-  if (isnan(VarManager::fgValues[VarManager::kU2Q2]) == true) {
+  if (isnan(values[kU2Q2]) == true) {
     values[kU2Q2] = -999.;
     values[kU3Q3] = -999.;
     values[kCos2DeltaPhi] = -999.;
@@ -1568,7 +1863,7 @@ template <typename T1, typename T2>
 void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float* values, float hadronMass)
 {
   if (!values) {
-    values = fgValues;
+    values = GetContext().fValues;
   }
 
   if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kPairEta] || fgUsedVars[kPairPhi]) {
@@ -85,6 +85,9 @@ constexpr static uint32_t gkMuonFillMapWithCov = VarManager::ObjTypes::ReducedMu
 constexpr static uint32_t gkParticleMCFillMap = VarManager::ObjTypes::ParticleMC;
 
 void DefineHistograms(HistogramManager* histMan, TString histClasses);
+// Resolve the handles of the defined histogram classes, which are then filled without looking up the class names
+std::vector<int> GetHistClassHandles(HistogramManager* histMan, std::vector<TString> const& histNames);
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames);
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -94,6 +97,8 @@ struct AnalysisEventSelection {
 
   HistogramManager* fHistMan;
   AnalysisCompositeCut* fEventCut;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  int fHistAfterCuts = HistogramManager::kNothing;
 
   void init(o2::framework::InitContext&)
   {
@@ -110,6 +115,8 @@ struct AnalysisEventSelection {
       DefineHistograms(fHistMan, "Event_BeforeCuts;Event_AfterCuts;"); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                 // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("Event_BeforeCuts");
+      fHistAfterCuts = fHistMan->GetHistClassHandle("Event_AfterCuts");
     }
   }
 
@@ -127,11 +134,11 @@ struct AnalysisEventSelection {
       VarManager::FillEvent<TEventMCFillMap>(event.mcCollision());
     }
     if (fConfigQA) {
-      fHistMan->FillHistClass("Event_BeforeCuts", VarManager::fgValues); // automatically fill all the histograms in the class Event
+      fHistMan->FillHistClass(fHistBeforeCuts, VarManager::fgValues); // automatically fill all the histograms in the class Event
     }
     if (fEventCut->IsSelected(VarManager::fgValues)) {
       if (fConfigQA) {
-        fHistMan->FillHistClass("Event_AfterCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistAfterCuts, VarManager::fgValues);
       }
       eventSel(1);
     } else {
@@ -164,6 +171,9 @@ struct AnalysisTrackSelection {
   std::vector<MCSignal> fMCSignals; // list of signals to be checked
   std::vector<TString> fHistNamesReco;
   std::vector<std::vector<TString>> fHistNamesMCMatched;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  std::vector<int> fHistReco;
+  std::vector<std::vector<int>> fHistMCMatched;
 
   void init(o2::framework::InitContext&)
   {
@@ -216,6 +226,9 @@ struct AnalysisTrackSelection {
       DefineHistograms(fHistMan, histClasses.Data());  // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("TrackBarrel_BeforeCuts");
+      fHistReco = GetHistClassHandles(fHistMan, fHistNamesReco);
+      fHistMCMatched = GetHistClassHandles(fHistMan, fHistNamesMCMatched);
     }
   }
 
@@ -247,7 +260,7 @@ struct AnalysisTrackSelection {
       }
 
       if (fConfigQA) {
-        fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistBeforeCuts, VarManager::fgValues);
       }
 
       // compute track selection and publish the bit map
@@ -256,7 +269,7 @@ struct AnalysisTrackSelection {
         if ((*cut).IsSelected(VarManager::fgValues)) {
           filterMap |= (uint32_t(1) << i);
           if (fConfigQA) {
-            fHistMan->FillHistClass(fHistNamesReco[i].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(fHistReco[i], VarManager::fgValues);
           }
         }
       }
@@ -292,7 +305,7 @@ struct AnalysisTrackSelection {
         }
         for (unsigned int j = 0; j < fTrackCuts.size(); j++) {
           if (filterMap & (uint8_t(1) << j)) {
-            fHistMan->FillHistClass(fHistNamesMCMatched[j][i].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(fHistMCMatched[j][i], VarManager::fgValues);
           }
         } // end loop over cuts
       }   // end loop over MC signals
@@ -324,6 +337,9 @@ struct AnalysisMuonSelection {
   std::vector<MCSignal> fMCSignals; // list of signals to be checked
   std::vector<TString> fHistNamesReco;
   std::vector<std::vector<TString>> fHistNamesMCMatched;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  std::vector<int> fHistReco;
+  std::vector<std::vector<int>> fHistMCMatched;
 
   void init(o2::framework::InitContext&)
   {
@@ -376,6 +392,9 @@ struct AnalysisMuonSelection {
       DefineHistograms(fHistMan, histClasses.Data());  // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("Muon_BeforeCuts");
+      fHistReco = GetHistClassHandles(fHistMan, fHistNamesReco);
+      fHistMCMatched = GetHistClassHandles(fHistMan, fHistNamesMCMatched);
     }
   }
 
@@ -408,7 +427,7 @@ struct AnalysisMuonSelection {
       }
 
       if (fConfigQA) {
-        fHistMan->FillHistClass("Muon_BeforeCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistBeforeCuts, VarManager::fgValues);
       }
 
       // compute the cut selections and publish the filter bit map
@@ -417,7 +436,7 @@ struct AnalysisMuonSelection {
         if ((*cut).IsSelected(VarManager::fgValues)) {
           filterMap |= (uint32_t(1) << i);
           if (fConfigQA) {
-            fHistMan->FillHistClass(fHistNamesReco[i].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(fHistReco[i], VarManager::fgValues);
           }
         }
       }
@@ -456,7 +475,7 @@ struct AnalysisMuonSelection {
         }
         for (unsigned int j = 0; j < fTrackCuts.size(); j++) {
           if (filterMap & (uint8_t(1) << j)) {
-            fHistMan->FillHistClass(fHistNamesMCMatched[j][i].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(fHistMCMatched[j][i], VarManager::fgValues);
           }
         } // end loop over cuts
       }   // end loop over MC signals
@@ -501,8 +520,15 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fMuonHistNamesMCmatched;
   std::vector<std::vector<TString>> fBarrelMuonHistNames;
   std::vector<std::vector<TString>> fBarrelMuonHistNamesMCmatched;
+  std::vector<std::vector<int>> fBarrelHistHandles; // handles of the histogram classes above, resolved in init()
+  std::vector<std::vector<int>> fBarrelHistHandlesMCmatched;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandlesMCmatched;
+  std::vector<std::vector<int>> fBarrelMuonHistHandles;
+  std::vector<std::vector<int>> fBarrelMuonHistHandlesMCmatched;
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
+  std::vector<int> fGenMCHistHandles; // one handle for each generated MC signal
 
   void init(o2::framework::InitContext& context)
   {
@@ -624,7 +650,6 @@ struct AnalysisSameEventPairing {
     */
 
     // Add histogram classes for each specified MCsignal at the generator level
-    // TODO: create a std::vector of hist classes to be used at Fill time, to avoid using Form in the process function
     TString sigGenNamesStr = fConfigMCGenSignals.value;
     std::unique_ptr<TObjArray> objGenSigArray(sigGenNamesStr.Tokenize(","));
     for (int isig = 0; isig < objGenSigArray->GetEntries(); isig++) {
@@ -632,7 +657,7 @@ struct AnalysisSameEventPairing {
       if (sig) {
         if (sig->GetNProngs() == 1) { // NOTE: 1-prong signals required
           fGenMCSignals.push_back(*sig);
-          histNames += Form("MCTruthGen_%s;", sig->GetName()); // TODO: Add these names to a std::vector to avoid using Form in the process function
+          histNames += Form("MCTruthGen_%s;", sig->GetName());
         } else if (sig->GetNProngs() == 2) {                   // NOTE: 2-prong signals required
           fGenMCSignals.push_back(*sig);
           histNames += Form("MCTruthGenPair_%s;", sig->GetName());
@@ -644,6 +669,16 @@ struct AnalysisSameEventPairing {
     VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
 
+    fBarrelHistHandles = GetHistClassHandles(fHistMan, fBarrelHistNames);
+    fBarrelHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelHistNamesMCmatched);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fMuonHistNamesMCmatched);
+    fBarrelMuonHistHandles = GetHistClassHandles(fHistMan, fBarrelMuonHistNames);
+    fBarrelMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelMuonHistNamesMCmatched);
+    for (auto& sig : fGenMCSignals) {
+      fGenMCHistHandles.push_back(fHistMan->GetHistClassHandle(Form(sig.GetNProngs() == 1 ? "MCTruthGen_%s" : "MCTruthGenPair_%s", sig.GetName())));
+    }
+
     VarManager::SetupTwoProngDCAFitter(5.0f, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, true); // TODO: get these parameters from Configurables
     VarManager::SetupTwoProngFwdDCAFitter(5.0f, true, 200.0f, 1.0e-3f, 0.9f, true);
   }
@@ -652,19 +687,11 @@ struct AnalysisSameEventPairing {
   void runPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2, TEventsMC const& eventsMC, TTracksMC const& tracksMC)
   {
     // establish the right histogram classes to be filled depending on TPairType (ee,mumu,emu)
-    unsigned int ncuts = fBarrelHistNames.size();
-    std::vector<std::vector<TString>> histNames = fBarrelHistNames;
-    std::vector<std::vector<TString>> histNamesMCmatched = fBarrelHistNamesMCmatched;
-    if constexpr (TPairType == VarManager::kDecayToMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
-      histNamesMCmatched = fMuonHistNamesMCmatched;
-    }
-    if constexpr (TPairType == VarManager::kElectronMuon) {
-      ncuts = fBarrelMuonHistNames.size();
-      histNames = fBarrelMuonHistNames;
-      histNamesMCmatched = fBarrelMuonHistNamesMCmatched;
-    }
+    constexpr bool isMuMu = (TPairType == VarManager::kDecayToMuMu);
+    constexpr bool isEMu = (TPairType == VarManager::kElectronMuon);
+    auto const& histHandles = isMuMu ? fMuonHistHandles : (isEMu ? fBarrelMuonHistHandles : fBarrelHistHandles);
+    auto const& histHandlesMCmatched = isMuMu ? fMuonHistHandlesMCmatched : (isEMu ? fBarrelMuonHistHandlesMCmatched : fBarrelHistHandlesMCmatched);
+    unsigned int ncuts = histHandles.size();
 
     // Loop over two track combinations
     uint8_t twoTrackFilter = 0;
@@ -727,17 +754,17 @@ struct AnalysisSameEventPairing {
       for (unsigned int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint8_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
             for (unsigned int isig = 0; isig < fRecMCSignals.size(); isig++) {
               if (mcDecision & (uint32_t(1) << isig)) {
-                fHistMan->FillHistClass(histNamesMCmatched[icut][isig].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandlesMCmatched[icut][isig], VarManager::fgValues);
               }
             }
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
             }
           }
         }
@@ -756,25 +783,27 @@ struct AnalysisSameEventPairing {
       // NOTE: Signals are checked here mostly based on the skimmed MC stack, so depending on the requested signal, the stack could be incomplete.
       // NOTE: However, the working model is that the decisions on MC signals are precomputed during skimming and are stored in the mcReducedFlags member.
       // TODO:  Use the mcReducedFlags to select signals
-      for (auto& sig : fGenMCSignals) {
+      for (unsigned int isig = 0; isig < fGenMCSignals.size(); isig++) {
+        auto& sig = fGenMCSignals[isig];
         if (sig.GetNProngs() != 1) { // NOTE: 1-prong signals required
           continue;
         }
         if (sig.CheckSignal(false, groupedMCTracks, mctrack)) {
-          fHistMan->FillHistClass(Form("MCTruthGen_%s", sig.GetName()), VarManager::fgValues);
+          fHistMan->FillHistClass(fGenMCHistHandles[isig], VarManager::fgValues);
         }
       }
     }
 
     //    // loop over mc stack and fill histograms for pure MC truth signals
-    for (auto& sig : fGenMCSignals) {
+    for (unsigned int isig = 0; isig < fGenMCSignals.size(); isig++) {
+      auto& sig = fGenMCSignals[isig];
       if (sig.GetNProngs() != 2) { // NOTE: 2-prong signals required
         continue;
       }
       for (auto& [t1, t2] : combinations(groupedMCTracks, groupedMCTracks)) {
         if (sig.CheckSignal(false, groupedMCTracks, t1, t2)) {
           VarManager::FillPairMC(t1, t2);
-          fHistMan->FillHistClass(Form("MCTruthGenPair_%s", sig.GetName()), VarManager::fgValues);
+          fHistMan->FillHistClass(fGenMCHistHandles[isig], VarManager::fgValues);
         }
       }
     } // end of true pairing loop
@@ -890,9 +919,14 @@ struct AnalysisDileptonTrack {
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fMuonHistNamesMCmatched;
   std::vector<TString> fRecMCSignalsNames;
+  int fHistDileptons = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  int fHistDileptonTrack = HistogramManager::kNothing;
+  std::vector<int> fHistDileptonsMCmatched; // one handle for each reconstructed MC signal
+  std::vector<int> fHistDileptonTrackMCmatched;
 
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
+  std::vector<int> fGenMCHistHandles; // one handle for each generated MC signal
 
   // NOTE: the barrel track filter is shared between the filters for dilepton electron candidates (first n-bits)
   //       and the associated hadrons (n+1 bit) --> see the barrel track selection task
@@ -948,7 +982,6 @@ struct AnalysisDileptonTrack {
       }
 
       // Add histogram classes for each specified MCsignal at the generator level
-      // TODO: create a std::vector of hist classes to be used at Fill time, to avoid using Form in the process function
       TString sigGenNamesStr = fConfigMCGenSignals.value;
       std::unique_ptr<TObjArray> objGenSigArray(sigGenNamesStr.Tokenize(","));
       for (int isig = 0; isig < objGenSigArray->GetEntries(); isig++) {
@@ -956,7 +989,7 @@ struct AnalysisDileptonTrack {
         if (sig) {
           if (sig->GetNProngs() == 1) { // NOTE: 1-prong signals required
             fGenMCSignals.push_back(*sig);
-            histNames += Form("MCTruthGen_%s;", sig->GetName()); // TODO: Add these names to a std::vector to avoid using Form in the process function
+            histNames += Form("MCTruthGen_%s;", sig->GetName());
           }
         }
       }
@@ -964,6 +997,16 @@ struct AnalysisDileptonTrack {
       DefineHistograms(fHistMan, histNames.Data()); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+      fHistDileptons = fHistMan->GetHistClassHandle("DileptonsSelected");
+      fHistDileptonTrack = fHistMan->GetHistClassHandle("DileptonTrackInvMass");
+      for (auto& sigName : fRecMCSignalsNames) {
+        fHistDileptonsMCmatched.push_back(fHistMan->GetHistClassHandle(Form("DileptonsSelected_matchedMC_%s", sigName.Data())));
+        fHistDileptonTrackMCmatched.push_back(fHistMan->GetHistClassHandle(Form("DileptonTrackInvMass_matchedMC_%s", sigName.Data())));
+      }
+      for (auto& sig : fGenMCSignals) {
+        fGenMCHistHandles.push_back(fHistMan->GetHistClassHandle(Form("MCTruthGen_%s", sig.GetName())));
+      }
     }
 
     TString configCutNamesStr = fConfigTrackCuts.value;
@@ -1010,7 +1053,7 @@ struct AnalysisDileptonTrack {
       }
 
       VarManager::FillTrack<fgDileptonFillMap>(dilepton, fValuesDilepton);
-      fHistMan->FillHistClass("DileptonsSelected", fValuesDilepton);
+      fHistMan->FillHistClass(fHistDileptons, fValuesDilepton);
 
       auto lepton1MC = lepton1.reducedMCTrack();
       auto lepton2MC = lepton2.reducedMCTrack();
@@ -1028,7 +1071,7 @@ struct AnalysisDileptonTrack {
 
       for (unsigned int isig = 0; isig < fRecMCSignals.size(); isig++) {
         if (mcDecision & (uint32_t(1) << isig)) {
-          fHistMan->FillHistClass(Form("DileptonsSelected_matchedMC_%s", fRecMCSignalsNames[isig].Data()), fValuesDilepton);
+          fHistMan->FillHistClass(fHistDileptonsMCmatched[isig], fValuesDilepton);
         }
       }
 
@@ -1046,7 +1089,7 @@ struct AnalysisDileptonTrack {
 
         VarManager::FillDileptonHadron(dilepton, track, fValuesTrack);
         VarManager::FillDileptonTrackVertexing<TCandidateType, TEventFillMap, TTrackFillMap>(event, lepton1, lepton2, track, fValuesTrack);
-        fHistMan->FillHistClass("DileptonTrackInvMass", fValuesTrack);
+        fHistMan->FillHistClass(fHistDileptonTrack, fValuesTrack);
 
         mcDecision = 0;
         isig = 0;
@@ -1064,7 +1107,7 @@ struct AnalysisDileptonTrack {
 
         for (unsigned int isig = 0; isig < fRecMCSignals.size(); isig++) {
           if (mcDecision & (uint32_t(1) << isig)) {
-            fHistMan->FillHistClass(Form("DileptonTrackInvMass_matchedMC_%s", fRecMCSignalsNames[isig].Data()), fValuesTrack);
+            fHistMan->FillHistClass(fHistDileptonTrackMCmatched[isig], fValuesTrack);
           }
         }
       }
@@ -1082,12 +1125,13 @@ struct AnalysisDileptonTrack {
       // NOTE: Signals are checked here mostly based on the skimmed MC stack, so depending on the requested signal, the stack could be incomplete.
       // NOTE: However, the working model is that the decisions on MC signals are precomputed during skimming and are stored in the mcReducedFlags member.
       // TODO:  Use the mcReducedFlags to select signals
-      for (auto& sig : fGenMCSignals) {
+      for (unsigned int isig = 0; isig < fGenMCSignals.size(); isig++) {
+        auto& sig = fGenMCSignals[isig];
         if (sig.GetNProngs() != 1) { // NOTE: 1-prong signals required
           continue;
         }
         if (sig.CheckSignal(false, groupedMCTracks, mctrack)) {
-          fHistMan->FillHistClass(Form("MCTruthGen_%s", sig.GetName()), VarManager::fgValues);
+          fHistMan->FillHistClass(fGenMCHistHandles[isig], VarManager::fgValues);
         }
       }
     }
@@ -1185,3 +1229,21 @@ void DefineHistograms(HistogramManager* histMan, TString histClasses)
 
   } // end loop over histogram classes
 }
+
+std::vector<int> GetHistClassHandles(HistogramManager* histMan, std::vector<TString> const& histNames)
+{
+  std::vector<int> handles;
+  for (auto const& name : histNames) {
+    handles.push_back(histMan->GetHistClassHandle(name.Data()));
+  }
+  return handles;
+}
+
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  std::vector<std::vector<int>> handles;
+  for (auto const& names : histNames) {
+    handles.push_back(GetHistClassHandles(histMan, names));
+  }
+  return handles;
+}
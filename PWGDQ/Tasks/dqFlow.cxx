@@ -131,6 +131,9 @@ struct DQEventQvector {
 
   // define global variables for generic framework
   GFW* fGFW = new GFW();
+  // tracks of the event, filled into the GFW in one batch
+  std::vector<double> fGFWEta, fGFWPhi, fGFWWeight;
+  std::vector<int> fGFWPtIn, fGFWMask;
   //std::vector<GFW::CorrConfig> corrconfigs;
   TRandom3* fRndm = new TRandom3(0);
 
@@ -260,7 +263,12 @@ struct DQEventQvector {
     // acceptance and efficiency weights
     float weff = 1.0, wacc = 1.0;
 
-    // Fill the GFW object in the track loop
+    // Collect the tracks in the track loop, then fill the GFW object in one go
+    fGFWEta.clear();
+    fGFWPtIn.clear();
+    fGFWPhi.clear();
+    fGFWWeight.clear();
+    fGFWMask.clear();
     for (auto& track : tracks1) {
 
       if (cfg.mEfficiency) {
@@ -279,9 +287,14 @@ struct DQEventQvector {
       }
       // VarManager::FillTrack<TTrackFillMap>(track);
 
-      // Fill the GFW for each track to compute Q vector
-      fGFW->Fill(track.eta(), 0, track.phi(), wacc * weff, 3); // using default values for ptin=0 and mask=3
+      // Add the track to the GFW batch to compute Q vector
+      fGFWEta.push_back(track.eta());
+      fGFWPtIn.push_back(0); // using default values for ptin=0 and mask=3
+      fGFWPhi.push_back(track.phi());
+      fGFWWeight.push_back(wacc * weff);
+      fGFWMask.push_back(3);
     }
+    fGFW->Fill(fGFWEta.size(), fGFWEta.data(), fGFWPtIn.data(), fGFWPhi.data(), fGFWWeight.data(), fGFWMask.data());
 
     //    float l_Random = fRndm->Rndm(); // used only to compute correlators
     //    bool fillFlag = kFALSE;         // could be used later
@@ -33,6 +33,7 @@
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MixingLibrary.h"
+#include "Common/Core/EventMixingPool.h"
 
 using std::cout;
 using std::endl;
@@ -104,6 +105,8 @@ constexpr static int pairTypeEMu = VarManager::kElectronMuon;
 
 // Global function used to define needed histogram classes
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar); // defines histograms for all tasks
+// Global function used to resolve the handles of the defined histogram classes, which are then filled without looking up the class names
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames);
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -118,6 +121,8 @@ struct AnalysisEventSelection {
   HistogramManager* fHistMan = nullptr;
   MixingHandler* fMixHandler = nullptr;
   AnalysisCompositeCut* fEventCut;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  int fHistAfterCuts = HistogramManager::kNothing;
 
   void init(o2::framework::InitContext&)
   {
@@ -134,6 +139,8 @@ struct AnalysisEventSelection {
       DefineHistograms(fHistMan, "Event_BeforeCuts;Event_AfterCuts;", fConfigAddEventHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                                           // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("Event_BeforeCuts");
+      fHistAfterCuts = fHistMan->GetHistClassHandle("Event_AfterCuts");
     }
 
     TString mixVarsString = fConfigMixingVariables.value;
@@ -156,11 +163,11 @@ struct AnalysisEventSelection {
     VarManager::FillEvent<TEventFillMap>(event);
     // TODO: make this condition at compile time
     if (fConfigQA) {
-      fHistMan->FillHistClass("Event_BeforeCuts", VarManager::fgValues); // automatically fill all the histograms in the class Event
+      fHistMan->FillHistClass(fHistBeforeCuts, VarManager::fgValues); // automatically fill all the histograms in the class Event
     }
     if (fEventCut->IsSelected(VarManager::fgValues)) {
       if (fConfigQA) {
-        fHistMan->FillHistClass("Event_AfterCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistAfterCuts, VarManager::fgValues);
       }
       eventSel(1);
     } else {
@@ -206,6 +213,13 @@ struct AnalysisTrackSelection {
 
   HistogramManager* fHistMan;
   std::vector<AnalysisCompositeCut> fTrackCuts;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  std::vector<int> fHistCuts;                       // one handle for each track cut
+
+  ValuesBatch fTrackBatch;            // used variables of all the tracks of an event, one column per variable
+  std::vector<uint8_t> fCutDecisions; // decisions of a cut for all the tracks of an event
+  std::vector<uint32_t> fFilterMaps;  // filter map of each track of an event
+  std::vector<uint8_t> fPrefilter;    // prefilter decision of each track of an event
 
   int fCurrentRun; // needed to detect if the run changed and trigger update of calibrations etc.
 
@@ -238,6 +252,11 @@ struct AnalysisTrackSelection {
       DefineHistograms(fHistMan, histDirNames.Data(), fConfigAddTrackHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                           // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("TrackBarrel_BeforeCuts");
+      for (auto& cut : fTrackCuts) {
+        fHistCuts.push_back(fHistMan->GetHistClassHandle(Form("TrackBarrel_%s", cut.GetName())));
+      }
     }
 
     if (fConfigComputeTPCpostCalib) {
@@ -272,35 +291,38 @@ struct AnalysisTrackSelection {
       fCurrentRun = event.runNumber();
     }
 
-    trackSel.reserve(tracks.size());
-    uint32_t filterMap = 0;
-    bool prefilterSelected = false;
+    // compute the used variables for all the tracks of the event, then apply each cut and fill the histograms over the whole batch
+    VarManager::FillTrackBatch<TTrackFillMap>(tracks, fTrackBatch);
+    const int nTracks = fTrackBatch.GetNRows();
+    if (fConfigQA) { // TODO: make this compile time
+      fHistMan->FillHistClass(fHistBeforeCuts, fTrackBatch);
+    }
+    fCutDecisions.resize(nTracks);
+    fFilterMaps.assign(nTracks, 0);
+    fPrefilter.assign(nTracks, 0);
     int iCut = 0;
-
-    for (auto& track : tracks) {
-      filterMap = 0;
-      prefilterSelected = false;
-      VarManager::FillTrack<TTrackFillMap>(track);
-      if (fConfigQA) { // TODO: make this compile time
-        fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
-      }
-      iCut = 0;
-      for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
-          if (iCut != fConfigPrefilterCutId) {
-            filterMap |= (uint32_t(1) << iCut);
-          }
-          if (iCut == fConfigPrefilterCutId) {
-            prefilterSelected = true;
-          }
-          if (fConfigQA) { // TODO: make this compile time
-            fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
-          }
+    for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
+      (*cut).IsSelected(fTrackBatch, fCutDecisions.data());
+      for (int i = 0; i < nTracks; i++) {
+        if (!fCutDecisions[i]) {
+          continue;
+        }
+        if (iCut != fConfigPrefilterCutId) {
+          fFilterMaps[i] |= (uint32_t(1) << iCut);
+        }
+        if (iCut == fConfigPrefilterCutId) {
+          fPrefilter[i] = 1;
         }
       }
+      if (fConfigQA) { // TODO: make this compile time
+        fHistMan->FillHistClass(fHistCuts[iCut], fTrackBatch, fCutDecisions.data());
+      }
+    }
 
-      trackSel(static_cast<int>(filterMap), static_cast<int>(prefilterSelected));
-    } // end loop over tracks
+    trackSel.reserve(nTracks);
+    for (int i = 0; i < nTracks; i++) {
+      trackSel(static_cast<int>(fFilterMaps[i]), static_cast<int>(fPrefilter[i]));
+    }
   }
 
   void processSkimmed(MyEvents::iterator const& event, MyBarrelTracks const& tracks)
@@ -325,6 +347,8 @@ struct AnalysisMuonSelection {
 
   HistogramManager* fHistMan;
   std::vector<AnalysisCompositeCut> fMuonCuts;
+  int fHistBeforeCuts = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  std::vector<int> fHistCuts;                       // one handle for each muon cut
 
   void init(o2::framework::InitContext&)
   {
@@ -352,6 +376,11 @@ struct AnalysisMuonSelection {
       DefineHistograms(fHistMan, histDirNames.Data(), fConfigAddMuonHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());                          // provide the list of required variables so that VarManager knows what to fill
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+
+      fHistBeforeCuts = fHistMan->GetHistClassHandle("TrackMuon_BeforeCuts");
+      for (auto& cut : fMuonCuts) {
+        fHistCuts.push_back(fHistMan->GetHistClassHandle(Form("TrackMuon_%s", cut.GetName())));
+      }
     }
   }
 
@@ -369,7 +398,7 @@ struct AnalysisMuonSelection {
       filterMap = 0;
       VarManager::FillTrack<TMuonFillMap>(muon);
       if (fConfigQA) { // TODO: make this compile time
-        fHistMan->FillHistClass("TrackMuon_BeforeCuts", VarManager::fgValues);
+        fHistMan->FillHistClass(fHistBeforeCuts, VarManager::fgValues);
       }
 
       iCut = 0;
@@ -377,7 +406,7 @@ struct AnalysisMuonSelection {
         if ((*cut).IsSelected(VarManager::fgValues)) {
           filterMap |= (uint32_t(1) << iCut);
           if (fConfigQA) { // TODO: make this compile time
-            fHistMan->FillHistClass(Form("TrackMuon_%s", (*cut).GetName()), VarManager::fgValues);
+            fHistMan->FillHistClass(fHistCuts[iCut], VarManager::fgValues);
           }
         }
       }
@@ -491,8 +520,15 @@ struct AnalysisEventMixing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  std::vector<std::vector<int>> fTrackHistHandles; // handles of the histogram classes above, resolved in init()
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fTrackMuonHistHandles;
 
-  NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
+  // Pool of the selected tracks (or muons) of the past events of each mixing category, with the event-wise variables of these events
+  eventmixing::MixingPool fTrackPool;
+  eventmixing::PoolEvent fCurrentTracks;
+  eventmixing::PoolEvent fCurrentMuons;
+  std::vector<int> fEventVariables; // event-wise variables, stored with each pool event
 
   void init(o2::framework::InitContext& context)
   {
@@ -557,35 +593,62 @@ struct AnalysisEventMixing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddEventMixingHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                              // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+    fTrackHistHandles = GetHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetHistClassHandles(fHistMan, fTrackMuonHistNames);
+
+    // All the event-wise variables are stored, also those not used by the histograms but read when filling the pairs
+    // (e.g. the Q-vectors in FillPairVn), as FillEvent would provide them for each mixed event
+    for (int var = 0; var < VarManager::kNEventWiseVariables; ++var) {
+      fEventVariables.push_back(var);
+    }
   }
 
-  template <int TPairType, typename TTracks1, typename TTracks2>
-  void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
+  // Copy the tracks with at least one of the bits of filterMask into the pool event, together with the event-wise variables
+  template <uint32_t TEventFillMap, bool TMuon, typename TEvent, typename TTracks>
+  void fillPoolEvent(TEvent const& event, TTracks const& tracks, uint32_t filterMask, eventmixing::PoolEvent& poolEvent)
   {
-
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
-    if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+    poolEvent.clear();
+    VarManager::ResetValues(0, VarManager::kNVars);
+    VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+    for (auto& var : fEventVariables) {
+      poolEvent.addValue(VarManager::fgValues[var]);
     }
-    if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+    for (auto& track : tracks) {
+      uint32_t mask = 0;
+      if constexpr (TMuon) {
+        mask = uint32_t(track.isMuonSelected()) & filterMask;
+      } else {
+        mask = uint32_t(track.isBarrelSelected()) & filterMask;
+      }
+      if (mask) {
+        poolEvent.addTrack(track.pt(), track.eta(), track.phi(), track.sign(), mask);
+      }
     }
+  }
 
+  // Restore the event variables of a pool event, as filled by VarManager::FillEvent
+  void setEventValues(eventmixing::PoolEvent const& poolEvent)
+  {
+    VarManager::ResetValues(0, VarManager::kNVars);
+    const auto& values = poolEvent.values();
+    for (size_t i = 0; i < fEventVariables.size(); ++i) {
+      VarManager::fgValues[fEventVariables[i]] = values[i];
+    }
+  }
+
+  template <int TPairType>
+  void runMixedPairing(eventmixing::PoolEvent const& tracks1, eventmixing::PoolEvent const& tracks2)
+  {
+
+    auto const& histHandles = (TPairType == pairTypeMuMu) ? fMuonHistHandles : ((TPairType == pairTypeEMu) ? fTrackMuonHistHandles : fTrackHistHandles);
+    unsigned int ncuts = histHandles.size();
+
+    // the masks of the pool tracks already include the two-track filter mask of the pair type
     uint32_t twoTrackFilter = 0;
-    for (auto& track1 : tracks1) {
-      for (auto& track2 : tracks2) {
-        if constexpr (TPairType == VarManager::kDecayToEE) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isBarrelSelected()) & fTwoTrackFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kDecayToMuMu) {
-          twoTrackFilter = uint32_t(track1.isMuonSelected()) & uint32_t(track2.isMuonSelected()) & fTwoMuonFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kElectronMuon) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isMuonSelected()) & fTwoTrackFilterMask;
-        }
+    for (auto track1 : tracks1) {
+      for (auto track2 : tracks2) {
+        twoTrackFilter = track1.mask() & track2.mask();
 
         if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
           continue;
@@ -600,12 +663,12 @@ struct AnalysisEventMixing {
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
             if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
             } else {
               if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
               } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
               }
             }
           } // end if (filter bits)
@@ -615,40 +678,35 @@ struct AnalysisEventMixing {
   }
 
   // barrel-barrel and muon-muon event mixing
+  // Each event is paired with the previous events of its mixing category (at most cfgMixingDepth) in the dataframe
   template <int TPairType, uint32_t TEventFillMap, typename TEvents, typename TTracks>
   void runSameSide(TEvents& events, TTracks const& tracks)
   {
     events.bindExternalIndices(&tracks);
     auto tracksTuple = std::make_tuple(tracks);
-    int mixingDepth = fConfigMixingDepth.value;
     GroupSlicer slicerTracks(events, tracksTuple);
-    for (auto& [event1, event2] : selfCombinations(hashBin, mixingDepth, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
-      auto it1 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event1.index()) {
-          it1 = slice;
-          break;
-        }
+    constexpr bool isMuon = (TPairType == pairTypeMuMu);
+    const uint32_t filterMask = isMuon ? fTwoMuonFilterMask : fTwoTrackFilterMask;
+    fTrackPool.setDepth(fConfigMixingDepth.value);
+    for (auto& slice : slicerTracks) {
+      auto event = slice.groupingElement();
+      int category = event.mixingHash();
+      if (category < 0) {
+        continue;
       }
-      auto tracks1 = std::get<TTracks>(it1.associatedTables());
-      tracks1.bindExternalIndices(&events);
-      auto it2 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event2.index()) {
-          it2 = slice;
-          break;
-        }
+      auto eventTracks = std::get<TTracks>(slice.associatedTables());
+      fillPoolEvent<TEventFillMap, isMuon>(event, eventTracks, filterMask, fCurrentTracks);
+      for (int iEvent = 0; iEvent < fTrackPool.getNEvents(category); ++iEvent) {
+        auto const& poolTracks = fTrackPool.getEvent(category, iEvent);
+        setEventValues(poolTracks);
+        runMixedPairing<TPairType>(poolTracks, fCurrentTracks);
       }
-      auto tracks2 = std::get<TTracks>(it2.associatedTables());
-      tracks2.bindExternalIndices(&events);
-
-      runMixedPairing<TPairType>(tracks1, tracks2);
+      fTrackPool.addEvent(category, fCurrentTracks);
     } // end event loop
   }
 
   // barrel-muon event mixing
+  // The barrel tracks of each event are paired with the muons of the next events of its mixing category (at most 100) in the dataframe
   template <uint32_t TEventFillMap, typename TEvents, typename TTracks, typename TMuons>
   void runBarrelMuon(TEvents& events, TTracks const& tracks, TMuons const& muons)
   {
@@ -657,29 +715,26 @@ struct AnalysisEventMixing {
     auto muonsTuple = std::make_tuple(muons);
     GroupSlicer slicerTracks(events, tracksTuple);
     GroupSlicer slicerMuons(events, muonsTuple);
-    for (auto& [event1, event2] : selfCombinations(hashBin, 100, -1, events, events)) {
-      VarManager::ResetValues(0, VarManager::kNVars);
-      VarManager::FillEvent<TEventFillMap>(event1, VarManager::fgValues);
-      auto it1 = slicerTracks.begin();
-      for (auto& slice : slicerTracks) {
-        if (slice.groupingElement().index() == event1.index()) {
-          it1 = slice;
-          break;
-        }
+    fTrackPool.setDepth(100);
+    auto itMuons = slicerMuons.begin();
+    for (auto& slice : slicerTracks) {
+      auto event = slice.groupingElement();
+      auto sliceMuons = itMuons;
+      ++itMuons;
+      int category = event.mixingHash();
+      if (category < 0) {
+        continue;
       }
-      auto tracks1 = std::get<TTracks>(it1.associatedTables());
-      tracks1.bindExternalIndices(&events);
-      auto it2 = slicerMuons.begin();
-      for (auto& slice : slicerMuons) {
-        if (slice.groupingElement().index() == event2.index()) {
-          it2 = slice;
-          break;
-        }
+      auto eventTracks = std::get<TTracks>(slice.associatedTables());
+      auto eventMuons = std::get<TMuons>(sliceMuons.associatedTables());
+      fillPoolEvent<TEventFillMap, false>(event, eventTracks, fTwoTrackFilterMask, fCurrentTracks);
+      fillPoolEvent<TEventFillMap, true>(event, eventMuons, fTwoTrackFilterMask, fCurrentMuons);
+      for (int iEvent = 0; iEvent < fTrackPool.getNEvents(category); ++iEvent) {
+        auto const& poolTracks = fTrackPool.getEvent(category, iEvent);
+        setEventValues(poolTracks);
+        runMixedPairing<pairTypeEMu>(poolTracks, fCurrentMuons);
       }
-      auto muons2 = std::get<TMuons>(it2.associatedTables());
-      muons2.bindExternalIndices(&events);
-
-      runMixedPairing<pairTypeEMu>(tracks1, muons2);
+      fTrackPool.addEvent(category, fCurrentTracks);
     } // end event loop
   }
 
@@ -751,6 +806,9 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  std::vector<std::vector<int>> fTrackHistHandles; // handles of the histogram classes above, resolved in init()
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fTrackMuonHistHandles;
 
   void init(o2::framework::InitContext& context)
   {
@@ -822,6 +880,9 @@ struct AnalysisSameEventPairing {
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
+    fTrackHistHandles = GetHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetHistClassHandles(fHistMan, fTrackMuonHistNames);
 
     VarManager::SetupTwoProngDCAFitter(5.0f, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, true); // TODO: get these parameters from Configurables
     VarManager::SetupTwoProngFwdDCAFitter(5.0f, true, 200.0f, 1.0e-3f, 0.9f, true);
@@ -831,16 +892,8 @@ struct AnalysisSameEventPairing {
   template <int TPairType, uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvent, typename TTracks1, typename TTracks2>
   void runSameEventPairing(TEvent const& event, TTracks1 const& tracks1, TTracks2 const& tracks2)
   {
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
-    if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
-    }
-    if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
-    }
+    auto const& histHandles = (TPairType == pairTypeMuMu) ? fMuonHistHandles : ((TPairType == pairTypeEMu) ? fTrackMuonHistHandles : fTrackHistHandles);
+    unsigned int ncuts = histHandles.size();
 
     uint32_t twoTrackFilter = 0;
     uint32_t dileptonFilterMap = 0;
@@ -894,12 +947,12 @@ struct AnalysisSameEventPairing {
       for (unsigned int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint32_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
             }
           }
         } // end if (filter bits)
@@ -1008,6 +1061,9 @@ struct AnalysisDileptonHadron {
   float* fValuesDilepton;
   float* fValuesHadron;
   HistogramManager* fHistMan;
+  int fHistDileptons = HistogramManager::kNothing; // handles of the histogram classes, resolved in init()
+  int fHistInvMass = HistogramManager::kNothing;
+  int fHistCorrelation = HistogramManager::kNothing;
 
   // NOTE: the barrel track filter is shared between the filters for dilepton electron candidates (first n-bits)
   //       and the associated hadrons (n+1 bit) --> see the barrel track selection task
@@ -1029,6 +1085,9 @@ struct AnalysisDileptonHadron {
       DefineHistograms(fHistMan, "DileptonsSelected;DileptonHadronInvMass;DileptonHadronCorrelation", fConfigAddDileptonHadHistogram); // define all histograms
       VarManager::SetUseVars(fHistMan->GetUsedVars());
       fOutputList.setObject(fHistMan->GetMainHistogramList());
+      fHistDileptons = fHistMan->GetHistClassHandle("DileptonsSelected");
+      fHistInvMass = fHistMan->GetHistClassHandle("DileptonHadronInvMass");
+      fHistCorrelation = fHistMan->GetHistClassHandle("DileptonHadronCorrelation");
     }
 
     TString configCutNamesStr = fConfigTrackCuts.value;
@@ -1052,7 +1111,7 @@ struct AnalysisDileptonHadron {
     // loop once over dileptons for QA purposes
     for (auto dilepton : dileptons) {
       VarManager::FillTrack<fgDileptonFillMap>(dilepton, fValuesDilepton);
-      fHistMan->FillHistClass("DileptonsSelected", fValuesDilepton);
+      fHistMan->FillHistClass(fHistDileptons, fValuesDilepton);
       // loop over hadrons
       for (auto& hadron : tracks) {
         // TODO: Replace this with a Filter expression
@@ -1061,8 +1120,8 @@ struct AnalysisDileptonHadron {
         }
         // TODO: Check whether this hadron is one of the dilepton daughters!
         VarManager::FillDileptonHadron(dilepton, hadron, fValuesHadron);
-        fHistMan->FillHistClass("DileptonHadronInvMass", fValuesHadron);
-        fHistMan->FillHistClass("DileptonHadronCorrelation", fValuesHadron);
+        fHistMan->FillHistClass(fHistInvMass, fValuesHadron);
+        fHistMan->FillHistClass(fHistCorrelation, fValuesHadron);
       }
     }
   }
@@ -1150,3 +1209,16 @@ void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurab
     }
   } // end loop over histogram classes
 }
+
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  std::vector<std::vector<int>> handles;
+  for (auto const& names : histNames) {
+    std::vector<int> classHandles;
+    for (auto const& name : names) {
+      classHandles.push_back(histMan->GetHistClassHandle(name.Data()));
+    }
+    handles.push_back(classHandles);
+  }
+  return handles;
+}
@@ -472,10 +472,10 @@ struct v0selector {
 
       registry.fill(HIST("hV0APplot"), alpha, qtarm);
 
-      float mGamma = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kElectron), RecoDecay::getMassPDG(kElectron)});
-      float mK0S = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kPiPlus)});
-      float mLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
-      float mAntiLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
+      float mGamma = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG<kElectron>(), RecoDecay::getMassPDG<kElectron>()});
+      float mK0S = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
+      float mLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG<kProton>(), RecoDecay::getMassPDG<kPiPlus>()});
+      float mAntiLambda = RecoDecay::m(array{pvec0, pvec1}, array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kProton>()});
 
       int v0id = checkV0(pvec0, pvec1);
       if (v0id < 0) {
@@ -712,10 +712,10 @@ struct v0selector {
         continue;
       }
 
-      float mLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kPiPlus)});
-      float mAntiLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kProton)});
-      float mXi = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kPiPlus)});
-      float mOmega = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG(kLambda0), RecoDecay::getMassPDG(kKPlus)});
+      float mLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG<kProton>(), RecoDecay::getMassPDG<kPiPlus>()});
+      float mAntiLambda = RecoDecay::m(array{pvecpos, pvecneg}, array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kProton>()});
+      float mXi = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG<kLambda0>(), RecoDecay::getMassPDG<kPiPlus>()});
+      float mOmega = RecoDecay::m(array{pvecv0, pvecbach}, array{RecoDecay::getMassPDG<kLambda0>(), RecoDecay::getMassPDG<kKPlus>()});
 
       // for Lambda->p + pi-
       if (v0id == kLambda) {
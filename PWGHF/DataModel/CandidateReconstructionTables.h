@@ -332,43 +332,43 @@ enum DecayType { D0ToPiK = 0,
 template <typename T>
 auto ctD0(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kD0));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kD0>());
 }
 
 template <typename T>
 auto yD0(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kD0));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kD0>());
 }
 
 template <typename T>
 auto eD0(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kD0));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kD0>());
 }
 
 template <typename T>
 auto invMassD0ToPiK(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kKPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kKPlus>()});
 }
 
 template <typename T>
 auto invMassD0barToKPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 template <typename T>
 auto cosThetaStarD0(const T& candidate)
 {
-  return candidate.cosThetaStar(array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kKPlus)}, RecoDecay::getMassPDG(pdg::Code::kD0), 1);
+  return candidate.cosThetaStar(array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kKPlus>()}, RecoDecay::getMassPDG<pdg::Code::kD0>(), 1);
 }
 
 template <typename T>
 auto cosThetaStarD0bar(const T& candidate)
 {
-  return candidate.cosThetaStar(array{RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kPiPlus)}, RecoDecay::getMassPDG(pdg::Code::kD0), 0);
+  return candidate.cosThetaStar(array{RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kPiPlus>()}, RecoDecay::getMassPDG<pdg::Code::kD0>(), 0);
 }
 
 // J/ψ
@@ -376,33 +376,33 @@ auto cosThetaStarD0bar(const T& candidate)
 template <typename T>
 auto ctJpsi(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kJPsi));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kJPsi>());
 }
 
 template <typename T>
 auto yJpsi(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kJPsi));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kJPsi>());
 }
 
 template <typename T>
 auto eJpsi(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kJPsi));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kJPsi>());
 }
 
 // J/ψ → e+ e−
 template <typename T>
 auto invMassJpsiToEE(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kElectron), RecoDecay::getMassPDG(kElectron)});
+  return candidate.m(array{RecoDecay::getMassPDG<kElectron>(), RecoDecay::getMassPDG<kElectron>()});
 }
 // J/ψ → μ+ μ−
 
 template <typename T>
 auto invMassJpsiToMuMu(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kMuonPlus), RecoDecay::getMassPDG(kMuonMinus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kMuonPlus>(), RecoDecay::getMassPDG(kMuonMinus)});
 }
 
 } // namespace hf_cand_2prong
@@ -500,13 +500,13 @@ DECLARE_SOA_COLUMN(FlagMcMatchGen, flagMcMatchGen, int8_t); //! generator level
 template <typename T>
 auto invMassLcToK0sP(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kK0Short), RecoDecay::getMassPDG(kProton)}); // first daughter is K0s
+  return candidate.m(array{RecoDecay::getMassPDG<kK0Short>(), RecoDecay::getMassPDG<kProton>()}); // first daughter is K0s
 }
 
 template <typename T>
 auto invMassGammaToEE(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kElectron), RecoDecay::getMassPDG(kElectron)});
+  return candidate.m(array{RecoDecay::getMassPDG<kElectron>(), RecoDecay::getMassPDG<kElectron>()});
 }
 
 } // namespace hf_cand_casc
@@ -593,31 +593,31 @@ enum DecayType { BplusToD0Pi = 0 };
 template <typename T>
 auto ctBplus(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kBPlus));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kBPlus>());
 }
 
 template <typename T>
 auto yBplus(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kBPlus));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kBPlus>());
 }
 
 template <typename T>
 auto eBplus(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kBPlus));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kBPlus>());
 }
 
 template <typename T>
 auto invMassBplusToD0Pi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kD0), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<pdg::Code::kD0>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 template <typename T>
 auto cosThetaStarBplus(const T& candidate)
 {
-  return candidate.cosThetaStar(array{RecoDecay::getMassPDG(pdg::Code::kD0), RecoDecay::getMassPDG(kPiPlus)}, RecoDecay::getMassPDG(pdg::Code::kBPlus), 1);
+  return candidate.cosThetaStar(array{RecoDecay::getMassPDG<pdg::Code::kD0>(), RecoDecay::getMassPDG<kPiPlus>()}, RecoDecay::getMassPDG<pdg::Code::kBPlus>(), 1);
 }
 } // namespace hf_cand_bplus
 
@@ -709,25 +709,25 @@ enum DecayType { DplusToPiKPi = 0,
 template <typename T>
 auto ctDplus(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kDPlus));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kDPlus>());
 }
 
 template <typename T>
 auto yDplus(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kDPlus));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kDPlus>());
 }
 
 template <typename T>
 auto eDplus(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kDPlus));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kDPlus>());
 }
 
 template <typename T>
 auto invMassDplusToPiKPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 // Ds± → K± K∓ π±
@@ -735,31 +735,31 @@ auto invMassDplusToPiKPi(const T& candidate)
 template <typename T>
 auto ctDs(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kDS));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kDS>());
 }
 
 template <typename T>
 auto yDs(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kDS));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kDS>());
 }
 
 template <typename T>
 auto eDs(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kDS));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kDS>());
 }
 
 template <typename T>
 auto invMassDsToKKPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 template <typename T>
 auto invMassDsToPiKK(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kKPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kKPlus>()});
 }
 
 // Λc± → p± K∓ π±
@@ -767,31 +767,31 @@ auto invMassDsToPiKK(const T& candidate)
 template <typename T>
 auto ctLc(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>());
 }
 
 template <typename T>
 auto yLc(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>());
 }
 
 template <typename T>
 auto eLc(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>());
 }
 
 template <typename T>
 auto invMassLcToPKPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kProton), RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<kProton>(), RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 template <typename T>
 auto invMassLcToPiKP(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kKPlus), RecoDecay::getMassPDG(kProton)});
+  return candidate.m(array{RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kKPlus>(), RecoDecay::getMassPDG<kProton>()});
 }
 
 // Ξc± → p± K∓ π±
@@ -799,19 +799,19 @@ auto invMassLcToPiKP(const T& candidate)
 template <typename T>
 auto ctXic(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kXiCPlus));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kXiCPlus>());
 }
 
 template <typename T>
 auto yXic(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kXiCPlus));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kXiCPlus>());
 }
 
 template <typename T>
 auto eXic(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kXiCPlus));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kXiCPlus>());
 }
 
 template <typename T>
@@ -926,7 +926,7 @@ auto eX(const T& candidate)
 template <typename T>
 auto invMassXToJpsiPiPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(443), RecoDecay::getMassPDG(kPiPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG(443), RecoDecay::getMassPDG<kPiPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 /// Difference between the X mass and the sum of the J/psi and di-pion masses
@@ -935,7 +935,7 @@ auto qX(const T& candidate)
 {
   auto piVec1 = array{candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()};
   auto piVec2 = array{candidate.pxProng2(), candidate.pyProng2(), candidate.pzProng2()};
-  double massPi = RecoDecay::getMassPDG(kPiPlus);
+  double massPi = RecoDecay::getMassPDG<kPiPlus>();
 
   auto arrayMomenta = array{piVec1, piVec2};
   double massPiPi = RecoDecay::m(arrayMomenta, array{massPi, massPi});
@@ -1111,25 +1111,25 @@ enum DecayType { XiccToXicPi = 0 }; // move this to a dedicated cascade namespac
 template <typename T>
 auto ctXicc(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kXiCCPlusPlus));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kXiCCPlusPlus>());
 }
 
 template <typename T>
 auto yXicc(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kXiCCPlusPlus));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kXiCCPlusPlus>());
 }
 
 template <typename T>
 auto eXicc(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kXiCCPlusPlus));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kXiCCPlusPlus>());
 }
 
 template <typename T>
 auto invMassXiccToXicPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kXiCPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<pdg::Code::kXiCPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 } // namespace hf_cand_xicc
 
@@ -1342,24 +1342,24 @@ enum DecayType { ChicToJpsiToEEGamma = 0,
 template <typename T>
 auto ctChic(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kChiC1));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kChiC1>());
 }
 
 template <typename T>
 auto yChic(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kChiC1));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kChiC1>());
 }
 
 template <typename T>
 auto eChic(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kChiC1));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kChiC1>());
 }
 template <typename T>
 auto invMassChicToJpsiGamma(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kJPsi), 0.});
+  return candidate.m(array{RecoDecay::getMassPDG<pdg::Code::kJPsi>(), 0.});
 }
 
 } // namespace hf_cand_chic
@@ -1431,28 +1431,28 @@ DECLARE_SOA_COLUMN(DebugMcRec, debugMcRec, int8_t);         // debug flag for mi
 enum DecayType { LbToLcPi }; // move this to a dedicated cascade namespace in the future?
 
 // Λb → Λc+ π- → p K- π+ π-
-// float massLb = RecoDecay::getMassPDG(pdg::Code::kLambdaB0);
+// float massLb = RecoDecay::getMassPDG<pdg::Code::kLambdaB0>();
 template <typename T>
 auto ctLb(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kLambdaB0));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kLambdaB0>());
 }
 
 template <typename T>
 auto yLb(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kLambdaB0));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kLambdaB0>());
 }
 
 template <typename T>
 auto eLb(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kLambdaB0));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kLambdaB0>());
 }
 template <typename T>
 auto invMassLbToLcPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>(), RecoDecay::getMassPDG<kPiPlus>()});
 }
 } // namespace hf_cand_lb
 
@@ -1523,31 +1523,31 @@ enum DecayType { B0ToDPi };
 template <typename T>
 auto ctB0(const T& candidate)
 {
-  return candidate.ct(RecoDecay::getMassPDG(pdg::Code::kB0));
+  return candidate.ct(RecoDecay::getMassPDG<pdg::Code::kB0>());
 }
 
 template <typename T>
 auto yB0(const T& candidate)
 {
-  return candidate.y(RecoDecay::getMassPDG(pdg::Code::kB0));
+  return candidate.y(RecoDecay::getMassPDG<pdg::Code::kB0>());
 }
 
 template <typename T>
 auto eB0(const T& candidate)
 {
-  return candidate.e(RecoDecay::getMassPDG(pdg::Code::kB0));
+  return candidate.e(RecoDecay::getMassPDG<pdg::Code::kB0>());
 }
 
 template <typename T>
 auto invMassB0ToDPi(const T& candidate)
 {
-  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kDMinus), RecoDecay::getMassPDG(kPiPlus)});
+  return candidate.m(array{RecoDecay::getMassPDG(pdg::Code::kDMinus), RecoDecay::getMassPDG<kPiPlus>()});
 }
 
 template <typename T>
 auto cosThetaStarB0(const T& candidate)
 {
-  return candidate.cosThetaStar(array{RecoDecay::getMassPDG(pdg::Code::kDMinus), RecoDecay::getMassPDG(kPiPlus)}, RecoDecay::getMassPDG(pdg::Code::kB0), 1);
+  return candidate.cosThetaStar(array{RecoDecay::getMassPDG(pdg::Code::kDMinus), RecoDecay::getMassPDG<kPiPlus>()}, RecoDecay::getMassPDG<pdg::Code::kB0>(), 1);
 }
 } // namespace hf_cand_b0
 
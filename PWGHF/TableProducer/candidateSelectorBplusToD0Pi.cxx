@@ -74,12 +74,12 @@ struct HfCandidateSelectorBplusToD0Pi {
 
     // D0 mass
     if (trackPi.sign() > 0) {
-      if (std::abs(invMassD0barToKPi(hfCandD0) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "DeltaMD0")) {
+      if (std::abs(invMassD0barToKPi(hfCandD0) - RecoDecay::getMassPDG<pdg::Code::kD0>()) > cuts->get(pTBin, "DeltaMD0")) {
         return false;
       }
     }
     if (trackPi.sign() < 0) {
-      if (std::abs(invMassD0ToPiK(hfCandD0) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "DeltaMD0")) {
+      if (std::abs(invMassD0ToPiK(hfCandD0) - RecoDecay::getMassPDG<pdg::Code::kD0>()) > cuts->get(pTBin, "DeltaMD0")) {
         return false;
       }
     }
@@ -157,11 +157,11 @@ struct HfCandidateSelectorD0Alice3Barrel {
 
     // invariant-mass cut
     if (trackPion.sign() > 0) {
-      if (std::abs(invMassD0ToPiK(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassD0ToPiK(candidate) - RecoDecay::getMassPDG<pdg::Code::kD0>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     } else {
-      if (std::abs(invMassD0barToKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kD0)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassD0barToKPi(candidate) - RecoDecay::getMassPDG<pdg::Code::kD0>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     }
@@ -125,11 +125,11 @@ struct HfCandidateSelectorLc {
     }
 
     if (trackProton.globalIndex() == candidate.prong0Id()) {
-      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     } else {
-      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     }
@@ -147,11 +147,11 @@ struct HfCandidateSelectorLcAlice3 {
     }
 
     if (trackProton.globalIndex() == candidate.prong0Id()) {
-      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     } else {
-      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) > cuts->get(pTBin, "m")) {
+      if (std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG<pdg::Code::kLambdaCPlus>()) > cuts->get(pTBin, "m")) {
         return false;
       }
     }
@@ -131,8 +131,8 @@ struct HfCandidateSelectorOmegac {
     selectorProton.setRangeNSigmaTOF(-nSigmaTofMax, nSigmaTofMax);
     selectorProton.setRangeNSigmaTOFCondTPC(-nSigmaTofCombinedMax, nSigmaTofCombinedMax);
 
-    double massLambdaFromPDG = RecoDecay::getMassPDG(kLambda0);
-    double massXiFromPDG = RecoDecay::getMassPDG(kXiMinus);
+    double massLambdaFromPDG = RecoDecay::getMassPDG<kLambda0>();
+    double massXiFromPDG = RecoDecay::getMassPDG<kXiMinus>();
 
     // looping over omegac candidates
     for (auto const& candidate : candidates) {
@@ -36,8 +36,12 @@
 #include "DetectorsBase/GeometryManager.h"     // for PV refit
 #include "DataFormatsParameters/GRPMagField.h" // for PV refit
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsPvRefit.h"
+#include "PWGHF/Utils/utilsVertexFitterPool.h"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
 
 using namespace o2;
 using namespace o2::framework;
@@ -299,6 +303,9 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
   int runNumber;
+  HfPvRefitContext pvRefitContext;
+  std::vector<int64_t> vecPvContributorGlobId;                    // global ID of PV contributors of the current collision
+  std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov; // TrackParCov of PV contributors of the current collision
 
   // single-track cuts
   static const int nCuts = 4;
@@ -398,66 +405,43 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     return true;
   }
 
-  /// Method for the PV refit and DCA recalculation for tracks with a collision assigned
+  /// Method to prepare the PV refit for a new collision
   /// \param collision is a collision
-  /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  void preparePvRefit(aod::Collision const& collision)
+  {
+    // set the magnetic field from CCDB
+    auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
+    initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+
+    /// retrieve PV contributors for the current collision
+    vecPvContributorGlobId.clear();
+    vecPvContributorTrackParCov.clear();
+    auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, collision.globalIndex());
+    for (const auto& contributor : pvContrCollision) {
+      vecPvContributorGlobId.push_back(contributor.globalIndex());
+      vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
+    }
+    if (debug) {
+      LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+    }
+
+    pvRefitContext.prepare(collision.globalIndex(), runNumber, getPrimaryVertex(collision), vecPvContributorGlobId, vecPvContributorTrackParCov);
+  }
+
+  /// Method for the PV refit and DCA recalculation for tracks with a collision assigned
+  /// \param collision is a collision, for which the PV refit context must be prepared
   /// \param myTrack is the track to be removed, if contributor, from the PV refit
   /// \param pvCoord is an array containing the coordinates of the refitted PV
   /// \param pvCovMatrix is an array containing the covariance matrix values of the refitted PV
   /// \param dcaXYdcaZ is an array containing the dcaXY and dcaZ of myTrack with respect to the refitted PV
   void performPvRefitTrack(aod::Collision const& collision,
-                           aod::BCsWithTimestamps const& bcWithTimeStamps,
-                           std::vector<int64_t> vecPvContributorGlobId,
-                           std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
                            BigTracks::iterator const& myTrack,
                            std::array<float, 3>& pvCoord,
                            std::array<float, 6>& pvCovMatrix,
                            std::array<float, 2>& dcaXYdcaZ)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
-    /// Prepare the vertex refitting
-    // set the magnetic field from CCDB
-    auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-    initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-    /*if (runNumber != bc.runNumber()) {
-
-      if (isRun2) { // Run 2 GRP object
-        o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(ccdbPathGrp, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", grpo->getNominalL3Field(), bc.runNumber());
-        } else {
-          LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      } else { // Run 3 GRP object
-        o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(ccdbPathGrpMag, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOG(info) << "Setting magnetic field to current" << grpo->getL3Current() << " A for run" << bc.runNumber() << " from its GRP CCDB object (type o2::parameters::GRPMagField)";
-        } else {
-          LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      }
-
-      runNumber = bc.runNumber();
-    }*/
-
-    // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
-    primVtx.setX(collision.posX());
-    primVtx.setY(collision.posY());
-    primVtx.setZ(collision.posZ());
-    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    const auto& primVtx = pvRefitContext.primaryVertex();
+    bool pvRefitDoable = pvRefitContext.isRefitDoable();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doPvRefit) {
@@ -465,7 +449,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       }
     }
     if (debug) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << pvRefitContext.nContributors() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
     }
 
     registry.fill(HIST("PvRefit/hVerticesPerTrack"), 1);
@@ -477,16 +461,11 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     bool recalcImpPar = false;
     if (doPvRefit && pvRefitDoable) {
       recalcImpPar = true;
-      auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myTrack.globalIndex()); /// track global index
-      if (trackIterator != vecPvContributorGlobId.end()) {
+      if (pvRefitContext.isContributor(myTrack.globalIndex())) {
 
         /// this track contributed to the PV fit: let's do the refit without it
-        const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-
-        vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-
-        auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
-        // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
+        int nExcluded = 0;
+        const auto& primVtxRefitted = pvRefitContext.refit(myTrack.globalIndex(), nExcluded); // vertex refit
         if (debug) {
           LOG(info) << "refit for track with global index " << (int)myTrack.globalIndex() << " " << primVtxRefitted.asString();
         }
@@ -504,8 +483,6 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         }
         registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
 
-        vecPvRefitContributorUsed[entry] = true; /// restore the track for the next PV refitting (probably not necessary here)
-
         if (recalcImpPar) {
           // fill the histograms for refitted PV with good Chi2
           const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -521,8 +498,6 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
           primVtxBaseRecalc.setZ(primVtxRefitted.getZ());
           primVtxBaseRecalc.setCov(primVtxRefitted.getSigmaX2(), primVtxRefitted.getSigmaXY(), primVtxRefitted.getSigmaY2(), primVtxRefitted.getSigmaXZ(), primVtxRefitted.getSigmaYZ(), primVtxRefitted.getSigmaZ2());
         }
-
-        // cnt++;
       }
     } /// end 'if (doPvRefit && pvRefitDoable)'
 
@@ -547,27 +522,6 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         dcaXYdcaZ[1] = dcaInfo[1]; // [cm]
         // TODO: add DCAxy and DCAz uncertainties?
       }
-
-      /// Track propagation to the PV refit done only ia geometrical way
-      /// Correct only if no further material budget is crossed, namely for tracks already propagated to the original PV
-      // o2::dataformats::DCA impactParameter;
-      // if (getTrackParCov(myTrack).propagateToDCA(primVtxBaseRecalc, o2::base::Propagator::Instance()->getNominalBz(), &impactParameter)) {
-      //   if (debug) {
-      //     LOG(info) << "===> nominal Bz: " << o2::base::Propagator::Instance()->getNominalBz();
-      //   }
-      //   pvCoord[0] = primVtxBaseRecalc.getX();
-      //   pvCoord[1] = primVtxBaseRecalc.getY();
-      //   pvCoord[2] = primVtxBaseRecalc.getZ();
-      //   pvCovMatrix[0] = primVtxBaseRecalc.getSigmaX2();
-      //   pvCovMatrix[1] = primVtxBaseRecalc.getSigmaXY();
-      //   pvCovMatrix[2] = primVtxBaseRecalc.getSigmaY2();
-      //   pvCovMatrix[3] = primVtxBaseRecalc.getSigmaXZ();
-      //   pvCovMatrix[4] = primVtxBaseRecalc.getSigmaYZ();
-      //   pvCovMatrix[5] = primVtxBaseRecalc.getSigmaZ2();
-      //   dcaXYdcaZ[0] = impactParameter.getY(); // [cm]
-      //   dcaXYdcaZ[1] = impactParameter.getZ();    // [cm]
-      //   // TODO: add DCAxy and DCAz uncertainties?
-      // }
     }
 
     return;
@@ -590,6 +544,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       LOG(info) << ">>> number of tracks: " << tracks.size();
       LOG(info) << ">>> number of collisions: " << collisions.size();
     }
+    // global indices restart in each dataframe
+    pvRefitContext.reset();
 
     for (auto& track : tracks) {
 
@@ -611,26 +567,18 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
 
       if (doPvRefit) {
         if (track.has_collision()) {
+          auto collision = track.collision();
 
-          /// retrieve PV contributors for the current collision
-          std::vector<int64_t> vecPvContributorGlobId = {};
-          std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
-
-          /// contributors for the current collision
-          auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, track.collision().globalIndex());
-          for (auto contributor : pvContrCollision) {
-            vecPvContributorGlobId.push_back(contributor.globalIndex());
-            vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
-          }
-          if (debug) {
-            LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << track.collision().numContrib();
+          /// prepare the PV refit once per collision (tracks are grouped by collision)
+          if (pvRefitContext.collisionId() != collision.globalIndex()) {
+            preparePvRefit(collision);
           }
 
           /// Perform the PV refit only for tracks with an assigned collision
           if (debug) {
-            LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << track.collision().globalIndex();
+            LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
           }
-          performPvRefitTrack(track.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, (BigTracks::iterator const&)track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
+          performPvRefitTrack(collision, (BigTracks::iterator const&)track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
         }
       }
       /// fill table with PV refit info
@@ -858,6 +806,9 @@ struct HfTrackIndexSkimCreator {
   Configurable<double> maxDZIni{"maxDZIni", 4., "reject (if>0) PCA candidate if tracks DZ exceeds threshold"};
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations if chi2/chi2old > this"};
+  Configurable<int> nThreadsVertexing{"nThreadsVertexing", 1, "number of threads for the 2-prong and 3-prong vertex fits (1: serial)"};
+  Configurable<int> minCombinationsPerThread{"minCombinationsPerThread", 50, "min. number of track combinations per thread to run the vertex fits in parallel"};
+  Configurable<int> maxCombinationsPerChunk{"maxCombinationsPerChunk", 10000, "max. number of preselected track combinations stored before running their vertex fits"};
   // CCDB
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> ccdbPathLut{"ccdbPathLut", "GLO/Param/MatLUT", "Path for LUT parametrization"};
@@ -892,6 +843,9 @@ struct HfTrackIndexSkimCreator {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
   int runNumber;
+  HfPvRefitContext pvRefitContext;
+  std::vector<int64_t> vecPvContributorGlobId;                    // global ID of PV contributors of the current collision
+  std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov; // TrackParCov of PV contributors of the current collision
 
   // int nColls{0}; //can be added to run over limited collisions per file - for tesing purposes
 
@@ -906,6 +860,42 @@ struct HfTrackIndexSkimCreator {
   std::array<std::vector<double>, n2ProngDecays> pTBins2Prong;
   std::array<LabeledArray<double>, n3ProngDecays> cut3Prong;
   std::array<std::vector<double>, n3ProngDecays> pTBins3Prong;
+  // union of the pT ranges of all 2-prong and 3-prong decay channels, used to prune the track combinations
+  double ptMinCand2Prong{0.};
+  double ptMaxCand2Prong{0.};
+  double ptMinCand3Prong{0.};
+  double ptMaxCand3Prong{0.};
+  static constexpr double ptMarginPool = 1.e-3; // safety margin (GeV/c) on the pT ranges of the track pools, to absorb rounding
+
+  /// Compact per-collision record of a selected track, used to build the 2-prong and 3-prong combinations
+  struct HfTrackPoolEntry {
+    int64_t index;                       // position of the track in the table of selected tracks of the collision
+    float px;                            // px at the PCA to the PV
+    float py;                            // py at the PCA to the PV
+    float pt;                            // pT at the PCA to the PV
+    int isSelProng;                      // bitmap of the single-track selections (see CandidateType)
+    o2::track::TrackParCov trackParCov;  // track parametrisation used for the secondary-vertex fit
+  };
+  std::vector<HfTrackPoolEntry> poolPos; // positive tracks, sorted by pT
+  std::vector<HfTrackPoolEntry> poolNeg; // negative tracks, sorted by pT
+
+  /// Track combination passing the preselections, with the outcome of its secondary-vertex fit
+  template <int NProngs, int NDecays, int NCuts>
+  struct HfCombination {
+    static constexpr int nProngs = NProngs;
+    std::array<const HfTrackPoolEntry*, NProngs> prongs;   // daughter tracks, in the order of the output table
+    int isSelected;                                        // bitmap with selection outcome
+    std::array<int, NDecays> whichHypo{};                  // mass hypotheses selected per decay channel
+    std::array<std::array<bool, NCuts>, NDecays> cutStatus{}; // outcome of each selection (filled only in debug mode)
+    bool isFitted{false};                                  // whether the secondary-vertex fit converged
+    std::array<double, 3> secondaryVertex{};               // secondary vertex
+    std::array<std::array<float, 3>, NProngs> pVecProngs{}; // daughter momenta at the secondary vertex
+  };
+  using HfCombination2Prong = HfCombination<2, n2ProngDecays, nCuts2Prong>;
+  using HfCombination3Prong = HfCombination<3, n3ProngDecays, nCuts3Prong>;
+  std::vector<HfCombination2Prong> combinations2Prong; // preselected 2-prong combinations of the current collision, not yet fitted
+  std::vector<HfCombination3Prong> combinations3Prong; // preselected 3-prong combinations of the current collision, not yet fitted
+  std::unique_ptr<HfVertexFitterPool> fitterPool;      // threads and fitters for the secondary-vertex fits
 
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HfSelCollision>>;
   using SelectedTracks = soa::Filtered<soa::Join<aod::BigTracks, aod::TracksDCA, aod::HfSelTrack, aod::HfPvRefitTrack>>;
@@ -913,10 +903,6 @@ struct HfTrackIndexSkimCreator {
   Filter filterSelectCollisions = (aod::hf_sel_collision::whyRejectColl == 0);
   Filter filterSelectTracks = aod::hf_sel_track::isSelProng > 0;
 
-  // FIXME
-  // Partition<SelectedTracks> tracksPos = aod::track::signed1Pt > 0.f;
-  // Partition<SelectedTracks> tracksNeg = aod::track::signed1Pt < 0.f;
-
   // QA of PV refit
   ConfigurableAxis axisPvRefitDeltaX{"axisPvRefitDeltaX", {1000, -0.5f, 0.5f}, "DeltaX binning PV refit"};
   ConfigurableAxis axisPvRefitDeltaY{"axisPvRefitDeltaY", {1000, -0.5f, 0.5f}, "DeltaY binning PV refit"};
@@ -975,6 +961,26 @@ struct HfTrackIndexSkimCreator {
     cut3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
     pTBins3Prong = {binsPtDplusToPiKPi, binsPtLcToPKPi, binsPtDsToKKPi, binsPtXicToPKPi};
 
+    // pT ranges accepted by at least one decay channel
+    ptMinCand2Prong = pTBins2Prong[0].front();
+    ptMaxCand2Prong = pTBins2Prong[0].back();
+    for (const auto& bins : pTBins2Prong) {
+      ptMinCand2Prong = std::min(ptMinCand2Prong, bins.front());
+      ptMaxCand2Prong = std::max(ptMaxCand2Prong, bins.back());
+    }
+    ptMinCand3Prong = pTBins3Prong[0].front();
+    ptMaxCand3Prong = pTBins3Prong[0].back();
+    for (const auto& bins : pTBins3Prong) {
+      ptMinCand3Prong = std::min(ptMinCand3Prong, bins.front());
+      ptMaxCand3Prong = std::max(ptMaxCand3Prong, bins.back());
+    }
+
+    // secondary-vertex fitters, configured once (the magnetic field is set at each new run)
+    fitterPool = std::make_unique<HfVertexFitterPool>();
+    fitterPool->start(nThreadsVertexing, [this](auto& fitter) { configureFitter(fitter); });
+    combinations2Prong.reserve(maxCombinationsPerChunk);
+    combinations3Prong.reserve(maxCombinationsPerChunk);
+
     // needed for PV refitting
     if (doPvRefit) {
       AxisSpec axisCollisionX{100, -20.f, 20.f, "X (cm)"};
@@ -1015,6 +1021,118 @@ struct HfTrackIndexSkimCreator {
     }
   }
 
+  /// Method to fill the pools of positive and negative tracks of the current collision
+  /// \param tracks is the table of selected tracks of the collision
+  /// \note Tracks with signed1Pt() == 0 are added to both pools, as in the unsorted loops.
+  template <typename T>
+  void fillTrackPools(T const& tracks)
+  {
+    poolPos.clear();
+    poolNeg.clear();
+    int64_t index = 0;
+    for (const auto& track : tracks) {
+      auto isSelProng = track.isSelProng();
+      if (TESTBIT(isSelProng, CandidateType::Cand2Prong) || TESTBIT(isSelProng, CandidateType::Cand3Prong)) {
+        HfTrackPoolEntry entry{index, track.pxProng(), track.pyProng(), static_cast<float>(RecoDecay::pt(track.pxProng(), track.pyProng())), isSelProng, getTrackParCov(track)};
+        if (track.signed1Pt() >= 0) {
+          poolPos.push_back(entry);
+        }
+        if (track.signed1Pt() <= 0) {
+          poolNeg.push_back(entry);
+        }
+      }
+      index++;
+    }
+    auto comparePt = [](HfTrackPoolEntry const& a, HfTrackPoolEntry const& b) { return a.pt < b.pt; };
+    std::stable_sort(poolPos.begin(), poolPos.end(), comparePt);
+    std::stable_sort(poolNeg.begin(), poolNeg.end(), comparePt);
+  }
+
+  /// Method to find the range of pool tracks that can pass the candidate pT preselection
+  /// when combined with a (system of) track(s) of transverse momentum ptOther,
+  /// using |pT(other) - pT(track)| <= pT(cand.) <= pT(other) + pT(track)
+  /// \param pool is a pool of tracks sorted by pT
+  /// \param ptOther is the pT of the track (system) the pool tracks are combined with
+  /// \param ptCandMin is the lowest candidate pT accepted by the preselections
+  /// \param ptCandMax is the highest candidate pT accepted by the preselections
+  /// \param first is the index of the first pool track to consider
+  /// \return pair of pool indices [begin, end)
+  std::pair<size_t, size_t> getPoolRangePt(std::vector<HfTrackPoolEntry> const& pool, double ptOther, double ptCandMin, double ptCandMax, size_t first = 0)
+  {
+    // the preselections accept ptCandMin <= pT(cand.) + ptTolerance < ptCandMax
+    double ptLow = std::max(ptCandMin - ptTolerance - ptOther, ptOther - ptCandMax + ptTolerance) - ptMarginPool;
+    double ptHigh = ptOther + ptCandMax - ptTolerance + ptMarginPool;
+    auto comparePt = [](HfTrackPoolEntry const& entry, double pt) { return entry.pt < pt; };
+    auto itLow = std::lower_bound(pool.begin() + std::min(first, pool.size()), pool.end(), ptLow, comparePt);
+    auto itHigh = std::lower_bound(itLow, pool.end(), ptHigh, comparePt);
+    return {static_cast<size_t>(std::distance(pool.begin(), itLow)), static_cast<size_t>(std::distance(pool.begin(), itHigh))};
+  }
+
+  /// Method to configure a secondary-vertex fitter, except for the magnetic field
+  /// \param fitter is a DCAFitterN
+  template <typename T>
+  void configureFitter(T& fitter)
+  {
+    fitter.setPropagateToPCA(propagateToPCA);
+    fitter.setMaxR(maxR);
+    fitter.setMaxDZIni(maxDZIni);
+    fitter.setMinParamChange(minParamChange);
+    fitter.setMinRelChi2Change(minRelChi2Change);
+    fitter.setUseAbsDCA(useAbsDCA);
+  }
+
+  /// Method to reconstruct the secondary vertex of a range of track combinations
+  /// \param fitter is a DCAFitterN with the same number of prongs as the combinations
+  /// \param combinations is a vector of track combinations
+  /// \param iFirst is the index of the first combination to fit
+  /// \param iLast is the index after the last combination to fit
+  template <typename TFitter, typename TCombination>
+  void fitCombinationRange(TFitter& fitter, std::vector<TCombination>& combinations, size_t iFirst, size_t iLast)
+  {
+    for (auto iComb = iFirst; iComb < iLast; ++iComb) {
+      auto& combination = combinations[iComb];
+      int nCand = 0;
+      if constexpr (TCombination::nProngs == 2) {
+        nCand = fitter.process(combination.prongs[0]->trackParCov, combination.prongs[1]->trackParCov);
+      } else {
+        nCand = fitter.process(combination.prongs[0]->trackParCov, combination.prongs[1]->trackParCov, combination.prongs[2]->trackParCov);
+      }
+      combination.isFitted = nCand > 0;
+      if (!combination.isFitted) {
+        continue;
+      }
+      const auto& secondaryVertex = fitter.getPCACandidate();
+      for (int iCoord = 0; iCoord < 3; iCoord++) {
+        combination.secondaryVertex[iCoord] = secondaryVertex[iCoord];
+      }
+      for (int iProng = 0; iProng < TCombination::nProngs; iProng++) {
+        fitter.getTrack(iProng).getPxPyPzGlo(combination.pVecProngs[iProng]);
+      }
+    }
+  }
+
+  /// Method to reconstruct the secondary vertices of a vector of track combinations
+  /// With nThreadsVertexing > 1, the combinations are split in contiguous ranges, fitted by the
+  /// threads of the pool with their own fitters. The results are stored in the combinations and used
+  /// afterwards in their original order, so the output does not depend on the number of threads.
+  /// \param combinations is a vector of 2-prong or 3-prong track combinations
+  template <typename TCombination>
+  void fitCombinations(std::vector<TCombination>& combinations)
+  {
+    size_t nCombinations = combinations.size();
+    int nTasks = std::clamp(static_cast<int>(nCombinations / std::max(1, minCombinationsPerThread.value)), 1, fitterPool->nThreads());
+    size_t nPerTask = (nCombinations + nTasks - 1) / nTasks;
+    fitterPool->run(nTasks, [&](int iTask, auto& df2, auto& df3) {
+      size_t iFirst = std::min(iTask * nPerTask, nCombinations);
+      size_t iLast = std::min((iTask + 1) * nPerTask, nCombinations);
+      if constexpr (TCombination::nProngs == 2) {
+        fitCombinationRange(df2, combinations, iFirst, iLast);
+      } else {
+        fitCombinationRange(df3, combinations, iFirst, iLast);
+      }
+    });
+  }
+
   /// Method to perform selections for 2-prong candidates before vertex reconstruction
   /// \param hfTrack0 is the first daughter track
   /// \param hfTrack1 is the second daughter track
@@ -1279,63 +1397,18 @@ struct HfTrackIndexSkimCreator {
   }
 
   /// Method for the PV refit excluding the candidate daughters
-  /// \param collision is a collision
-  /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  /// \param collision is a collision, for which the PV refit context must be prepared
   /// \param vecCandPvContributorGlobId is a vector containing the global indices of daughter tracks that contributed to the original PV refit
   /// \param pvCoord is a vector where to store X, Y and Z values of refitted PV
   /// \param pvCovMatrix is a vector where to store the covariance matrix values of refitted PV
-  void performPvRefitCandProngs(aod::Collision const& collision,
-                                aod::BCsWithTimestamps const& bcWithTimeStamps,
-                                std::vector<int64_t> vecPvContributorGlobId,
-                                std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
-                                std::vector<int64_t> vecCandPvContributorGlobId,
+  template <typename TCollision>
+  void performPvRefitCandProngs(TCollision const& collision,
+                                std::vector<int64_t> const& vecCandPvContributorGlobId,
                                 std::array<float, 3>& pvCoord,
                                 std::array<float, 6>& pvCovMatrix)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
-    /// Prepare the vertex refitting
-    // set the magnetic field from CCDB
-    auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-    initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-    /*if (runNumber != bc.runNumber()) {
-
-      if (isRun2) { // Run 2 GRP object
-        o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(ccdbPathGrp, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", grpo->getNominalL3Field(), bc.runNumber());
-        } else {
-          LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      } else { // Run 3 GRP object
-        o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(ccdbPathGrpMag, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOG(info) << "Setting magnetic field to current" << grpo->getL3Current() << " A for run" << bc.runNumber() << " from its GRP CCDB object (type o2::parameters::GRPMagField)";
-        } else {
-          LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      }
-
-      runNumber = bc.runNumber();
-    }*/
-
-    // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
-    primVtx.setX(collision.posX());
-    primVtx.setY(collision.posY());
-    primVtx.setZ(collision.posZ());
-    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    const auto& primVtx = pvRefitContext.primaryVertex();
+    bool pvRefitDoable = pvRefitContext.isRefitDoable();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doPvRefit) {
@@ -1343,7 +1416,7 @@ struct HfTrackIndexSkimCreator {
       }
     }
     if (debug) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << pvRefitContext.nContributors() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
     }
 
     // registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
@@ -1355,24 +1428,13 @@ struct HfTrackIndexSkimCreator {
     bool recalcPvRefit = false;
     if (doPvRefit && pvRefitDoable) {
       recalcPvRefit = true;
-      int nCandContr = 0;
-      for (uint64_t myGlobalID : vecCandPvContributorGlobId) {
-        auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myGlobalID); /// track global index
-        if (trackIterator != vecPvContributorGlobId.end()) {
-          /// this is a contributor, let's remove it for the PV refit
-          const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-          vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-          nCandContr++;
-        }
-      }
 
       /// do the PV refit excluding the candidate daughters that originally contributed to fit it
+      int nCandContr = 0;
+      const auto& primVtxRefitted = pvRefitContext.refit(vecCandPvContributorGlobId, nCandContr); // vertex refit
       if (debug) {
         LOG(info) << "### PV refit after removing " << nCandContr << " tracks";
       }
-      auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
-      // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
-      // LOG(info) << "refit for track with global index " << (int) myTrack.globalIndex() << " " << primVtxRefitted.asString();
       if (primVtxRefitted.getChi2() < 0) {
         if (debug) {
           LOG(info) << "---> Refitted vertex has bad chi2 = " << primVtxRefitted.getChi2();
@@ -1388,10 +1450,6 @@ struct HfTrackIndexSkimCreator {
       }
       registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
 
-      for (int i = 0; i < (int)vecPvContributorGlobId.size(); i++) {
-        vecPvRefitContributorUsed[i] = true; /// restore the tracks for the next PV refitting (probably not necessary here)
-      }
-
       if (recalcPvRefit) {
         // fill the histograms for refitted PV with good Chi2
         const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -1426,13 +1484,316 @@ struct HfTrackIndexSkimCreator {
       pvCovMatrix[4] = primVtxBaseRecalc.getSigmaYZ();
       pvCovMatrix[5] = primVtxBaseRecalc.getSigmaZ2();
 
-      // cnt++;
-
     } /// end 'if (doPvRefit && pvRefitDoable)'
 
     return;
   } /// end of performPvRefitCandProngs function
 
+  /// Method to reconstruct the secondary vertices of the stored 2-prong combinations, apply the
+  /// selections after the vertex reconstruction and fill the tables, in the order of the combinations.
+  /// The stored combinations are cleared afterwards.
+  /// \param collision is the current collision
+  /// \param tracks is the table of selected tracks of the collision
+  template <typename TCollision, typename TTracks>
+  void processCombinations2Prong(TCollision const& collision, TTracks const& tracks)
+  {
+    int nCutStatus2ProngBit = BIT(nCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
+
+    fitCombinations(combinations2Prong);
+
+    for (auto& combination : combinations2Prong) {
+      if (!combination.isFitted) {
+        continue;
+      }
+      auto trackPos1 = tracks.iteratorAt(combination.prongs[0]->index);
+      auto trackNeg1 = tracks.iteratorAt(combination.prongs[1]->index);
+      auto& cutStatus2Prong = combination.cutStatus;
+      auto& whichHypo2Prong = combination.whichHypo;
+      int& isSelected2ProngCand = combination.isSelected;
+      // get secondary vertex
+      const auto& secondaryVertex2 = combination.secondaryVertex;
+      // get track momenta
+      const auto& pvec0 = combination.pVecProngs[0];
+      const auto& pvec1 = combination.pVecProngs[1];
+
+      /// PV refit excluding the candidate daughters, if contributors
+      array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+      array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+      if (doPvRefit) {
+        registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+        int nCandContr = 2;
+        bool isTrackFirstContr = true;
+        bool isTrackSecondContr = true;
+        if (!pvRefitContext.isContributor(trackPos1.globalIndex())) {
+          /// This track did not contribute to the original PV refit
+          if (debug) {
+            LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+          }
+          nCandContr--;
+          isTrackFirstContr = false;
+        }
+        if (!pvRefitContext.isContributor(trackNeg1.globalIndex())) {
+          /// This track did not contribute to the original PV refit
+          if (debug) {
+            LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+          }
+          nCandContr--;
+          isTrackSecondContr = false;
+        }
+        if (nCandContr == 2) {
+          /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
+          if (debug) {
+            LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
+          }
+          performPvRefitCandProngs(collision, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
+        } else if (nCandContr == 1) {
+          /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+          if (debug) {
+            LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+          }
+          registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+          if (isTrackFirstContr && !isTrackSecondContr) {
+            /// the first daughter is contributor, the second is not
+            pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+            pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+          } else if (!isTrackFirstContr && isTrackSecondContr) {
+            ///  the second daughter is contributor, the first is not
+            pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+            pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+          }
+        } else {
+          /// 0 contributors among the HF candidate daughters
+          registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+          if (debug) {
+            LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+          }
+        }
+      }
+
+      auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
+      // 2-prong selections after secondary vertex
+      array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
+      if (doPvRefit) {
+        pvCoord2Prong[0] = pvRefitCoord2Prong[0];
+        pvCoord2Prong[1] = pvRefitCoord2Prong[1];
+        pvCoord2Prong[2] = pvRefitCoord2Prong[2];
+      }
+      is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
+
+      if (isSelected2ProngCand > 0) {
+        // fill table row
+        rowTrackIndexProng2(trackPos1.globalIndex(),
+                            trackNeg1.globalIndex(), isSelected2ProngCand);
+        // fill table row with coordinates of PV refit
+        rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
+                         pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
+
+        if (debug) {
+          int Prong2CutStatus[n2ProngDecays];
+          for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
+            Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit;
+            for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
+              if (!cutStatus2Prong[iDecay2P][iCut]) {
+                CLRBIT(Prong2CutStatus[iDecay2P], iCut);
+              }
+            }
+          }
+          rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]); // FIXME when we can do this by looping over n2ProngDecays
+        }
+
+        // fill histograms
+        if (fillHistograms) {
+          registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
+          registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
+          registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
+          array<array<float, 3>, 2> arrMom = {pvec0, pvec1};
+          for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
+            if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
+              if (whichHypo2Prong[iDecay2P] == 1 || whichHypo2Prong[iDecay2P] == 3) {
+                auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
+                switch (iDecay2P) {
+                  case hf_cand_2prong::DecayType::D0ToPiK:
+                    registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                    break;
+                  case hf_cand_2prong::DecayType::JpsiToEE:
+                    registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
+                    break;
+                  case hf_cand_2prong::DecayType::JpsiToMuMu:
+                    registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
+                    break;
+                }
+              }
+              if (whichHypo2Prong[iDecay2P] >= 2) {
+                auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
+                if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+                  registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+    combinations2Prong.clear();
+  }
+
+  /// Method to reconstruct the secondary vertices of the stored 3-prong combinations, apply the
+  /// selections after the vertex reconstruction and fill the tables, in the order of the combinations.
+  /// The stored combinations are cleared afterwards.
+  /// \param collision is the current collision
+  /// \param tracks is the table of selected tracks of the collision
+  template <typename TCollision, typename TTracks>
+  void processCombinations3Prong(TCollision const& collision, TTracks const& tracks)
+  {
+    int nCutStatus3ProngBit = BIT(nCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
+
+    fitCombinations(combinations3Prong);
+
+    for (auto& combination : combinations3Prong) {
+      if (!combination.isFitted) {
+        continue;
+      }
+      std::array tracksProng = {tracks.iteratorAt(combination.prongs[0]->index),
+                                tracks.iteratorAt(combination.prongs[1]->index),
+                                tracks.iteratorAt(combination.prongs[2]->index)};
+      auto& cutStatus3Prong = combination.cutStatus;
+      auto& whichHypo3Prong = combination.whichHypo;
+      int& isSelected3ProngCand = combination.isSelected;
+      // get secondary vertex
+      const auto& secondaryVertex3 = combination.secondaryVertex;
+      // get track momenta
+      const auto& pvec0 = combination.pVecProngs[0];
+      const auto& pvec1 = combination.pVecProngs[1];
+      const auto& pvec2 = combination.pVecProngs[2];
+
+      /// PV refit excluding the candidate daughters, if contributors
+      array<float, 3> pvRefitCoord3Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+      array<float, 6> pvRefitCovMatrix3Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+      if (doPvRefit) {
+        registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+
+        // Fill a vector with global ID of candidate daughters that are contributors
+        std::vector<int64_t> vecCandPvContributorGlobId = {};
+        int iProngContr = -1;
+        for (int iProng = 0; iProng < 3; iProng++) {
+          if (!pvRefitContext.isContributor(tracksProng[iProng].globalIndex())) {
+            /// This track did not contribute to the original PV refit
+            if (debug) {
+              LOG(info) << "--- [3 prong] prong " << iProng << " with globalIndex " << tracksProng[iProng].globalIndex() << " was not a PV contributor";
+            }
+            continue;
+          }
+          vecCandPvContributorGlobId.push_back(tracksProng[iProng].globalIndex());
+          iProngContr = iProng;
+        }
+        int nCandContr = vecCandPvContributorGlobId.size();
+
+        if (nCandContr == 3 || nCandContr == 2) {
+          /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+          if (debug) {
+            LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+          }
+          performPvRefitCandProngs(collision, vecCandPvContributorGlobId, pvRefitCoord3Prong, pvRefitCovMatrix3Prong);
+        } else if (nCandContr == 1) {
+          /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+          if (debug) {
+            LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+          }
+          registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+          const auto& trackContr = tracksProng[iProngContr];
+          pvRefitCoord3Prong = {trackContr.pvRefitX(), trackContr.pvRefitY(), trackContr.pvRefitZ()};
+          pvRefitCovMatrix3Prong = {trackContr.pvRefitSigmaX2(), trackContr.pvRefitSigmaXY(), trackContr.pvRefitSigmaY2(), trackContr.pvRefitSigmaXZ(), trackContr.pvRefitSigmaYZ(), trackContr.pvRefitSigmaZ2()};
+        } else {
+          /// 0 contributors among the HF candidate daughters
+          registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+          if (debug) {
+            LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+          }
+        }
+      }
+
+      auto pVecCandProng3 = RecoDecay::pVec(pvec0, pvec1, pvec2);
+      // 3-prong selections after secondary vertex
+      array<float, 3> pvCoord3Prong = {collision.posX(), collision.posY(), collision.posZ()};
+      if (doPvRefit) {
+        pvCoord3Prong[0] = pvRefitCoord3Prong[0];
+        pvCoord3Prong[1] = pvRefitCoord3Prong[1];
+        pvCoord3Prong[2] = pvRefitCoord3Prong[2];
+      }
+      is3ProngSelected(pVecCandProng3, secondaryVertex3, pvCoord3Prong, cutStatus3Prong, isSelected3ProngCand);
+      if (!debug && isSelected3ProngCand == 0) {
+        continue;
+      }
+
+      // fill table row
+      rowTrackIndexProng3(tracksProng[0].globalIndex(),
+                          tracksProng[1].globalIndex(),
+                          tracksProng[2].globalIndex(), isSelected3ProngCand);
+      // fill table row of coordinates of PV refit
+      rowProng3PVrefit(pvRefitCoord3Prong[0], pvRefitCoord3Prong[1], pvRefitCoord3Prong[2],
+                       pvRefitCovMatrix3Prong[0], pvRefitCovMatrix3Prong[1], pvRefitCovMatrix3Prong[2], pvRefitCovMatrix3Prong[3], pvRefitCovMatrix3Prong[4], pvRefitCovMatrix3Prong[5]);
+
+      if (debug) {
+        int Prong3CutStatus[n3ProngDecays];
+        for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
+          Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
+          for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
+            if (!cutStatus3Prong[iDecay3P][iCut]) {
+              CLRBIT(Prong3CutStatus[iDecay3P], iCut);
+            }
+          }
+        }
+        rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
+      }
+
+      // fill histograms
+      if (fillHistograms) {
+        registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
+        registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
+        registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
+        array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
+        for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
+          if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
+            if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
+              auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+              switch (iDecay3P) {
+                case hf_cand_3prong::DecayType::DplusToPiKPi:
+                  registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::DsToKKPi:
+                  registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::LcToPKPi:
+                  registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::XicToPKPi:
+                  registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                  break;
+              }
+            }
+            if (whichHypo3Prong[iDecay3P] >= 2) {
+              auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+              switch (iDecay3P) {
+                case hf_cand_3prong::DecayType::DsToKKPi:
+                  registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::LcToPKPi:
+                  registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                  break;
+                case hf_cand_3prong::DecayType::XicToPKPi:
+                  registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                  break;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    combinations3Prong.clear();
+  }
+
   void process( // soa::Join<aod::Collisions, aod::CentV0Ms>::iterator const& collision, //FIXME add centrality when option for variations to the process function appears
     SelectedCollisions::iterator const& collision,
     aod::Collisions const&,
@@ -1453,8 +1814,8 @@ struct HfTrackIndexSkimCreator {
     */
 
     /// retrieve PV contributors for the current collision
-    std::vector<int64_t> vecPvContributorGlobId = {};
-    std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
+    vecPvContributorGlobId.clear();
+    vecPvContributorTrackParCov.clear();
     if (doPvRefit) {
       const int nTrk = tracksUnfiltered.size();
       int nContrib = 0;
@@ -1481,648 +1842,157 @@ struct HfTrackIndexSkimCreator {
         }
       }
     }
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
     // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
 
     int n2ProngBit = BIT(n2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
     int n3ProngBit = BIT(n3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
 
-    bool cutStatus2Prong[n2ProngDecays][nCuts2Prong];
-    bool cutStatus3Prong[n3ProngDecays][nCuts3Prong];
-    int nCutStatus2ProngBit = BIT(nCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
-    int nCutStatus3ProngBit = BIT(nCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
-
-    int whichHypo2Prong[n2ProngDecays];
-    int whichHypo3Prong[n3ProngDecays];
-
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+    fitterPool->setBz(o2::base::Propagator::Instance()->getNominalBz());
 
-    // 2-prong vertex fitter
-    o2::vertexing::DCAFitterN<2> df2;
-    df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
-    df2.setPropagateToPCA(propagateToPCA);
-    df2.setMaxR(maxR);
-    df2.setMaxDZIni(maxDZIni);
-    df2.setMinParamChange(minParamChange);
-    df2.setMinRelChi2Change(minRelChi2Change);
-    df2.setUseAbsDCA(useAbsDCA);
-
-    // 3-prong vertex fitter
-    o2::vertexing::DCAFitterN<3> df3;
-    df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
-    df3.setPropagateToPCA(propagateToPCA);
-    df3.setMaxR(maxR);
-    df3.setMaxDZIni(maxDZIni);
-    df3.setMinParamChange(minParamChange);
-    df3.setMinRelChi2Change(minRelChi2Change);
-    df3.setUseAbsDCA(useAbsDCA);
+    // prepare the PV refit once for all the candidates of this collision
+    if (doPvRefit) {
+      pvRefitContext.prepare(collision.globalIndex(), runNumber, getPrimaryVertex(collision), vecPvContributorGlobId, vecPvContributorTrackParCov);
+    }
 
     // used to calculate number of candidiates per event
     auto nCand2 = rowTrackIndexProng2.lastIndex();
     auto nCand3 = rowTrackIndexProng3.lastIndex();
 
-    // if there isn't at least a positive and a negative track, continue immediately
-    // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
-    //  return;
-    //}
+    // fill the pT-sorted pools of positive and negative tracks
+    fillTrackPools(tracks);
+
+    // collect the track combinations passing the preselections, fitted and selected further
+    // each time maxCombinationsPerChunk of them are stored
+    combinations2Prong.clear();
+    combinations3Prong.clear();
+    const size_t maxCombinations = std::max(1, maxCombinationsPerChunk.value);
 
     // first loop over positive tracks
-    // for (auto trackPos1 = tracksPos.begin(); trackPos1 != tracksPos.end(); ++trackPos1) {
-    for (auto trackPos1 = tracks.begin(); trackPos1 != tracks.end(); ++trackPos1) {
-      if (trackPos1.signed1Pt() < 0) {
-        continue;
-      }
-      bool sel2ProngStatusPos = TESTBIT(trackPos1.isSelProng(), CandidateType::Cand2Prong);
-      bool sel3ProngStatusPos1 = TESTBIT(trackPos1.isSelProng(), CandidateType::Cand3Prong);
+    for (size_t iPos1 = 0; iPos1 < poolPos.size(); ++iPos1) {
+      const auto& hfTrackPos1 = poolPos[iPos1];
+      bool sel2ProngStatusPos = TESTBIT(hfTrackPos1.isSelProng, CandidateType::Cand2Prong);
+      bool sel3ProngStatusPos1 = TESTBIT(hfTrackPos1.isSelProng, CandidateType::Cand3Prong);
       if (!sel2ProngStatusPos && !sel3ProngStatusPos1) {
         continue;
       }
 
-      auto trackParVarPos1 = getTrackParCov(trackPos1);
+      auto trackPos1 = tracks.iteratorAt(hfTrackPos1.index);
+
+      // negative tracks which can pass the 2-prong pT preselection with this positive track
+      auto [iNeg2ProngBegin, iNeg2ProngEnd] = getPoolRangePt(poolNeg, hfTrackPos1.pt, ptMinCand2Prong, ptMaxCand2Prong);
+      // 3-prong candidates constrain only the third track, so all the negative tracks are needed
+      size_t iNegBegin = iNeg2ProngBegin;
+      size_t iNegEnd = iNeg2ProngEnd;
+      if (do3Prong == 1 && sel3ProngStatusPos1) {
+        iNegBegin = 0;
+        iNegEnd = poolNeg.size();
+      }
 
       // first loop over negative tracks
-      // for (auto trackNeg1 = tracksNeg.begin(); trackNeg1 != tracksNeg.end(); ++trackNeg1) {
-      for (auto trackNeg1 = tracks.begin(); trackNeg1 != tracks.end(); ++trackNeg1) {
-        if (trackNeg1.signed1Pt() > 0) {
-          continue;
-        }
-        bool sel2ProngStatusNeg = TESTBIT(trackNeg1.isSelProng(), CandidateType::Cand2Prong);
-        bool sel3ProngStatusNeg1 = TESTBIT(trackNeg1.isSelProng(), CandidateType::Cand3Prong);
-        if (!sel2ProngStatusNeg && !sel3ProngStatusNeg1) {
+      for (size_t iNeg1 = iNegBegin; iNeg1 < iNegEnd; ++iNeg1) {
+        const auto& hfTrackNeg1 = poolNeg[iNeg1];
+        bool sel2ProngStatusNeg = TESTBIT(hfTrackNeg1.isSelProng, CandidateType::Cand2Prong) && iNeg1 >= iNeg2ProngBegin && iNeg1 < iNeg2ProngEnd;
+        bool sel3ProngStatusNeg1 = TESTBIT(hfTrackNeg1.isSelProng, CandidateType::Cand3Prong);
+        if (!(sel2ProngStatusPos && sel2ProngStatusNeg) && !(do3Prong == 1 && sel3ProngStatusPos1 && sel3ProngStatusNeg1)) {
           continue;
         }
 
-        auto trackParVarNeg1 = getTrackParCov(trackNeg1);
+        auto trackNeg1 = tracks.iteratorAt(hfTrackNeg1.index);
 
-        int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
-
-        if (debug) {
-          for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-            for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
-              cutStatus2Prong[iDecay2P][iCut] = true;
+        // 2-prong preselections
+        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+          HfCombination2Prong combination{{&hfTrackPos1, &hfTrackNeg1}, n2ProngBit}; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+          if (debug) {
+            for (auto& cutStatus : combination.cutStatus) {
+              cutStatus.fill(true);
             }
           }
-        }
-
-        // 2-prong vertex reconstruction
-        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
-
-          // 2-prong preselections
           // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
-          is2ProngPreselected(trackPos1, trackNeg1, cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand);
-
-          // secondary vertex reconstruction and further 2-prong selections
-          if (isSelected2ProngCand > 0 && df2.process(trackParVarPos1, trackParVarNeg1) > 0) { // should it be this or > 0 or are they equivalent
-            // get secondary vertex
-            const auto& secondaryVertex2 = df2.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            df2.getTrack(0).getPxPyPzGlo(pvec0);
-            df2.getTrack(1).getPxPyPzGlo(pvec1);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 2;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
-              }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
-              }
-              if (nCandContr == 2) {
-                /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr) {
-                  /// the first daughter is contributor, the second is not
-                  pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr) {
-                  ///  the second daughter is contributor, the first is not
-                  pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                }
-              }
-            }
-
-            auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
-            // 2-prong selections after secondary vertex
-            array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord2Prong[0] = pvRefitCoord2Prong[0];
-              pvCoord2Prong[1] = pvRefitCoord2Prong[1];
-              pvCoord2Prong[2] = pvRefitCoord2Prong[2];
-            }
-            is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
-
-            if (isSelected2ProngCand > 0) {
-              // fill table row
-              rowTrackIndexProng2(trackPos1.globalIndex(),
-                                  trackNeg1.globalIndex(), isSelected2ProngCand);
-              // fill table row with coordinates of PV refit
-              rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                               pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-
-              if (debug) {
-                int Prong2CutStatus[n2ProngDecays];
-                for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-                  Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit;
-                  for (int iCut = 0; iCut < nCuts2Prong; iCut++) {
-                    if (!cutStatus2Prong[iDecay2P][iCut]) {
-                      CLRBIT(Prong2CutStatus[iDecay2P], iCut);
-                    }
-                  }
-                }
-                rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]); // FIXME when we can do this by looping over n2ProngDecays
-              }
-
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
-                registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
-                registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
-                array<array<float, 3>, 2> arrMom = {pvec0, pvec1};
-                for (int iDecay2P = 0; iDecay2P < n2ProngDecays; iDecay2P++) {
-                  if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
-                    if (whichHypo2Prong[iDecay2P] == 1 || whichHypo2Prong[iDecay2P] == 3) {
-                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
-                      switch (iDecay2P) {
-                        case hf_cand_2prong::DecayType::D0ToPiK:
-                          registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                          break;
-                        case hf_cand_2prong::DecayType::JpsiToEE:
-                          registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
-                          break;
-                        case hf_cand_2prong::DecayType::JpsiToMuMu:
-                          registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
-                          break;
-                      }
-                    }
-                    if (whichHypo2Prong[iDecay2P] >= 2) {
-                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
-                      if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
-                        registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                      }
-                    }
-                  }
-                }
-              }
+          is2ProngPreselected(trackPos1, trackNeg1, combination.cutStatus, combination.whichHypo, combination.isSelected);
+          if (combination.isSelected > 0) {
+            combinations2Prong.push_back(combination);
+            if (combinations2Prong.size() >= maxCombinations) {
+              processCombinations2Prong(collision, tracks);
             }
           }
         }
 
-        // 3-prong vertex reconstruction
+        // 3-prong preselections
         if (do3Prong == 1) {
           if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
             continue;
           }
 
-          if (tracks.size() < 2) {
-            continue;
-          }
+          // pT of the pair of the first two daughters, used to restrict the range of the third one
+          auto ptPair = RecoDecay::pt(hfTrackPos1.px + hfTrackNeg1.px, hfTrackPos1.py + hfTrackNeg1.py);
+
           // second loop over positive tracks
-          // for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracksPos.end(); ++trackPos2) {
-          for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracks.end(); ++trackPos2) {
-            if (trackPos2.signed1Pt() < 0) {
+          // in debug mode, also the candidates rejected by the preselections are stored, hence no pruning
+          auto [iPos2Begin, iPos2End] = debug ? std::pair<size_t, size_t>{iPos1 + 1, poolPos.size()} : getPoolRangePt(poolPos, ptPair, ptMinCand3Prong, ptMaxCand3Prong, iPos1 + 1);
+          for (size_t iPos2 = iPos2Begin; iPos2 < iPos2End; ++iPos2) {
+            const auto& hfTrackPos2 = poolPos[iPos2];
+            if (!TESTBIT(hfTrackPos2.isSelProng, CandidateType::Cand3Prong)) {
               continue;
             }
-            if (!TESTBIT(trackPos2.isSelProng(), CandidateType::Cand3Prong)) {
-              continue;
-            }
-
-            int isSelected3ProngCand = n3ProngBit;
+            // the same-sign daughters are stored in the order of the table (as prong 0 and prong 2), independently of their pT order in the pool
+            auto [hfTrackProng0, hfTrackProng2] = hfTrackPos1.index < hfTrackPos2.index ? std::pair{&hfTrackPos1, &hfTrackPos2} : std::pair{&hfTrackPos2, &hfTrackPos1};
+            auto trackProng0 = tracks.iteratorAt(hfTrackProng0->index);
+            auto trackProng2 = tracks.iteratorAt(hfTrackProng2->index);
 
+            HfCombination3Prong combination{{hfTrackProng0, &hfTrackNeg1, hfTrackProng2}, n3ProngBit};
             if (debug) {
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  cutStatus3Prong[iDecay3P][iCut] = true;
-                }
-              }
-            }
-
-            // 3-prong preselections
-            is3ProngPreselected(trackPos1, trackNeg1, trackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
-
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarPos2 = getTrackParCov(trackPos2);
-            if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
-              continue;
-            }
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix3Prong2Pos1Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 3;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              bool isTrackThirdContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
-              }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
-              }
-              if (it_third_trk == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackThirdContr = false;
-              }
-
-              // Fill a vector with global ID of candidate daughters that are contributors
-              std::vector<int64_t> vecCandPvContributorGlobId = {};
-              if (isTrackFirstContr) {
-                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
-              }
-              if (isTrackSecondContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
-              }
-              if (isTrackThirdContr) {
-                vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
+              for (auto& cutStatus : combination.cutStatus) {
+                cutStatus.fill(true);
               }
-
-              if (nCandContr == 3 || nCandContr == 2) {
-                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                  /// the first daughter is contributor, the second and the third are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                  /// the second daughter is contributor, the first and the third are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                  /// the third daughter is contributor, the first and the second are not
-                  pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
-                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
-                }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                }
-              }
-            }
-
-            auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
-            // 3-prong selections after secondary vertex
-            array<float, 3> pvCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord3Prong2Pos1Neg[0] = pvRefitCoord3Prong2Pos1Neg[0];
-              pvCoord3Prong2Pos1Neg[1] = pvRefitCoord3Prong2Pos1Neg[1];
-              pvCoord3Prong2Pos1Neg[2] = pvRefitCoord3Prong2Pos1Neg[2];
             }
-            is3ProngSelected(pVecCandProng3Pos, secondaryVertex3, pvCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
+            is3ProngPreselected(trackProng0, trackNeg1, trackProng2, combination.cutStatus, combination.whichHypo, combination.isSelected);
+            if (!debug && combination.isSelected == 0) {
               continue;
             }
-
-            // fill table row
-            rowTrackIndexProng3(trackPos1.globalIndex(),
-                                trackNeg1.globalIndex(),
-                                trackPos2.globalIndex(), isSelected3ProngCand);
-            // fill table row of coordinates of PV refit
-            rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
-                             pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
-
-            if (debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  if (!cutStatus3Prong[iDecay3P][iCut]) {
-                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                  }
-                }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
-            }
-
-            // fill histograms
-            if (fillHistograms) {
-              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DplusToPiKPi:
-                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
-                  }
-                  if (whichHypo3Prong[iDecay3P] >= 2) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
-                  }
-                }
-              }
+            combinations3Prong.push_back(combination);
+            if (combinations3Prong.size() >= maxCombinations) {
+              processCombinations3Prong(collision, tracks);
             }
           }
 
           // second loop over negative tracks
-          // for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracksNeg.end(); ++trackNeg2) {
-          for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracks.end(); ++trackNeg2) {
-            if (trackNeg2.signed1Pt() > 0) {
-              continue;
-            }
-            if (!TESTBIT(trackNeg2.isSelProng(), CandidateType::Cand3Prong)) {
+          auto [iNeg2Begin, iNeg2End] = debug ? std::pair<size_t, size_t>{iNeg1 + 1, poolNeg.size()} : getPoolRangePt(poolNeg, ptPair, ptMinCand3Prong, ptMaxCand3Prong, iNeg1 + 1);
+          for (size_t iNeg2 = iNeg2Begin; iNeg2 < iNeg2End; ++iNeg2) {
+            const auto& hfTrackNeg2 = poolNeg[iNeg2];
+            if (!TESTBIT(hfTrackNeg2.isSelProng, CandidateType::Cand3Prong)) {
               continue;
             }
+            // the same-sign daughters are stored in the order of the table (as prong 0 and prong 2), independently of their pT order in the pool
+            auto [hfTrackProng0, hfTrackProng2] = hfTrackNeg1.index < hfTrackNeg2.index ? std::pair{&hfTrackNeg1, &hfTrackNeg2} : std::pair{&hfTrackNeg2, &hfTrackNeg1};
+            auto trackProng0 = tracks.iteratorAt(hfTrackProng0->index);
+            auto trackProng2 = tracks.iteratorAt(hfTrackProng2->index);
 
-            int isSelected3ProngCand = n3ProngBit;
-
+            HfCombination3Prong combination{{hfTrackProng0, &hfTrackPos1, hfTrackProng2}, n3ProngBit};
             if (debug) {
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  cutStatus3Prong[iDecay3P][iCut] = true;
-                }
+              for (auto& cutStatus : combination.cutStatus) {
+                cutStatus.fill(true);
               }
             }
-
-            // 3-prong preselections
-            is3ProngPreselected(trackNeg1, trackPos1, trackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
+            is3ProngPreselected(trackProng0, trackPos1, trackProng2, combination.cutStatus, combination.whichHypo, combination.isSelected);
+            if (!debug && combination.isSelected == 0) {
               continue;
             }
-
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-            if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
-              continue;
-            }
-
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            /// PV refit excluding the candidate daughters, if contributors
-            array<float, 3> pvRefitCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-            array<float, 6> pvRefitCovMatrix3Prong1Pos2Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-            if (doPvRefit) {
-              registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-              int nCandContr = 3;
-              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-              auto it_third_trk = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
-              bool isTrackFirstContr = true;
-              bool isTrackSecondContr = true;
-              bool isTrackThirdContr = true;
-              if (trackFirstIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackFirstContr = false;
-              }
-              if (trackSecondIt == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackSecondContr = false;
-              }
-              if (it_third_trk == vecPvContributorGlobId.end()) {
-                /// This track did not contribute to the original PV refit
-                if (debug) {
-                  LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
-                }
-                nCandContr--;
-                isTrackThirdContr = false;
-              }
-
-              // Fill a vector with global ID of candidate daughters that are contributors
-              std::vector<int64_t> vecCandPvContributorGlobId = {};
-              if (isTrackFirstContr) {
-                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
-              }
-              if (isTrackSecondContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
-              }
-              if (isTrackThirdContr) {
-                vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
-              }
-
-              if (nCandContr == 3 || nCandContr == 2) {
-                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                if (debug) {
-                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                }
-                performPvRefitCandProngs((aod::Collision const&)trackPos1.collision(), bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
-              } else if (nCandContr == 1) {
-                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                if (debug) {
-                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                }
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                  /// the first daughter is contributor, the second and the third are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                  /// the second daughter is contributor, the first and the third are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                  /// the third daughter is contributor, the first and the second are not
-                  pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
-                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
-                }
-              } else {
-                /// 0 contributors among the HF candidate daughters
-                registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                if (debug) {
-                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                }
-              }
-            }
-
-            auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
-            // 3-prong selections after secondary vertex
-            array<float, 3> pvCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()};
-            if (doPvRefit) {
-              pvCoord3Prong1Pos2Neg[0] = pvRefitCoord3Prong1Pos2Neg[0];
-              pvCoord3Prong1Pos2Neg[1] = pvRefitCoord3Prong1Pos2Neg[1];
-              pvCoord3Prong1Pos2Neg[2] = pvRefitCoord3Prong1Pos2Neg[2];
-            }
-            is3ProngSelected(pVecCandProng3Neg, secondaryVertex3, pvCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
-            if (!debug && isSelected3ProngCand == 0) {
-              continue;
-            }
-
-            // fill table row
-            rowTrackIndexProng3(trackNeg1.globalIndex(),
-                                trackPos1.globalIndex(),
-                                trackNeg2.globalIndex(), isSelected3ProngCand);
-            // fill table row of coordinates of PV refit
-            rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
-                             pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
-
-            if (debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                for (int iCut = 0; iCut < nCuts3Prong; iCut++) {
-                  if (!cutStatus3Prong[iDecay3P][iCut]) {
-                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                  }
-                }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over n3ProngDecays
-            }
-
-            // fill histograms
-            if (fillHistograms) {
-              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-              for (int iDecay3P = 0; iDecay3P < n3ProngDecays; iDecay3P++) {
-                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DplusToPiKPi:
-                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
-                  }
-                  if (whichHypo3Prong[iDecay3P] >= 2) {
-                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                    switch (iDecay3P) {
-                      case hf_cand_3prong::DecayType::DsToKKPi:
-                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::LcToPKPi:
-                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                        break;
-                      case hf_cand_3prong::DecayType::XicToPKPi:
-                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                        break;
-                    }
-                  }
-                }
-              }
+            combinations3Prong.push_back(combination);
+            if (combinations3Prong.size() >= maxCombinations) {
+              processCombinations3Prong(collision, tracks);
             }
           }
         }
       }
     }
 
+    // secondary-vertex reconstruction (possibly in parallel) and further selections of the remaining combinations
+    processCombinations2Prong(collision, tracks);
+    processCombinations3Prong(collision, tracks);
+
     auto nTracks = tracks.size();                      // number of tracks passing 2 and 3 prong selection in this collision
     nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
     nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
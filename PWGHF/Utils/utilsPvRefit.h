@@ -0,0 +1,166 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsPvRefit.h
+/// \brief Utility to refit the primary vertex excluding some of its contributors
+///
+/// The PVertexer is configured once and prepared once per collision, then queried
+/// for any set of excluded contributors (leave-one-out for single tracks, leave-N-out
+/// for candidate daughters). Refits for a set of excluded contributors already
+/// queried in the same collision are served from a cache.
+
+#ifndef PWGHF_UTILS_UTILSPVREFIT_H_
+#define PWGHF_UTILS_UTILSPVREFIT_H_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "CommonUtils/ConfigurableParam.h"
+#include "DetectorsVertexing/PVertexer.h"
+#include "ReconstructionDataFormats/PrimaryVertex.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "ReconstructionDataFormats/Vertex.h"
+
+/// \brief Per-collision context for the primary-vertex refit
+class HfPvRefitContext
+{
+ public:
+  HfPvRefitContext() = default;
+
+  /// Prepares the refit for a new collision
+  /// \param collisionId is the global index of the collision
+  /// \param runNumber is the run number, used to re-initialise the vertexer (B field) when it changes
+  /// \param primVtx is the original primary vertex
+  /// \param pvContributorGlobId is a vector containing the global ID of PV contributors for the collision
+  /// \param pvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the collision
+  /// \return true if the PV refit is doable
+  bool prepare(int64_t collisionId, int runNumber,
+               o2::dataformats::VertexBase const& primVtx,
+               std::vector<int64_t> const& pvContributorGlobId,
+               std::vector<o2::track::TrackParCov> const& pvContributorTrackParCov)
+  {
+    if (runNumber != mRunNumber) {
+      // the vertexer takes the B field from the propagator at initialisation
+      o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
+      mVertexer.init();
+      mRunNumber = runNumber;
+    }
+
+    mCollisionId = collisionId;
+    mPrimVtx = primVtx;
+    mNContributors = pvContributorGlobId.size();
+    mCache.clear();
+
+    // contributors sorted by global index, for a binary search of the entry in the vertexer
+    mContributorEntries.clear();
+    mContributorEntries.reserve(mNContributors);
+    for (size_t iEntry = 0; iEntry < mNContributors; ++iEntry) {
+      mContributorEntries.emplace_back(pvContributorGlobId[iEntry], static_cast<int>(iEntry));
+    }
+    std::sort(mContributorEntries.begin(), mContributorEntries.end());
+    mIsContributorUsed.assign(mNContributors, true);
+
+    mIsRefitDoable = mVertexer.prepareVertexRefit(pvContributorTrackParCov, mPrimVtx);
+    return mIsRefitDoable;
+  }
+
+  /// Forgets the current collision, e.g. at the beginning of a new dataframe where global indices restart
+  void reset()
+  {
+    mCollisionId = -1;
+    mIsRefitDoable = false;
+    mCache.clear();
+  }
+
+  /// \return global index of the collision the context is prepared for (-1 if none)
+  int64_t collisionId() const { return mCollisionId; }
+
+  /// \return whether the PV refit is doable for the current collision
+  bool isRefitDoable() const { return mIsRefitDoable; }
+
+  /// \return number of PV contributors of the current collision
+  size_t nContributors() const { return mNContributors; }
+
+  /// \return original primary vertex of the current collision
+  o2::dataformats::VertexBase const& primaryVertex() const { return mPrimVtx; }
+
+  /// \param globalIndex is a track global index
+  /// \return entry of the track among the PV contributors, -1 if the track is not a contributor
+  int contributorEntry(int64_t globalIndex) const
+  {
+    auto it = std::lower_bound(mContributorEntries.begin(), mContributorEntries.end(), std::make_pair(globalIndex, -1));
+    if (it == mContributorEntries.end() || it->first != globalIndex) {
+      return -1;
+    }
+    return it->second;
+  }
+
+  /// \param globalIndex is a track global index
+  /// \return true if the track contributed to the original PV fit
+  bool isContributor(int64_t globalIndex) const { return contributorEntry(globalIndex) >= 0; }
+
+  /// Refits the primary vertex without the given tracks
+  /// \param excludedGlobId is a vector containing the global indices of the tracks to be removed, if contributors
+  /// \param nExcluded is the number of tracks actually removed from the fit
+  /// \return refitted primary vertex (only meaningful if isRefitDoable())
+  o2::dataformats::PrimaryVertex const& refit(std::vector<int64_t> const& excludedGlobId, int& nExcluded)
+  {
+    std::vector<int> excludedEntries;
+    excludedEntries.reserve(excludedGlobId.size());
+    for (const auto& globalIndex : excludedGlobId) {
+      auto entry = contributorEntry(globalIndex);
+      if (entry >= 0) {
+        excludedEntries.push_back(entry);
+      }
+    }
+    std::sort(excludedEntries.begin(), excludedEntries.end());
+    excludedEntries.erase(std::unique(excludedEntries.begin(), excludedEntries.end()), excludedEntries.end());
+    nExcluded = excludedEntries.size();
+
+    auto itCache = mCache.find(excludedEntries);
+    if (itCache != mCache.end()) {
+      return itCache->second;
+    }
+
+    for (const auto& entry : excludedEntries) {
+      mIsContributorUsed[entry] = false; /// remove the track from the PV refitting
+    }
+    auto primVtxRefitted = mVertexer.refitVertex(mIsContributorUsed, mPrimVtx); // vertex refit
+    for (const auto& entry : excludedEntries) {
+      mIsContributorUsed[entry] = true; /// restore the track for the next PV refitting
+    }
+    return mCache.emplace(std::move(excludedEntries), primVtxRefitted).first->second;
+  }
+
+  /// Refits the primary vertex without a single track
+  /// \param globalIndex is the global index of the track to be removed, if contributor
+  /// \param nExcluded is the number of tracks actually removed from the fit (0 or 1)
+  /// \return refitted primary vertex (only meaningful if isRefitDoable())
+  o2::dataformats::PrimaryVertex const& refit(int64_t globalIndex, int& nExcluded)
+  {
+    return refit(std::vector<int64_t>{globalIndex}, nExcluded);
+  }
+
+ private:
+  o2::vertexing::PVertexer mVertexer;                          ///< vertexer, initialised once per run
+  int mRunNumber{-1};                                          ///< run number the vertexer is initialised for
+  int64_t mCollisionId{-1};                                    ///< global index of the current collision
+  bool mIsRefitDoable{false};                                  ///< whether the refit is doable for the current collision
+  size_t mNContributors{0};                                    ///< number of PV contributors of the current collision
+  o2::dataformats::VertexBase mPrimVtx;                        ///< original primary vertex of the current collision
+  std::vector<std::pair<int64_t, int>> mContributorEntries;    ///< (global index, entry in the vertexer) of the PV contributors, sorted by global index
+  std::vector<bool> mIsContributorUsed;                        ///< flags of the contributors used in the refit
+  std::map<std::vector<int>, o2::dataformats::PrimaryVertex> mCache; ///< refitted vertices per set of excluded contributor entries
+};
+
+#endif // PWGHF_UTILS_UTILSPVREFIT_H_
@@ -0,0 +1,181 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsVertexFitterPool.h
+/// \brief Persistent pool of threads running secondary-vertex fits
+///
+/// Each thread owns a 2-prong and a 3-prong DCA fitter, configured once when the pool is
+/// started; only the magnetic field is updated afterwards. The threads are created once and
+/// wait between the batches of fits, so that no thread is created per collision. The calling
+/// thread takes part in each batch with its own fitters.
+
+#ifndef PWGHF_UTILS_UTILSVERTEXFITTERPOOL_H_
+#define PWGHF_UTILS_UTILSVERTEXFITTERPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DetectorsVertexing/DCAFitterN.h"
+
+/// \brief Pool of threads with their own secondary-vertex fitters
+class HfVertexFitterPool
+{
+ public:
+  using Fitter2Prong = o2::vertexing::DCAFitterN<2>;
+  using Fitter3Prong = o2::vertexing::DCAFitterN<3>;
+  /// task of a batch: (task index, 2-prong fitter, 3-prong fitter) of the thread running it
+  using Task = std::function<void(int, Fitter2Prong&, Fitter3Prong&)>;
+
+  HfVertexFitterPool() = default;
+  HfVertexFitterPool(const HfVertexFitterPool&) = delete;
+  HfVertexFitterPool& operator=(const HfVertexFitterPool&) = delete;
+  ~HfVertexFitterPool() { stop(); }
+
+  /// Creates the fitters and starts the threads
+  /// \param nThreads is the number of threads running the fits, including the calling one
+  /// \param configure is called once on each fitter (2-prong and 3-prong) to set its parameters
+  template <typename TConfigure>
+  void start(int nThreads, TConfigure&& configure)
+  {
+    stop();
+    nThreads = std::max(1, nThreads);
+    mFitters2Prong.resize(nThreads);
+    mFitters3Prong.resize(nThreads);
+    mBz = -999.; // the magnetic field of the new fitters is not set yet
+    for (int iThread = 0; iThread < nThreads; iThread++) {
+      configure(mFitters2Prong[iThread]);
+      configure(mFitters3Prong[iThread]);
+    }
+    uint64_t batch = 0;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = false;
+      batch = mBatch;
+    }
+    for (int iThread = 1; iThread < nThreads; iThread++) {
+      mWorkers.emplace_back(&HfVertexFitterPool::workerLoop, this, iThread, batch);
+    }
+  }
+
+  /// \return number of threads running the fits, including the calling one
+  int nThreads() const { return mFitters2Prong.size(); }
+
+  /// Sets the magnetic field of all the fitters, if it changed
+  /// \param bz is the magnetic field
+  void setBz(double bz)
+  {
+    if (bz == mBz) {
+      return;
+    }
+    for (auto& fitter : mFitters2Prong) {
+      fitter.setBz(bz);
+    }
+    for (auto& fitter : mFitters3Prong) {
+      fitter.setBz(bz);
+    }
+    mBz = bz;
+  }
+
+  /// Runs a batch of tasks on the threads of the pool and waits for their completion
+  /// \param nTasks is the number of tasks, each task index is run exactly once
+  /// \param task is the function running a task
+  void run(int nTasks, Task const& task)
+  {
+    if (mWorkers.empty() || nTasks <= 1) {
+      for (int iTask = 0; iTask < nTasks; iTask++) {
+        task(iTask, mFitters2Prong[0], mFitters3Prong[0]);
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTask = &task;
+      mNTasks = nTasks;
+      mNextTask = 0;
+      mNBusyWorkers = mWorkers.size();
+      ++mBatch;
+    }
+    mCvBatch.notify_all();
+    runTasks(0);
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCvDone.wait(lock, [this] { return mNBusyWorkers == 0; });
+    mTask = nullptr;
+  }
+
+ private:
+  /// Stops and joins the threads
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCvBatch.notify_all();
+    for (auto& worker : mWorkers) {
+      worker.join();
+    }
+    mWorkers.clear();
+  }
+
+  /// Runs the tasks of the current batch not yet taken by the other threads
+  /// \param iThread is the index of the thread, i.e. of its fitters
+  void runTasks(int iThread)
+  {
+    for (int iTask = mNextTask++; iTask < mNTasks; iTask = mNextTask++) {
+      (*mTask)(iTask, mFitters2Prong[iThread], mFitters3Prong[iThread]);
+    }
+  }
+
+  /// Loop of a worker thread, waiting for the batches of tasks
+  /// \param iThread is the index of the thread, i.e. of its fitters
+  /// \param batch is the index of the last batch before the start of the thread, which it must not run
+  void workerLoop(int iThread, uint64_t batch)
+  {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCvBatch.wait(lock, [this, batch] { return mStop || mBatch != batch; });
+        if (mStop) {
+          return;
+        }
+        batch = mBatch;
+      }
+      runTasks(iThread);
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mNBusyWorkers;
+      }
+      mCvDone.notify_one();
+    }
+  }
+
+  std::vector<Fitter2Prong> mFitters2Prong; ///< 2-prong fitter of each thread (0: calling thread)
+  std::vector<Fitter3Prong> mFitters3Prong; ///< 3-prong fitter of each thread (0: calling thread)
+  double mBz{-999.};                        ///< magnetic field of the fitters (-999: not set)
+  std::vector<std::thread> mWorkers;        ///< worker threads
+  std::mutex mMutex;                        ///< protects the batch state below
+  std::condition_variable mCvBatch;         ///< signals a new batch (or the stop) to the workers
+  std::condition_variable mCvDone;          ///< signals the completion of a worker to the calling thread
+  const Task* mTask{nullptr};               ///< task of the current batch
+  int mNTasks{0};                           ///< number of tasks of the current batch
+  std::atomic<int> mNextTask{0};            ///< index of the next task to run
+  size_t mNBusyWorkers{0};                  ///< number of workers still running the current batch
+  uint64_t mBatch{0};                       ///< index of the current batch
+  bool mStop{false};                        ///< whether the workers must stop
+};
+
+#endif // PWGHF_UTILS_UTILSVERTEXFITTERPOOL_H_
@@ -28,16 +28,20 @@ void JetFinder::setParams()
   //ghostAreaSpec=fastjet::GhostedAreaSpec(selGhosts,ghostRepeatN,ghostArea,gridScatter,ktScatter,ghostktMean);
   ghostAreaSpec = fastjet::GhostedAreaSpec(ghostEtaMax, ghostRepeatN, ghostArea, gridScatter, ktScatter, ghostktMean); //the first argument is rapidity not pseudorapidity, to be checked
   jetDef = fastjet::JetDefinition(algorithm, jetR, recombScheme, strategy);
-  areaDef = fastjet::AreaDefinition(areaType, ghostAreaSpec);
+  areaDef = areaType == fastjet::voronoi_area ? fastjet::AreaDefinition(fastjet::VoronoiAreaSpec(voronoiRfact)) : fastjet::AreaDefinition(areaType, ghostAreaSpec);
   selJets = fastjet::SelectorPtRange(jetPtMin, jetPtMax) && fastjet::SelectorEtaRange(jetEtaMin, jetEtaMax) && fastjet::SelectorPhiRange(jetPhiMin, jetPhiMax);
+  if (hasExplicitGhosts()) {
+    selJets = selJets && !fastjet::SelectorIsPureGhost();
+  }
   jetDefBkg = fastjet::JetDefinition(algorithmBkg, jetBkgR, recombSchemeBkg, strategyBkg);
-  areaDefBkg = fastjet::AreaDefinition(areaTypeBkg, ghostAreaSpec);
+  areaDefBkg = areaTypeBkg == fastjet::voronoi_area ? fastjet::AreaDefinition(fastjet::VoronoiAreaSpec(voronoiRfact)) : fastjet::AreaDefinition(areaTypeBkg, ghostAreaSpec);
   selRho = fastjet::SelectorRapRange(bkgEtaMin, bkgEtaMax) && fastjet::SelectorPhiRange(bkgPhiMin, bkgPhiMax); //&& !fastjet::SelectorNHardest(2)    //here we have to put rap range, to be checked!
 }
 
 /// Sets the background subtraction estimater pointer
 void JetFinder::setBkgE()
 {
+  bkgE.reset();
   if (bkgSubMode == BkgSubMode::rhoAreaSub || bkgSubMode == BkgSubMode::constSub) {
     bkgE = decltype(bkgE)(new fastjet::JetMedianBackgroundEstimator(selRho, jetDefBkg, areaDefBkg));
   } else {
@@ -50,6 +54,8 @@ void JetFinder::setBkgE()
 /// Sets the background subtraction pointer
 void JetFinder::setSub()
 {
+  sub.reset();
+  constituentSub.reset();
   //if rho < 1e-6 it is set to 1e-6 in AliPhysics
   if (bkgSubMode == BkgSubMode::rhoAreaSub) {
     sub = decltype(sub){new fastjet::Subtractor{bkgE.get()}};
@@ -68,6 +74,30 @@ void JetFinder::setSub()
   }
 }
 
+/// Returns the parameters from which the definitions are built
+std::vector<double> JetFinder::getParamValues() const
+{
+  return {static_cast<double>(bkgSubMode), phiMin, phiMax, etaMin, etaMax,
+          jetR, jetPtMin, jetPtMax, jetPhiMin, jetPhiMax, jetEtaMin, jetEtaMax,
+          ghostEtaMin, ghostEtaMax, ghostArea, static_cast<double>(ghostRepeatN), ghostktMean, gridScatter, ktScatter, static_cast<double>(useFixedGhosts), voronoiRfact,
+          jetBkgR, bkgPhiMin, bkgPhiMax, bkgEtaMin, bkgEtaMax, constSubAlpha, constSubRMax, static_cast<double>(isReclustering),
+          static_cast<double>(algorithm), static_cast<double>(recombScheme), static_cast<double>(strategy), static_cast<double>(areaType),
+          static_cast<double>(algorithmBkg), static_cast<double>(recombSchemeBkg), static_cast<double>(strategyBkg), static_cast<double>(areaTypeBkg)};
+}
+
+/// Builds the definitions, selectors, background estimator and subtractors, and the fixed ghosts if requested
+void JetFinder::init()
+{
+  setParams();
+  setBkgE();
+  setSub();
+  fixedGhosts.clear();
+  if (useFixedGhosts) {
+    ghostAreaSpec.add_ghosts(fixedGhosts);
+  }
+  initParamValues = getParamValues(); // after setParams, which derives the jet eta range
+}
+
 /// Performs jet finding
 /// \note the input particle and jet lists are passed by reference
 /// \param inputParticles vector of input particles/tracks
@@ -75,13 +105,13 @@ void JetFinder::setSub()
 /// \return ClusterSequenceArea object needed to access constituents
 fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets) //ideally find a way of passing the cluster sequence as a reeference
 {
-  setParams();
-  setBkgE();
+  if (initParamValues != getParamValues()) {
+    init();
+  }
   jets.clear();
 
   if (bkgE) {
     bkgE->set_particles(inputParticles);
-    setSub();
   }
   if (constituentSub) {
     inputParticles = constituentSub->subtract_event(inputParticles);
@@ -91,3 +121,30 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   jets = selJets(jets);
   return clusterSeq;
 }
+
+/// Performs jet finding, also with the fixed ghosts
+/// \note the input particle and jet lists are passed by reference
+/// \param inputParticles vector of input particles/tracks
+/// \param jets veector of jets to be filled
+/// \param clusterSeq cluster sequence needed to access constituents, created in place
+void JetFinder::findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets, std::unique_ptr<fastjet::ClusterSequenceAreaBase>& clusterSeq)
+{
+  if (initParamValues != getParamValues()) {
+    init();
+  }
+  jets.clear();
+
+  if (bkgE) {
+    bkgE->set_particles(inputParticles);
+  }
+  if (constituentSub) {
+    inputParticles = constituentSub->subtract_event(inputParticles);
+  }
+  if (useFixedGhosts) {
+    clusterSeq = std::make_unique<fastjet::ClusterSequenceActiveAreaExplicitGhosts>(inputParticles, jetDef, fixedGhosts, ghostAreaSpec.actual_ghost_area());
+  } else {
+    clusterSeq = std::make_unique<fastjet::ClusterSequenceArea>(inputParticles, jetDef, areaDef);
+  }
+  jets = sub ? (*sub)(clusterSeq->inclusive_jets()) : clusterSeq->inclusive_jets();
+  jets = selJets(jets);
+}
@@ -22,12 +22,14 @@
 
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh"
 #include "fastjet/AreaDefinition.hh"
 #include "fastjet/JetDefinition.hh"
 #include "fastjet/tools/JetMedianBackgroundEstimator.hh"
 #include "fastjet/tools/Subtractor.hh"
 #include "fastjet/contrib/ConstituentSubtractor.hh"
 
+#include <memory>
 #include <vector>
 
 class JetFinder
@@ -70,6 +72,8 @@ class JetFinder
   double ghostktMean;
   float gridScatter;
   float ktScatter;
+  bool useFixedGhosts; // generate the ghosts once at initialisation and cluster them explicitly with every event
+  double voronoiRfact; // effective radius factor of the Voronoi areas, for areaType = voronoi_area
 
   float jetBkgR;
   float bkgPhiMin;
@@ -120,6 +124,8 @@ class JetFinder
                                                                                                         ghostktMean(1e-100), // is float precise enough?
                                                                                                         gridScatter(1.0),
                                                                                                         ktScatter(0.1),
+                                                                                                        useFixedGhosts(false),
+                                                                                                        voronoiRfact(1.0),
                                                                                                         jetBkgR(0.2),
                                                                                                         bkgPhiMin(phi_Min),
                                                                                                         bkgPhiMax(phi_Max),
@@ -145,6 +151,10 @@ class JetFinder
   /// Default destructor
   ~JetFinder() = default;
 
+  /// Builds the jet and area definitions, selectors, background estimator and subtractors from the parameters
+  /// \note called by findJets when the parameters changed since the last call, so that they are built once per configuration
+  void init();
+
   /// Sets the jet finding parameters
   void setParams();
 
@@ -161,12 +171,27 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Performs jet finding, also with the fixed ghosts
+  /// \note the input particle and jet lists are passed by reference
+  /// \param inputParticles vector of input particles/tracks
+  /// \param jets veector of jets to be filled
+  /// \param clusterSeq cluster sequence needed to access constituents, created in place
+  void findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets, std::unique_ptr<fastjet::ClusterSequenceAreaBase>& clusterSeq);
+
+  /// Whether the ghosts are among the jet constituents
+  bool hasExplicitGhosts() const { return useFixedGhosts || areaType == fastjet::active_area_explicit_ghosts; }
+
  private:
   // void setParams();
   // void setBkgSub();
   std::unique_ptr<fastjet::BackgroundEstimatorBase> bkgE;
   std::unique_ptr<fastjet::Subtractor> sub;
   std::unique_ptr<fastjet::contrib::ConstituentSubtractor> constituentSub;
+  std::vector<fastjet::PseudoJet> fixedGhosts; //!
+
+  /// Returns the parameters from which the definitions are built, to detect changes since the last init
+  std::vector<double> getParamValues() const;
+  std::vector<double> initParamValues; //! parameters of the last init, empty before the first one
 
   ClassDefNV(JetFinder, 1);
 };
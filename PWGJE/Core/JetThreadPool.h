@@ -0,0 +1,143 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// persistent pool of threads running batches of jet finding tasks
+//
+// The threads are created once, when the pool is started, and wait between the batches,
+// so that no thread is created per collision. The calling thread takes part in each batch.
+
+#ifndef O2_ANALYSIS_JETTHREADPOOL_H
+#define O2_ANALYSIS_JETTHREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JetThreadPool
+{
+
+ public:
+  /// task of a batch, called with the task index
+  using Task = std::function<void(int)>;
+
+  JetThreadPool() = default;
+  JetThreadPool(const JetThreadPool&) = delete;
+  JetThreadPool& operator=(const JetThreadPool&) = delete;
+  ~JetThreadPool() { stop(); }
+
+  /// Starts the threads
+  /// \param nThreads number of threads running the tasks, including the calling one
+  void start(int nThreads)
+  {
+    stop();
+    uint64_t batch = 0;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = false;
+      batch = mBatch;
+    }
+    for (int iThread = 1; iThread < std::max(1, nThreads); iThread++) {
+      mWorkers.emplace_back(&JetThreadPool::workerLoop, this, batch);
+    }
+  }
+
+  /// \return number of threads running the tasks, including the calling one
+  int nThreads() const { return mWorkers.size() + 1; }
+
+  /// Runs a batch of tasks on the threads of the pool and waits for their completion
+  /// \param nTasks number of tasks, each task index is run exactly once
+  /// \param task function running a task
+  void run(int nTasks, Task const& task)
+  {
+    if (mWorkers.empty() || nTasks <= 1) {
+      for (int iTask = 0; iTask < nTasks; iTask++) {
+        task(iTask);
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTask = &task;
+      mNTasks = nTasks;
+      mNextTask = 0;
+      mNBusyWorkers = mWorkers.size();
+      ++mBatch;
+    }
+    mCvBatch.notify_all();
+    runTasks();
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCvDone.wait(lock, [this] { return mNBusyWorkers == 0; });
+    mTask = nullptr;
+  }
+
+ private:
+  /// Stops and joins the threads
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCvBatch.notify_all();
+    for (auto& worker : mWorkers) {
+      worker.join();
+    }
+    mWorkers.clear();
+  }
+
+  /// Runs the tasks of the current batch not yet taken by the other threads
+  void runTasks()
+  {
+    for (int iTask = mNextTask++; iTask < mNTasks; iTask = mNextTask++) {
+      (*mTask)(iTask);
+    }
+  }
+
+  /// Loop of a worker thread, waiting for the batches of tasks
+  /// \param batch index of the last batch before the start of the thread, which it must not run
+  void workerLoop(uint64_t batch)
+  {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCvBatch.wait(lock, [this, batch] { return mStop || mBatch != batch; });
+        if (mStop) {
+          return;
+        }
+        batch = mBatch;
+      }
+      runTasks();
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mNBusyWorkers;
+      }
+      mCvDone.notify_one();
+    }
+  }
+
+  std::vector<std::thread> mWorkers; // worker threads
+  std::mutex mMutex;                 // protects the batch state below
+  std::condition_variable mCvBatch;  // signals a new batch (or the stop) to the workers
+  std::condition_variable mCvDone;   // signals the completion of a worker to the calling thread
+  const Task* mTask = nullptr;       // task of the current batch
+  int mNTasks = 0;                   // number of tasks of the current batch
+  std::atomic<int> mNextTask{0};     // index of the next task to run
+  size_t mNBusyWorkers = 0;          // number of workers still running the current batch
+  uint64_t mBatch = 0;               // index of the current batch
+  bool mStop = false;                // whether the workers must stop
+};
+
+#endif
@@ -23,8 +23,12 @@
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
 
+#include <algorithm>
+#include <memory>
+
 #include "PWGJE/DataModel/Jet.h"
 #include "PWGJE/Core/JetFinder.h"
+#include "PWGJE/Core/JetThreadPool.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -74,6 +78,9 @@ struct JetFinderTask {
   Configurable<bool> DoConstSub{"DoConstSub", false, "do constituent subtraction"};
   Configurable<float> jetPtMin{"jetPtMin", 10.0, "minimum jet pT"};
   Configurable<std::vector<double>> jetR{"jetR", {0.4}, "jet resolution parameters"};
+  Configurable<int> jetAreaType{"jetAreaType", 0, "fastjet area type: 0 = active, 1 = active with explicit ghosts, 10 = one ghost passive, 11 = passive, 20 = Voronoi"};
+  Configurable<bool> jetFixedGhosts{"jetFixedGhosts", false, "generate the ghosts once and reuse them in every event"};
+  Configurable<int> jetRThreads{"jetRThreads", 1, "number of threads clustering the jet radii in parallel, requires fixed ghosts or Voronoi areas and no background subtraction"};
   // FIXME: This should be named jetType. However, as of Aug 2021, it doesn't appear possible
   //        to set both global and task level options. This should be resolved when workflow
   //        level customization is available
@@ -82,9 +89,19 @@ struct JetFinderTask {
   Filter collisionFilter = nabs(aod::collision::posZ) < vertexZCut;
   Filter trackFilter = (nabs(aod::track::eta) < trackEtaCut) && (requireGlobalTrackInFilter()) && (aod::track::pt > trackPtCut);
 
-  std::vector<fastjet::PseudoJet> jets;
+  // Jet finding for one R, on the constituents shared by all the radii
+  struct JetFinderR {
+    double R;
+    JetFinder jetFinder; //should be a configurable but for now this cant be changed on hyperloop
+    std::vector<fastjet::PseudoJet> inputParticles; // copy of the constituents, when the subtraction modifies them
+    std::vector<fastjet::PseudoJet> jets;
+    std::unique_ptr<fastjet::ClusterSequenceAreaBase> clusterSeq;
+  };
+
   std::vector<fastjet::PseudoJet> inputParticles;
-  JetFinder jetFinder; //should be a configurable but for now this cant be changed on hyperloop
+  std::vector<fastjet::PseudoJet> jetConstituents;
+  std::vector<std::unique_ptr<JetFinderR>> jetFinders; // one per R, configured once in init
+  std::unique_ptr<JetThreadPool> threadPool;           // threads clustering the radii in parallel, started once in init
   // FIXME: Once configurables support enum, ideally we can
   JetType_t _jetType;
 
@@ -98,13 +115,49 @@ struct JetFinderTask {
                                70, -0.7, 0.7, 10, 0.05, 1.05));
     hJetN.setObject(new TH2F("h_jet_n", "jet n;n constituents",
                              30, 0., 30., 10, 0.05, 1.05));
-    if (DoRhoAreaSub) {
-      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+    // NOTE: Can't just iterate directly - we have to cast first
+    auto jetRValues = static_cast<std::vector<double>>(jetR);
+    for (auto R : jetRValues) {
+      auto& jetFinderR = *jetFinders.emplace_back(std::make_unique<JetFinderR>());
+      jetFinderR.R = R;
+      auto& jetFinder = jetFinderR.jetFinder;
+      if (DoRhoAreaSub) {
+        jetFinder.setBkgSubMode(JetFinder::BkgSubMode::rhoAreaSub);
+      }
+      if (DoConstSub) {
+        jetFinder.setBkgSubMode(JetFinder::BkgSubMode::constSub);
+      }
+      jetFinder.jetPtMin = jetPtMin;
+      jetFinder.jetR = R;
+      jetFinder.areaType = static_cast<fastjet::AreaType>(static_cast<int>(jetAreaType));
+      jetFinder.useFixedGhosts = jetFixedGhosts;
+      jetFinder.init();
+    }
+
+    // the ghosts of the active and passive areas (also those of the background estimation) are drawn from
+    // a random generator shared by all the cluster sequences, so that the radii can only be clustered
+    // in parallel without per-event ghosts
+    int nThreads = std::max(1, std::min<int>(jetRThreads, jetFinders.size()));
+    if (nThreads > 1 && ((!jetFixedGhosts && jetAreaType != fastjet::voronoi_area) || DoRhoAreaSub || DoConstSub)) {
+      LOGF(warning, "Parallel clustering of the jet radii requires jetFixedGhosts or Voronoi areas and no background subtraction, clustering them sequentially");
+      nThreads = 1;
     }
+    threadPool = std::make_unique<JetThreadPool>();
+    threadPool->start(nThreads);
+    fastjet::ClusterSequence::print_banner(); // printed once here rather than by the first, possibly concurrent, cluster sequence
+  }
+
+  /// Clusters the constituents for the given R
+  void findJets(int iR)
+  {
+    auto& jetFinderR = *jetFinders[iR];
     if (DoConstSub) {
-      jetFinder.setBkgSubMode(JetFinder::BkgSubMode::constSub);
+      // the constituent subtraction replaces the input particles, keep the original ones for the other radii
+      jetFinderR.inputParticles = inputParticles;
+      jetFinderR.jetFinder.findJets(jetFinderR.inputParticles, jetFinderR.jets, jetFinderR.clusterSeq);
+    } else {
+      jetFinderR.jetFinder.findJets(inputParticles, jetFinderR.jets, jetFinderR.clusterSeq);
     }
-    jetFinder.jetPtMin = jetPtMin;
   }
 
   template <typename T>
@@ -120,7 +173,6 @@ struct JetFinderTask {
     }
     */
 
-    jets.clear();
     inputParticles.clear();
 
     return true;
@@ -130,21 +182,24 @@ struct JetFinderTask {
   void processImplementation(T const& collision)
   {
     LOG(debug) << "Process Implementation";
-    // NOTE: Can't just iterate directly - we have to cast first
-    auto jetRValues = static_cast<std::vector<double>>(jetR);
-    for (auto R : jetRValues) {
-      // Update jet finder R and find jets
-      jetFinder.jetR = R;
-      fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
-
-      for (const auto& jet : jets) {
+    // The constituents are built once per collision and clustered for all the radii,
+    // the tables are then filled sequentially in the order of the radii
+    threadPool->run(jetFinders.size(), [this](int iR) { findJets(iR); });
+
+    for (auto& jetFinderR : jetFinders) {
+      double R = jetFinderR->R;
+      for (const auto& jet : jetFinderR->jets) {
+        jetConstituents = jet.constituents();
+        if (jetFinderR->jetFinder.hasExplicitGhosts()) {
+          jetConstituents.erase(std::remove_if(jetConstituents.begin(), jetConstituents.end(), [](const fastjet::PseudoJet& constituent) { return constituent.is_pure_ghost(); }), jetConstituents.end());
+        }
         jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
                   jet.E(), jet.m(), jet.area(), std::round(R * 100));
         hJetPt->Fill(jet.pt(), R);
         hJetPhi->Fill(jet.phi(), R);
         hJetEta->Fill(jet.eta(), R);
-        hJetN->Fill(jet.constituents().size(), R);
-        for (const auto& constituent : jet.constituents()) { //event or jetwise
+        hJetN->Fill(jetConstituents.size(), R);
+        for (const auto& constituent : jetConstituents) { //event or jetwise
           if (DoConstSub) {
             // Since we're copying the consituents, we can combine the tracks and clusters together
             // We only have to keep the uncopied versions separated due to technical constraints.
@@ -173,7 +228,6 @@ struct JetFinderTask {
 
     // Initialziation and event selection
     // TODO: MC event selection?
-    jets.clear();
     inputParticles.clear();
 
     // As of June 2021, how best to check for charged particles? It doesn't seem to be in
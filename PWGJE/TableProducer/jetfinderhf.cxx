@@ -30,6 +30,8 @@
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
 
+#include <memory>
+
 #include "PWGJE/DataModel/Jet.h"
 #include "PWGJE/Core/JetFinder.h"
 
@@ -55,9 +57,9 @@ template <typename JetTable, typename TrackConstituentTable>
 struct JetFinderHFTask {
   Produces<JetTable> jetsTable;
   Produces<TrackConstituentTable> trackConstituents;
-  OutputObj<TH1F> hJetPt{"h_jet_pt"};
-  OutputObj<TH1F> hJetPtTrue{"h_jet_pt_true"};
-  OutputObj<TH1F> hD0Pt{"h_D0_pt"};
+  OutputObj<TH2F> hJetPt{"h_jet_pt"};
+  OutputObj<TH2F> hJetPtTrue{"h_jet_pt_true"};
+  OutputObj<TH2F> hD0Pt{"h_D0_pt"};
 
   Service<TDatabasePDG> pdg;
 
@@ -65,7 +67,10 @@ struct JetFinderHFTask {
 
   std::vector<fastjet::PseudoJet> jets;
   std::vector<fastjet::PseudoJet> inputParticles;
-  JetFinder jetFinder;
+  std::vector<std::unique_ptr<JetFinder>> jetFinders; // one per R, configured once in init
+  std::unique_ptr<fastjet::ClusterSequenceAreaBase> clusterSeq;
+
+  Configurable<std::vector<double>> jetR{"jetR", {0.4}, "jet resolution parameters"};
 
   void init(InitContext const&)
   {
@@ -73,12 +78,20 @@ struct JetFinderHFTask {
     globalTracks = getGlobalTrackSelection();
     globalTracks.SetEtaRange(-.9, .9);
 
-    hJetPt.setObject(new TH1F("h_jet_pt", "jet p_{T};p_{T} (GeV/#it{c})",
-                              100, 0., 100.));
-    hJetPtTrue.setObject(new TH1F("h_jet_pt_true", "jet p_{T};p_{T} (GeV/#it{c})",
-                                  100, 0., 100.));
-    hD0Pt.setObject(new TH1F("h_D0_pt", "jet p_{T,D};p_{T,D} (GeV/#it{c})",
-                             60, 0., 60.));
+    hJetPt.setObject(new TH2F("h_jet_pt", "jet p_{T};p_{T} (GeV/#it{c});#it{R}",
+                              100, 0., 100., 10, 0.05, 1.05));
+    hJetPtTrue.setObject(new TH2F("h_jet_pt_true", "jet p_{T};p_{T} (GeV/#it{c});#it{R}",
+                                  100, 0., 100., 10, 0.05, 1.05));
+    hD0Pt.setObject(new TH2F("h_D0_pt", "jet p_{T,D};p_{T,D} (GeV/#it{c});#it{R}",
+                             60, 0., 60., 10, 0.05, 1.05));
+
+    // NOTE: Can't just iterate directly - we have to cast first
+    auto jetRValues = static_cast<std::vector<double>>(jetR);
+    for (auto R : jetRValues) {
+      auto& jetFinder = *jetFinders.emplace_back(std::make_unique<JetFinder>());
+      jetFinder.jetR = R;
+      jetFinder.init();
+    }
   }
 
   Configurable<int> selectionFlagD0{"selectionFlagD0", 1, "Selection Flag for D0"};
@@ -116,26 +129,29 @@ struct JetFinderHFTask {
       inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
       inputParticles.back().set_user_index(1);
 
-      fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+      // the input particles are built once and clustered for all the radii
+      for (auto& jetFinder : jetFinders) {
+        jetFinder->findJets(inputParticles, jets, clusterSeq);
 
-      for (const auto& jet : jets) {
-        isHFJet = false;
-        for (const auto& constituent : jet.constituents()) {
-          if (constituent.user_index() == 1 && (candidate.isSelD0() == 1 || candidate.isSelD0bar() == 1)) {
-            isHFJet = true;
+        for (const auto& jet : jets) {
+          isHFJet = false;
+          for (const auto& constituent : jet.constituents()) {
+            if (constituent.user_index() == 1 && (candidate.isSelD0() == 1 || candidate.isSelD0bar() == 1)) {
+              isHFJet = true;
+              break;
+            }
+          }
+          if (isHFJet) {
+            jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
+                      jet.E(), jet.m(), jet.area(), std::round(jetFinder->jetR * 100));
+            // for (const auto& constituent : jet.constituents()) {
+            // trackConstituents(jetsTable.lastIndex(), constituent.user_index());
+            // }
+            hJetPt->Fill(jet.pt(), jetFinder->jetR);
+            hD0Pt->Fill(candidate.pt(), jetFinder->jetR);
             break;
           }
         }
-        if (isHFJet) {
-          jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
-                    jet.E(), jet.m(), jet.area(), jetFinder.jetR);
-          // for (const auto& constituent : jet.constituents()) {
-          // trackConstituents(jetsTable.lastIndex(), constituent.user_index());
-          // }
-          hJetPt->Fill(jet.pt());
-          hD0Pt->Fill(candidate.pt());
-          break;
-        }
       }
     }
   }
@@ -171,38 +187,41 @@ struct JetFinderHFTask {
       inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e(RecoDecay::getMassPDG(pdgD0)));
       inputParticles.back().set_user_index(1);
 
-      fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+      // the input particles are built once and clustered for all the radii
+      for (auto& jetFinder : jetFinders) {
+        jetFinder->findJets(inputParticles, jets, clusterSeq);
 
-      for (const auto& jet : jets) {
-        isHFJet = false;
-        std::vector<int> trackconst;
-        std::vector<int> candconst;
-        for (const auto& constituent : jet.constituents()) {
-          if (constituent.user_index() == 1 && (candidate.isSelD0() == 1 || candidate.isSelD0bar() == 1)) {
-            isHFJet = true;
-            break;
+        for (const auto& jet : jets) {
+          isHFJet = false;
+          std::vector<int> trackconst;
+          std::vector<int> candconst;
+          for (const auto& constituent : jet.constituents()) {
+            if (constituent.user_index() == 1 && (candidate.isSelD0() == 1 || candidate.isSelD0bar() == 1)) {
+              isHFJet = true;
+              break;
+            }
           }
-        }
-        if (isHFJet) {
-          jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
-                    jet.E(), jet.m(), jet.area(), jetFinder.jetR);
-          const auto& constituents = sorted_by_pt(jet.constituents());
-          for (const auto& constituent : constituents) {
-            if (constituent.user_index() != 1) {
-              LOGF(info, "jet %d (coll %d) has constituent %d", jetsTable.lastIndex(), collision.globalIndex(), constituent.user_index());
-              auto track = tracks.rawIteratorAt(constituent.user_index());
-              LOGF(info, "constituent %d points to track %d (coll %d)", constituent.user_index(), track.globalIndex(), 0); // , track.collisionId()); // .globalIndex());
-              trackconst.push_back(constituent.user_index());
+          if (isHFJet) {
+            jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
+                      jet.E(), jet.m(), jet.area(), std::round(jetFinder->jetR * 100));
+            const auto& constituents = sorted_by_pt(jet.constituents());
+            for (const auto& constituent : constituents) {
+              if (constituent.user_index() != 1) {
+                LOGF(info, "jet %d (coll %d) has constituent %d", jetsTable.lastIndex(), collision.globalIndex(), constituent.user_index());
+                auto track = tracks.rawIteratorAt(constituent.user_index());
+                LOGF(info, "constituent %d points to track %d (coll %d)", constituent.user_index(), track.globalIndex(), 0); // , track.collisionId()); // .globalIndex());
+                trackconst.push_back(constituent.user_index());
+              }
             }
+            LOGF(info, "jet %d (coll %d) has candidate %d-%d", jetsTable.lastIndex(), collision.globalIndex(), candidate.index(), candidate.globalIndex());
+            candconst.push_back(candidate.globalIndex());
+            trackConstituents(jetsTable.lastIndex(), trackconst, std::vector<int>(), candconst);
+            hJetPt->Fill(jet.pt(), jetFinder->jetR);
+            if (candidate.flagMcMatchRec() & (1 << aod::hf_cand_2prong::DecayType::D0ToPiK))
+              hJetPtTrue->Fill(jet.pt(), jetFinder->jetR);
+            hD0Pt->Fill(candidate.pt(), jetFinder->jetR);
+            break;
           }
-          LOGF(info, "jet %d (coll %d) has candidate %d-%d", jetsTable.lastIndex(), collision.globalIndex(), candidate.index(), candidate.globalIndex());
-          candconst.push_back(candidate.globalIndex());
-          trackConstituents(jetsTable.lastIndex(), trackconst, std::vector<int>(), candconst);
-          hJetPt->Fill(jet.pt());
-          if (candidate.flagMcMatchRec() & (1 << aod::hf_cand_2prong::DecayType::D0ToPiK))
-            hJetPtTrue->Fill(jet.pt());
-          hD0Pt->Fill(candidate.pt());
-          break;
         }
       }
     }
@@ -255,35 +274,38 @@ struct JetFinderHFTask {
       inputParticles.emplace_back(candidate.px(), candidate.py(), candidate.pz(), candidate.e());
       inputParticles.back().set_user_index(1);
 
-      fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+      // the input particles are built once and clustered for all the radii
+      for (auto& jetFinder : jetFinders) {
+        jetFinder->findJets(inputParticles, jets, clusterSeq);
 
-      for (const auto& jet : jets) {
-        isHFJet = false;
-        std::vector<int> trackconst;
-        std::vector<int> candconst;
-        for (const auto& constituent : jet.constituents()) {
-          if (constituent.user_index() == 1) {
-            isHFJet = true;
-            break;
-          }
-        }
-        if (isHFJet) {
-          jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
-                    jet.E(), jet.m(), jet.area(), jetFinder.jetR);
+        for (const auto& jet : jets) {
+          isHFJet = false;
+          std::vector<int> trackconst;
+          std::vector<int> candconst;
           for (const auto& constituent : jet.constituents()) {
-            if (constituent.user_index() == 1)
-              continue;
-            LOGF(info, "MC jet %d (MC coll %d) has constituent %d", jetsTable.lastIndex(), collision.globalIndex(), constituent.user_index());
-            trackconst.push_back(constituent.user_index());
+            if (constituent.user_index() == 1) {
+              isHFJet = true;
+              break;
+            }
+          }
+          if (isHFJet) {
+            jetsTable(collision, jet.pt(), jet.eta(), jet.phi(),
+                      jet.E(), jet.m(), jet.area(), std::round(jetFinder->jetR * 100));
+            for (const auto& constituent : jet.constituents()) {
+              if (constituent.user_index() == 1)
+                continue;
+              LOGF(info, "MC jet %d (MC coll %d) has constituent %d", jetsTable.lastIndex(), collision.globalIndex(), constituent.user_index());
+              trackconst.push_back(constituent.user_index());
+            }
+            LOGF(info, "MC jet %d (MC coll %d) has candidate %d",
+                 jetsTable.lastIndex(), collision.globalIndex(), candidates.back().globalIndex());
+            candconst.push_back(candidate.globalIndex());
+            LOGF(info, "MC jet %d has %d track and %d candidate constituents", jetsTable.lastIndex(), trackconst.size(), candconst.size());
+            trackConstituents(jetsTable.lastIndex(), trackconst, std::vector<int>(), candconst);
+            hJetPt->Fill(jet.pt(), jetFinder->jetR);
+            hD0Pt->Fill(candidate.pt(), jetFinder->jetR);
+            break;
           }
-          LOGF(info, "MC jet %d (MC coll %d) has candidate %d",
-               jetsTable.lastIndex(), collision.globalIndex(), candidates.back().globalIndex());
-          candconst.push_back(candidate.globalIndex());
-          LOGF(info, "MC jet %d has %d track and %d candidate constituents", jetsTable.lastIndex(), trackconst.size(), candconst.size());
-          trackConstituents(jetsTable.lastIndex(), trackconst, std::vector<int>(), candconst);
-          hJetPt->Fill(jet.pt());
-          hD0Pt->Fill(candidate.pt());
-          break;
         }
       }
     }
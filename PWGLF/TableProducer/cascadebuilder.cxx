@@ -53,6 +53,7 @@
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "PWGLF/Utils/trackParCache.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -140,6 +141,7 @@ struct cascadeBuilder {
   Configurable<bool> d_UseWeightedPCA{"d_UseWeightedPCA", false, "Vertices use cov matrices"};
   Configurable<int> useMatCorrType{"useMatCorrType", 0, "0: none, 1: TGeo, 2: LUT"};
   Configurable<int> useMatCorrTypeCasc{"useMatCorrTypeCasc", 0, "0: none, 1: TGeo, 2: LUT"};
+  Configurable<float> daughterPropagationX{"daughterPropagationX", -1.f, "if > 0, bachelors with a larger X are propagated once to this X (cm) before the DCA fitter, -1: off"};
   Configurable<int> rejDiffCollTracks{"rejDiffCollTracks", 0, "rejDiffCollTracks"};
 
   // CCDB options
@@ -188,6 +190,10 @@ struct cascadeBuilder {
 
   o2::track::TrackParCov lBachelorTrack;
   o2::track::TrackParCov lV0Track;
+
+  // TrackParCov of the bachelors and of the V0s, built once per timeframe whatever the number of cascades they enter
+  o2::analysis::TrackParCache trackCache;
+  o2::analysis::TrackParCache v0Cache;
   o2::track::TrackPar lCascadeTrack;
 
   // Helper struct to do bookkeeping of building parameters
@@ -375,6 +381,8 @@ struct cascadeBuilder {
       matCorrCascade = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
     if (useMatCorrTypeCasc == 2)
       matCorrCascade = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+
+    trackCache.setPropagation(daughterPropagationX, maxSnp, maxStep, matCorr);
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -413,6 +421,7 @@ struct cascadeBuilder {
     mRunNumber = bc.runNumber();
     // Set magnetic field value once known
     fitter.setBz(d_bz);
+    trackCache.reset(); // propagated with the previous field
   }
 
   template <class TTracksTo, typename TV0Object>
@@ -449,21 +458,24 @@ struct cascadeBuilder {
     statisticsRegistry.cascstats[kBachDCAxy]++;
 
     // Do actual minimization
-    lBachelorTrack = getTrackParCov(bachTrack);
-
-    // Set up covariance matrices (should in fact be optional)
-    std::array<float, 21> covV = {0.};
-    constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
-    for (int i = 0; i < 6; i++) {
-      covV[MomInd[i]] = v0.momentumCovMat()[i];
-      covV[i] = v0.positionCovMat()[i];
-    }
-    lV0Track = o2::track::TrackParCov(
-      {v0.x(), v0.y(), v0.z()},
-      {v0.pxpos() + v0.pxneg(), v0.pypos() + v0.pyneg(), v0.pzpos() + v0.pzneg()},
-      covV, 0, true);
-    lV0Track.setAbsCharge(0);
-    lV0Track.setPID(o2::track::PID::Lambda);
+    lBachelorTrack = trackCache.get(bachTrack);
+
+    lV0Track = v0Cache.get(v0.globalIndex(), [&v0]() {
+      // Set up covariance matrices (should in fact be optional)
+      std::array<float, 21> covV = {0.};
+      constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
+      for (int i = 0; i < 6; i++) {
+        covV[MomInd[i]] = v0.momentumCovMat()[i];
+        covV[i] = v0.positionCovMat()[i];
+      }
+      o2::track::TrackParCov v0Track(
+        {v0.x(), v0.y(), v0.z()},
+        {v0.pxpos() + v0.pxneg(), v0.pypos() + v0.pyneg(), v0.pzpos() + v0.pzneg()},
+        covV, 0, true);
+      v0Track.setAbsCharge(0);
+      v0Track.setPID(o2::track::PID::Lambda);
+      return v0Track;
+    });
 
     //---/---/---/
     // Move close to minima
@@ -527,6 +539,8 @@ struct cascadeBuilder {
   void buildStrangenessTables(aod::Collision const& collision, TCascadeObjects const& cascades, TTracksTo const& tracks)
   {
     statisticsRegistry.eventCounter++;
+    trackCache.newCollision(collision.globalIndex());
+    v0Cache.newCollision(collision.globalIndex());
 
     for (auto& cascade : cascades) {
       // Track casting
@@ -53,6 +53,7 @@
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "PWGLF/Utils/trackParCache.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -149,6 +150,7 @@ struct lambdakzeroBuilder {
   Configurable<bool> d_UseAbsDCA{"d_UseAbsDCA", true, "Use Abs DCAs"};
   Configurable<bool> d_UseWeightedPCA{"d_UseWeightedPCA", false, "Vertices use cov matrices"};
   Configurable<int> useMatCorrType{"useMatCorrType", 0, "0: none, 1: TGeo, 2: LUT"};
+  Configurable<float> daughterPropagationX{"daughterPropagationX", -1.f, "if > 0, daughters with a larger X are propagated once to this X (cm) before the DCA fitter, -1: off"};
   Configurable<int> rejDiffCollTracks{"rejDiffCollTracks", 0, "rejDiffCollTracks"};
 
   // CCDB options
@@ -167,6 +169,9 @@ struct lambdakzeroBuilder {
   // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
   o2::vertexing::DCAFitterN<2> fitter;
 
+  // TrackParCov of the daughters, built once per timeframe whatever the number of V0s they enter
+  o2::analysis::TrackParCache trackCache;
+
   Filter taggedFilter = aod::v0tag::isInteresting == true;
 
   enum v0step { kV0All = 0,
@@ -362,6 +367,7 @@ struct lambdakzeroBuilder {
     if (useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
     fitter.setMatCorrType(matCorr);
+    trackCache.setPropagation(daughterPropagationX, maxSnp, maxStep, matCorr);
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -400,6 +406,7 @@ struct lambdakzeroBuilder {
     mRunNumber = bc.runNumber();
     // Set magnetic field value once known
     fitter.setBz(d_bz);
+    trackCache.reset(); // propagated with the previous field
   }
 
   template <class TTracksTo>
@@ -437,8 +444,8 @@ struct lambdakzeroBuilder {
     statisticsRegistry.v0stats[kV0DCAxy]++;
 
     // Change strangenessBuilder tracks
-    lPositiveTrack = getTrackParCov(posTrack);
-    lNegativeTrack = getTrackParCov(negTrack);
+    lPositiveTrack = trackCache.get(posTrack);
+    lNegativeTrack = trackCache.get(negTrack);
 
     //---/---/---/
     // Move close to minima
@@ -501,6 +508,7 @@ struct lambdakzeroBuilder {
   void buildStrangenessTables(aod::Collision const& collision, TV0Objects const& V0s, TTracksTo const& tracks)
   {
     statisticsRegistry.eventCounter++;
+    trackCache.newCollision(collision.globalIndex());
 
     for (auto& V0 : V0s) {
       // Track preselection part
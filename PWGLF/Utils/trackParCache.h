@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackParCache.h
+/// \brief Per-timeframe cache of the TrackParCov of the strangeness builder daughters
+///
+/// A daughter track usually enters several V0 or cascade candidates. The cache builds its
+/// TrackParCov from the table columns the first time it is requested, optionally propagating it
+/// once towards the interaction point down to a given X, and returns the stored state for the
+/// following candidates of the timeframe. The entries are indexed by global index and invalidated
+/// in O(1) when a new timeframe (or a new run, for the propagation) starts.
+
+#ifndef PWGLF_UTILS_TRACKPARCACHE_H_
+#define PWGLF_UTILS_TRACKPARCACHE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Common/Core/trackUtilities.h"
+#include "DetectorsBase/Propagator.h"
+#include "ReconstructionDataFormats/Track.h"
+
+namespace o2::analysis
+{
+
+class TrackParCache
+{
+ public:
+  /// \brief Propagate the cached tracks once, the first time they are requested
+  /// \param x X (cm) the tracks with a larger X are propagated to, <= 0 to disable the propagation
+  /// \param maxSnp Maximal sine of the track angle during the propagation
+  /// \param maxStep Maximal step (cm) of the propagation
+  /// \param matCorr Material correction of the propagation
+  void setPropagation(float x, float maxSnp, float maxStep, o2::base::Propagator::MatCorrType matCorr)
+  {
+    mPropagationX = x;
+    mMaxSnp = maxSnp;
+    mMaxStep = maxStep;
+    mMatCorr = matCorr;
+    reset();
+  }
+
+  /// Invalidates all the entries, e.g. at a change of run (magnetic field)
+  void reset()
+  {
+    if (++mStamp == 0) { // wrapped around, the old stamps could be mistaken for the new ones
+      mStamps.assign(mStamps.size(), 0);
+      mStamp = 1;
+    }
+  }
+
+  /// \brief Starts a new timeframe if the collision index is not larger than the previous one
+  /// \note the collisions of a timeframe are processed in increasing order of their global index,
+  ///       which starts again from 0 in the next timeframe
+  void newCollision(int64_t collisionIndex)
+  {
+    if (collisionIndex <= mLastCollision) {
+      reset();
+    }
+    mLastCollision = collisionIndex;
+  }
+
+  /// \return TrackParCov of the track, built and propagated only if not yet in the cache
+  template <typename TTrack>
+  const o2::track::TrackParCov& get(TTrack const& track)
+  {
+    return get(track.globalIndex(), [&track]() { return getTrackParCov(track); });
+  }
+
+  /// \return TrackParCov stored for the index, built with make() (and propagated) only if not yet in the cache
+  /// \note the returned reference is valid until the next call
+  template <typename TMaker>
+  const o2::track::TrackParCov& get(int64_t index, TMaker&& make)
+  {
+    if (index >= static_cast<int64_t>(mStamps.size())) {
+      mStamps.resize(index + 1, 0);
+      mTracks.resize(index + 1);
+    }
+    if (mStamps[index] != mStamp) {
+      mTracks[index] = make();
+      if (mPropagationX > 0.f && mTracks[index].getX() > mPropagationX) {
+        auto propagated = mTracks[index];
+        if (o2::base::Propagator::Instance()->PropagateToXBxByBz(propagated, mPropagationX, mMaxSnp, mMaxStep, mMatCorr)) {
+          mTracks[index] = propagated;
+        } // otherwise the DCA fitter starts from the unpropagated track, as without the cache
+      }
+      mStamps[index] = mStamp;
+    }
+    return mTracks[index];
+  }
+
+ private:
+  std::vector<o2::track::TrackParCov> mTracks; ///< cached tracks, by global index
+  std::vector<uint32_t> mStamps;               ///< stamp of the cached tracks, valid if equal to mStamp
+  uint32_t mStamp = 1;                         ///< stamp of the current timeframe
+  int64_t mLastCollision = -1;                 ///< global index of the last collision
+
+  float mPropagationX = -1.f; ///< X the tracks are propagated to, <= 0 if disabled
+  float mMaxSnp = 0.85f;
+  float mMaxStep = 2.f;
+  o2::base::Propagator::MatCorrType mMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+};
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_TRACKPARCACHE_H_
@@ -12,6 +12,10 @@
 #ifndef O2PHYSICS_UPCHELPERS_H
 #define O2PHYSICS_UPCHELPERS_H
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "Framework/AnalysisDataModel.h"
 #include "Common/DataModel/EventSelection.h"
 #include "Common/CCDB/EventSelectionParams.h"
@@ -88,6 +92,91 @@ struct FITInfo {
   int32_t BGFDDCpf = 0;
 };
 
+// global BCs with the IDs of the tracks assigned to them, in a compressed sparse row layout:
+// tracks are added in any BC order, build() then sorts them by BC (radix sort, stable so that the tracks of a BC
+// keep the order in which they were added) and stores each BC once with the offset and number of its tracks
+class BCTracksIndex
+{
+ public:
+  void clear()
+  {
+    fEntries.clear();
+    fBCs.clear();
+    fOffsets.clear();
+    fCounts.clear();
+    fTrackIds.clear();
+  }
+
+  // first pass: collect (BC, track ID) entries
+  void addTrack(uint64_t bc, int64_t trkId) { fEntries.push_back({bc, trkId}); }
+
+  // second pass: sort the entries by BC and build the (BC, offset, count) arrays
+  void build()
+  {
+    fBCs.clear();
+    fOffsets.clear();
+    fCounts.clear();
+    fTrackIds.clear();
+    if (fEntries.empty())
+      return;
+    // LSD radix sort on BC - min(BC), one pass per significant byte
+    uint64_t minBC = fEntries[0].bc;
+    uint64_t maxBC = fEntries[0].bc;
+    for (const auto& entry : fEntries) {
+      minBC = std::min(minBC, entry.bc);
+      maxBC = std::max(maxBC, entry.bc);
+    }
+    std::vector<Entry> buffer(fEntries.size());
+    for (uint32_t shift = 0; shift < 64 && ((maxBC - minBC) >> shift) != 0; shift += 8) {
+      uint32_t histo[257] = {0};
+      for (const auto& entry : fEntries)
+        ++histo[((entry.bc - minBC) >> shift & 0xff) + 1];
+      for (uint32_t i = 0; i < 256; ++i)
+        histo[i + 1] += histo[i];
+      for (const auto& entry : fEntries)
+        buffer[histo[(entry.bc - minBC) >> shift & 0xff]++] = entry;
+      fEntries.swap(buffer);
+    }
+    fTrackIds.reserve(fEntries.size());
+    for (const auto& entry : fEntries) {
+      if (fBCs.empty() || fBCs.back() != entry.bc) {
+        fBCs.push_back(entry.bc);
+        fOffsets.push_back(fTrackIds.size());
+        fCounts.push_back(0);
+      }
+      fTrackIds.push_back(entry.trkId);
+      ++fCounts.back();
+    }
+    fEntries.clear();
+  }
+
+  // number of BCs with tracks
+  uint32_t size() const { return fBCs.size(); }
+  uint64_t getBC(uint32_t ibc) const { return fBCs[ibc]; }
+  uint32_t getNTracks(uint32_t ibc) const { return fCounts[ibc]; }
+  const int64_t* getTracks(uint32_t ibc) const { return fTrackIds.data() + fOffsets[ibc]; }
+
+  // index of the first BC >= bc, size() if none
+  uint32_t lowerBound(uint64_t bc) const { return std::lower_bound(fBCs.begin(), fBCs.end(), bc) - fBCs.begin(); }
+  // index of the BC, -1 if it has no tracks
+  int32_t find(uint64_t bc) const
+  {
+    uint32_t ibc = lowerBound(bc);
+    return ibc < fBCs.size() && fBCs[ibc] == bc ? ibc : -1;
+  }
+
+ private:
+  struct Entry {
+    uint64_t bc;
+    int64_t trkId;
+  };
+  std::vector<Entry> fEntries;    // entries added since the last build
+  std::vector<uint64_t> fBCs;     // sorted BCs with tracks
+  std::vector<uint32_t> fOffsets; // position of the first track of each BC in fTrackIds
+  std::vector<uint32_t> fCounts;  // number of tracks of each BC
+  std::vector<int64_t> fTrackIds; // track IDs grouped by BC
+};
+
 template <typename TSelectorsArray>
 void applyFwdCuts(UPCCutparHolder& upcCuts, const ForwardTracks::iterator& track, TSelectorsArray& fwdSelectors)
 {
@@ -75,8 +75,6 @@ struct UpcCandProducer {
                                      o2::aod::pidTPCFullEl, o2::aod::pidTPCFullMu, o2::aod::pidTPCFullPi, o2::aod::pidTPCFullKa, o2::aod::pidTPCFullPr,
                                      o2::aod::TOFSignal, o2::aod::pidTOFFullEl, o2::aod::pidTOFFullMu, o2::aod::pidTOFFullPi, o2::aod::pidTOFFullKa, o2::aod::pidTOFFullPr>;
 
-  typedef std::pair<uint64_t, std::vector<int64_t>> BCTracksPair;
-
   void init(InitContext&)
   {
     fwdSelectors.resize(upchelpers::kNFwdSels - 1, false);
@@ -462,18 +460,8 @@ struct UpcCandProducer {
     }
   }
 
-  void addTrack(std::vector<BCTracksPair>& v, uint64_t bc, int64_t trkId)
-  {
-    auto it = std::find_if(v.begin(), v.end(),
-                           [bc](const BCTracksPair& element) { return element.first == bc; });
-    if (it != v.end())
-      it->second.push_back(trkId);
-    else
-      v.emplace_back(std::make_pair(bc, std::vector<int64_t>({trkId})));
-  }
-
-  void collectBarrelTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsA,
-                           std::vector<BCTracksPair>& bcsMatchedTrIdsB,
+  void collectBarrelTracks(upchelpers::BCTracksIndex& bcsMatchedTrIdsA,
+                           upchelpers::BCTracksIndex& bcsMatchedTrIdsB,
                            BCsWithBcSels const& bcs,
                            o2::aod::Collisions const& collisions,
                            BarrelTracks const& barrelTracks,
@@ -506,13 +494,15 @@ struct UpcCandProducer {
       bool needTOFWithITS = !upcCuts.getProduceITSITS() && upcCuts.getRequireITSTPC() && trk.hasTOF() && trk.hasITS() && trk.hasTPC();
       bool addToA = needITSITS || needAllTOF || needTOFWithITS;
       if (addToA)
-        addTrack(bcsMatchedTrIdsA, bc, trkId);
+        bcsMatchedTrIdsA.addTrack(bc, trkId);
       if (fSearchITSTPC == 1 && !trk.hasTOF() && trk.hasITS() && trk.hasTPC())
-        addTrack(bcsMatchedTrIdsB, bc, trkId);
+        bcsMatchedTrIdsB.addTrack(bc, trkId);
     }
+    bcsMatchedTrIdsA.build();
+    bcsMatchedTrIdsB.build();
   }
 
-  void collectForwardTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsMID,
+  void collectForwardTracks(upchelpers::BCTracksIndex& bcsMatchedTrIdsMID,
                             BCsWithBcSels const& bcs,
                             o2::aod::Collisions const& collisions,
                             ForwardTracks const& fwdTracks,
@@ -540,46 +530,37 @@ struct UpcCandProducer {
       if (bc > fMaxBC)
         continue;
       if (nContrib <= upcCuts.getMaxNContrib())
-        addTrack(bcsMatchedTrIdsMID, bc, trkId);
+        bcsMatchedTrIdsMID.addTrack(bc, trkId);
     }
+    bcsMatchedTrIdsMID.build();
   }
 
   int32_t searchTracks(uint64_t midbc, uint64_t range, uint32_t tracksToFind,
                        std::vector<int64_t>& tracks,
-                       std::vector<BCTracksPair>& v,
-                       std::unordered_set<int64_t>& matchedTracks,
+                       upchelpers::BCTracksIndex const& v,
+                       std::vector<bool>& matchedTracks,
                        bool skipMidBC = false)
   {
     uint32_t count = 0;
     uint64_t left = midbc >= range ? midbc - range : 0;
     uint64_t right = fMaxBC >= midbc + range ? midbc + range : fMaxBC;
-    BCTracksPair dummyPair(left, {});
-    auto curit = std::lower_bound(v.begin(), v.end(), dummyPair,
-                                  [](const BCTracksPair& left, const BCTracksPair& right) { return left.first < right.first; });
-    if (curit == v.end()) // no ITS-TPC tracks nearby at all -> near last BCs
+    uint32_t ibc = v.lowerBound(left);
+    if (ibc == v.size()) // no ITS-TPC tracks nearby at all -> near last BCs
       return -1;
-    uint64_t curbc = curit->first;
-    while (curbc <= right) { // moving forward to midbc+range
-      if (skipMidBC && curbc == midbc) {
-        ++curit;
-        if (curit == v.end())
-          break;
-        curbc = curit->first;
-      }
-      uint32_t size = curit->second.size();
+    for (; ibc < v.size() && v.getBC(ibc) <= right; ++ibc) { // moving forward to midbc+range
+      if (skipMidBC && v.getBC(ibc) == midbc)
+        continue;
+      uint32_t size = v.getNTracks(ibc);
       if (size > 1) // too many tracks per BC -> possibly another event
         return -2;
       count += size;
       if (count > tracksToFind) // too many tracks nearby
         return -3;
-      if (matchedTracks.find(curit->second[0]) == matchedTracks.end()) {
-        tracks.push_back(curit->second[0]);
-        matchedTracks.insert(curit->second[0]);
+      int64_t trkId = v.getTracks(ibc)[0];
+      if (!matchedTracks[trkId]) {
+        tracks.push_back(trkId);
+        matchedTracks[trkId] = true;
       }
-      ++curit;
-      if (curit == v.end())
-        break;
-      curbc = curit->first;
     }
     if (count != tracksToFind)
       return -4;
@@ -597,9 +578,9 @@ struct UpcCandProducer {
   {
     fMaxBC = bcs.iteratorAt(bcs.size() - 1).globalBC(); // restrict ITS-TPC track search to [0, fMaxBC]
 
-    // pairs of global BCs and vectors of matched track IDs:
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOF;
-    std::vector<BCTracksPair> bcsMatchedTrIdsITSTPC;
+    // global BCs with the IDs of their matched tracks:
+    upchelpers::BCTracksIndex bcsMatchedTrIdsTOF;
+    upchelpers::BCTracksIndex bcsMatchedTrIdsITSTPC;
 
     // trackID -> index in amb. track table
     std::unordered_map<int64_t, uint64_t> ambBarrelTrBCs;
@@ -610,42 +591,10 @@ struct UpcCandProducer {
                         barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
 
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
+    bool searchITSTPC = nBCsWithITSTPC > 0 && fSearchITSTPC == 1;
 
-    std::sort(bcsMatchedTrIdsTOF.begin(), bcsMatchedTrIdsTOF.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
-      std::unordered_set<int64_t> matchedTracks;
-      for (auto& pair : bcsMatchedTrIdsTOF) {
-        uint64_t bc = pair.first;
-        auto& trackIds = pair.second;
-        uint32_t nTOFtracks = trackIds.size();
-        if (nTOFtracks > fNBarProngs) // too many TOF tracks?!
-          continue;
-        if (nTOFtracks == fNBarProngs) { // check for ITS-TPC tracks
-          std::vector<int64_t> tracks;
-          tracks.reserve(fNBarProngs * 2); // precautions
-          int32_t res = searchTracks(bc, fSearchRangeITSTPC, 0, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
-          if (res < 0) { // too many tracks nearby -> rejecting
-            trackIds.push_back(0);
-            continue;
-          }
-        }
-        if (nTOFtracks < fNBarProngs && !upcCuts.getRequireTOF()) { // add ITS-TPC track if needed
-          uint32_t tracksToFind = fNBarProngs - nTOFtracks;
-          std::vector<int64_t> tracks;
-          tracks.reserve(fNBarProngs * 2); // precautions
-          int32_t res = searchTracks(bc, fSearchRangeITSTPC, tracksToFind, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
-          if (res < 0) // too many or not enough tracks nearby -> rejecting
-            continue;
-          trackIds.insert(trackIds.end(), tracks.begin(), tracks.end());
-        }
-      }
-    }
-
-    bcsMatchedTrIdsITSTPC.clear();
+    // ITS-TPC tracks already added to a candidate, by track ID
+    std::vector<bool> matchedTracks(searchITSTPC ? barrelTracks.size() : 0, false);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -663,15 +612,37 @@ struct UpcCandProducer {
 
     // storing n-prong matches
     int32_t candID = 0;
-    for (const auto& item : bcsMatchedTrIdsTOF) {
-      auto& barrelTrackIDs = item.second;
+    std::vector<int64_t> barrelTrackIDs;
+    std::vector<int64_t> tracks;
+    tracks.reserve(fNBarProngs * 2); // precautions
+    for (uint32_t ibc = 0; ibc < bcsMatchedTrIdsTOF.size(); ++ibc) {
+      uint64_t bc = bcsMatchedTrIdsTOF.getBC(ibc);
+      uint32_t nTOFtracks = bcsMatchedTrIdsTOF.getNTracks(ibc);
+      if (nTOFtracks > fNBarProngs) // too many TOF tracks?!
+        continue;
+      barrelTrackIDs.assign(bcsMatchedTrIdsTOF.getTracks(ibc), bcsMatchedTrIdsTOF.getTracks(ibc) + nTOFtracks);
+      if (searchITSTPC) {
+        if (nTOFtracks == fNBarProngs) { // check for ITS-TPC tracks
+          tracks.clear();
+          int32_t res = searchTracks(bc, fSearchRangeITSTPC, 0, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
+          if (res < 0) // too many tracks nearby -> rejecting
+            continue;
+        }
+        if (nTOFtracks < fNBarProngs && !upcCuts.getRequireTOF()) { // add ITS-TPC track if needed
+          uint32_t tracksToFind = fNBarProngs - nTOFtracks;
+          tracks.clear();
+          int32_t res = searchTracks(bc, fSearchRangeITSTPC, tracksToFind, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
+          if (res < 0) // too many or not enough tracks nearby -> rejecting
+            continue;
+          barrelTrackIDs.insert(barrelTrackIDs.end(), tracks.begin(), tracks.end());
+        }
+      }
       uint16_t numContrib = barrelTrackIDs.size();
       // sanity check
       if (numContrib != fNBarProngs)
         continue;
       // fetching FT0, FDD, FV0 information
       // if there is no relevant signal, dummy info will be used
-      uint64_t bc = item.first;
       upchelpers::FITInfo fitInfo{};
       processFITInfo(fitInfo, bc, indexBCglId, bcs, ft0s, fdds, fv0as);
       if (fFilterFT0) {
@@ -702,7 +673,6 @@ struct UpcCandProducer {
 
     indexBCglId.clear();
     ambBarrelTrBCs.clear();
-    bcsMatchedTrIdsTOF.clear();
   }
 
   void createCandidatesSemiFwd(BarrelTracks const& barrelTracks,
@@ -724,10 +694,10 @@ struct UpcCandProducer {
 
     fMaxBC = bcs.iteratorAt(bcs.size() - 1).globalBC(); // restrict ITS-TPC track search to [0, fMaxBC]
 
-    // pairs of global BCs and vectors of matched track IDs:
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOF;
-    std::vector<BCTracksPair> bcsMatchedTrIdsITSTPC;
-    std::vector<BCTracksPair> bcsMatchedTrIdsMID;
+    // global BCs with the IDs of their matched tracks:
+    upchelpers::BCTracksIndex bcsMatchedTrIdsTOF;
+    upchelpers::BCTracksIndex bcsMatchedTrIdsITSTPC;
+    upchelpers::BCTracksIndex bcsMatchedTrIdsMID;
 
     // trackID -> index in amb. track table
     std::unordered_map<int64_t, uint64_t> ambBarrelTrBCs;
@@ -749,60 +719,10 @@ struct UpcCandProducer {
 
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
     uint32_t nBCsWithMID = bcsMatchedTrIdsMID.size();
+    bool searchITSTPC = nBCsWithITSTPC > 0 && fSearchITSTPC == 1;
 
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    std::vector<BCTracksPair> bcsMatchedTrIdsTOFTagged(nBCsWithMID);
-    for (const auto& pair : bcsMatchedTrIdsTOF) {
-      uint64_t bc = pair.first;
-      auto it = std::find_if(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-                             [bc](const auto& item) { return item.first == bc; });
-      if (it != bcsMatchedTrIdsMID.end()) {
-        uint32_t ibc = it - bcsMatchedTrIdsMID.begin();
-        bcsMatchedTrIdsTOFTagged[ibc].second = pair.second;
-      }
-    }
-
-    bcsMatchedTrIdsTOF.clear();
-
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
-    if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
-      std::unordered_set<int64_t> matchedTracks;
-      for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
-        auto& pairMID = bcsMatchedTrIdsMID[ibc];
-        auto& pairTOF = bcsMatchedTrIdsTOFTagged[ibc];
-        uint64_t bc = pairMID.first;
-        auto& trackIdsMID = pairMID.second;
-        auto& trackIdsTOF = pairTOF.second;
-        uint32_t nMIDtracks = trackIdsMID.size();
-        uint32_t nTOFtracks = trackIdsTOF.size();
-        if (nMIDtracks > fNFwdProngs || nTOFtracks > fNBarProngs) // too many MID and/or TOF tracks?!
-          continue;
-        if (nMIDtracks == fNFwdProngs && nTOFtracks == fNBarProngs) { // check for ITS-TPC tracks
-          std::vector<int64_t> tracks;
-          tracks.reserve(fNBarProngs * 2); // precautions
-          int32_t res = searchTracks(bc, fSearchRangeITSTPC, 0, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, false);
-          if (res < 0) { // too many tracks nearby -> rejecting
-            trackIdsTOF.push_back(0);
-            continue;
-          }
-        }
-        if (nMIDtracks == fNFwdProngs && nTOFtracks < fNBarProngs && !upcCuts.getRequireTOF()) { // add ITS-TPC track if needed
-          uint32_t tracksToFind = fNBarProngs - nTOFtracks;
-          std::vector<int64_t> tracks;
-          tracks.reserve(fNBarProngs * 2); // precautions
-          int32_t res = searchTracks(bc, fSearchRangeITSTPC, tracksToFind, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
-          if (res < 0) // too many or not enough tracks nearby -> rejecting
-            continue;
-          trackIdsTOF.insert(trackIdsTOF.end(), tracks.begin(), tracks.end());
-        }
-      }
-    }
-
-    bcsMatchedTrIdsITSTPC.clear();
+    // ITS-TPC tracks already added to a candidate, by track ID
+    std::vector<bool> matchedTracks(searchITSTPC ? barrelTracks.size() : 0, false);
 
     // todo: calculate position of UD collision?
     float dummyX = 0.;
@@ -820,20 +740,45 @@ struct UpcCandProducer {
 
     // storing n-prong matches
     int32_t candID = 0;
+    std::vector<int64_t> fwdTrackIDs;
+    std::vector<int64_t> barrelTrackIDs; // TOF + ITS-TPC tracks
+    std::vector<int64_t> tracks;
+    tracks.reserve(fNBarProngs * 2); // precautions
     for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
-      auto& pairMID = bcsMatchedTrIdsMID[ibc];
-      auto& pairTOF = bcsMatchedTrIdsTOFTagged[ibc];
-      auto& fwdTrackIDs = pairMID.second;
-      auto& barrelTrackIDs = pairTOF.second;
-      uint32_t nMIDtracks = fwdTrackIDs.size();
-      uint32_t nBarrelTracks = barrelTrackIDs.size(); // TOF + ITS-TPC tracks
+      uint64_t bc = bcsMatchedTrIdsMID.getBC(ibc);
+      uint32_t nMIDtracks = bcsMatchedTrIdsMID.getNTracks(ibc);
+      // TOF tracks in the same BC
+      int32_t ibcTOF = bcsMatchedTrIdsTOF.find(bc);
+      uint32_t nTOFtracks = ibcTOF >= 0 ? bcsMatchedTrIdsTOF.getNTracks(ibcTOF) : 0;
+      if (nMIDtracks > fNFwdProngs || nTOFtracks > fNBarProngs) // too many MID and/or TOF tracks?!
+        continue;
+      fwdTrackIDs.assign(bcsMatchedTrIdsMID.getTracks(ibc), bcsMatchedTrIdsMID.getTracks(ibc) + nMIDtracks);
+      barrelTrackIDs.clear();
+      if (ibcTOF >= 0)
+        barrelTrackIDs.assign(bcsMatchedTrIdsTOF.getTracks(ibcTOF), bcsMatchedTrIdsTOF.getTracks(ibcTOF) + nTOFtracks);
+      if (searchITSTPC) {
+        if (nMIDtracks == fNFwdProngs && nTOFtracks == fNBarProngs) { // check for ITS-TPC tracks
+          tracks.clear();
+          int32_t res = searchTracks(bc, fSearchRangeITSTPC, 0, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, false);
+          if (res < 0) // too many tracks nearby -> rejecting
+            continue;
+        }
+        if (nMIDtracks == fNFwdProngs && nTOFtracks < fNBarProngs && !upcCuts.getRequireTOF()) { // add ITS-TPC track if needed
+          uint32_t tracksToFind = fNBarProngs - nTOFtracks;
+          tracks.clear();
+          int32_t res = searchTracks(bc, fSearchRangeITSTPC, tracksToFind, tracks, bcsMatchedTrIdsITSTPC, matchedTracks, true);
+          if (res < 0) // too many or not enough tracks nearby -> rejecting
+            continue;
+          barrelTrackIDs.insert(barrelTrackIDs.end(), tracks.begin(), tracks.end());
+        }
+      }
+      uint32_t nBarrelTracks = barrelTrackIDs.size();
       uint16_t numContrib = nBarrelTracks + nMIDtracks;
       // sanity check
       if (nBarrelTracks != fNBarProngs || nMIDtracks != fNFwdProngs)
         continue;
       // fetching FT0, FDD, FV0 information
       // if there is no relevant signal, dummy info will be used
-      uint64_t bc = pairMID.first;
       upchelpers::FITInfo fitInfo{};
       processFITInfo(fitInfo, bc, indexBCglId, bcs, ft0s, fdds, fv0as);
       if (fFilterFT0) {
@@ -865,9 +810,7 @@ struct UpcCandProducer {
 
     indexBCglId.clear();
     ambFwdTrBCs.clear();
-    bcsMatchedTrIdsMID.clear();
     ambBarrelTrBCs.clear();
-    bcsMatchedTrIdsTOFTagged.clear();
   }
 
   // data processors
@@ -14,6 +14,7 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "Common/DataModel/EventSelection.h"
@@ -94,37 +95,56 @@ struct KaonPidTask {
   {
     auto groupPositive = positive->sliceByCached(aod::track::collisionId, coll.globalIndex());
     auto groupNegative = negative->sliceByCached(aod::track::collisionId, coll.globalIndex());
+    // The model is applied once per track, in a single inference call per group, and the decisions are reused for the pairs
+    auto certaintiesPositive = pidModel.get()->applyModelBatch(groupPositive);
+    std::vector<bool> acceptedPositive(certaintiesPositive.size());
+    int iTrack = 0;
     for (auto track : groupPositive) {
       histos.fill(HIST("hChargePos"), track.sign());
-      if (pidModel.get()->applyModelBoolean(track)) {
+      acceptedPositive[iTrack] = certaintiesPositive[iTrack] >= pidModel.get()->mMinCertainty;
+      if (acceptedPositive[iTrack]) {
         histos.fill(HIST("hdEdXvsMomentum"), track.p(), track.tpcSignal());
       }
+      iTrack++;
     }
 
+    auto certaintiesNegative = pidModel.get()->applyModelBatch(groupNegative);
+    std::vector<bool> acceptedNegative(certaintiesNegative.size());
+    iTrack = 0;
     for (auto track : groupNegative) {
       histos.fill(HIST("hChargeNeg"), track.sign());
-      if (pidModel.get()->applyModelBoolean(track)) {
+      acceptedNegative[iTrack] = certaintiesNegative[iTrack] >= pidModel.get()->mMinCertainty;
+      if (acceptedNegative[iTrack]) {
         histos.fill(HIST("hdEdXvsMomentum"), track.p(), track.tpcSignal());
       }
+      iTrack++;
     }
 
-    for (auto& [pos, neg] : combinations(soa::CombinationsFullIndexPolicy(groupPositive, groupNegative))) {
-      if (!(pidModel.get()->applyModelBoolean(pos)) || !(pidModel.get()->applyModelBoolean(neg))) {
+    // Same pairs as the full index combinations of the two groups, in the same order
+    int iPos = 0;
+    for (auto pos : groupPositive) {
+      if (!acceptedPositive[iPos++]) {
         continue;
       }
+      int iNeg = 0;
+      for (auto neg : groupNegative) {
+        if (!acceptedNegative[iNeg++]) {
+          continue;
+        }
 
-      TLorentzVector part1Vec;
-      TLorentzVector part2Vec;
-      float mMassOne = TDatabasePDG::Instance()->GetParticle(cfgPid.value)->Mass();
-      float mMassTwo = TDatabasePDG::Instance()->GetParticle(cfgPid.value)->Mass();
+        TLorentzVector part1Vec;
+        TLorentzVector part2Vec;
+        float mMassOne = TDatabasePDG::Instance()->GetParticle(cfgPid.value)->Mass();
+        float mMassTwo = TDatabasePDG::Instance()->GetParticle(cfgPid.value)->Mass();
 
-      part1Vec.SetPtEtaPhiM(pos.pt(), pos.eta(), pos.phi(), mMassOne);
-      part2Vec.SetPtEtaPhiM(neg.pt(), neg.eta(), neg.phi(), mMassTwo);
+        part1Vec.SetPtEtaPhiM(pos.pt(), pos.eta(), pos.phi(), mMassOne);
+        part2Vec.SetPtEtaPhiM(neg.pt(), neg.eta(), neg.phi(), mMassTwo);
 
-      TLorentzVector sumVec(part1Vec);
-      sumVec += part2Vec;
+        TLorentzVector sumVec(part1Vec);
+        sumVec += part2Vec;
 
-      histos.fill(HIST("hInvariantMass"), sumVec.M());
+        histos.fill(HIST("hInvariantMass"), sumVec.M());
+      }
     }
   }
 };
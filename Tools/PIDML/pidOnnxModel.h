@@ -22,7 +22,10 @@
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
+#include <gsl/span>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 enum PidMLDetector {
   kTPCOnly = 0,
@@ -101,6 +104,68 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  // Applies the model to all the tracks of a table (or table slice) in a single inference call
+  // Returns the certainties in the order of the tracks; the span is valid until the next call
+  template <typename T>
+  gsl::span<const float> applyModelBatch(const T& tracks)
+  {
+    const int64_t nInputs = getNInputs();
+    const int64_t nTracks = tracks.size();
+    mBatchOutputs.resize(nTracks);
+    if (nTracks == 0) {
+      return mBatchOutputs;
+    }
+
+    // Model exported with a fixed batch size: fall back to the single track inference
+    if (mInputShapes[0][0] > 0) {
+      int64_t iTrack = 0;
+      for (const auto& track : tracks) {
+        mBatchOutputs[iTrack++] = getModelOutput(track);
+      }
+      return mBatchOutputs;
+    }
+
+    mBatchInputs.resize(nTracks * nInputs);
+    int64_t iTrack = 0;
+    for (const auto& track : tracks) {
+      fillInputs(track, &mBatchInputs[iTrack * nInputs]);
+      iTrack++;
+    }
+
+    std::vector<int64_t> inputShape{nTracks, nInputs};
+    std::vector<Ort::Value> inputTensors;
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(mBatchInputs.data(), mBatchInputs.size(), inputShape));
+    LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+    try {
+      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
+      LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+
+      const float* outputValues = outputTensors[0].GetTensorData<float>();
+      for (int64_t i = 0; i < nTracks; i++) {
+        mBatchOutputs[i] = sigmoid(outputValues[i]); // FIXME: Temporary, sigmoid will be added as network layer
+      }
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+      std::fill(mBatchOutputs.begin(), mBatchOutputs.end(), 0.f);
+    }
+    return mBatchOutputs;
+  }
+
+  // Number of input values per track, depending on the detectors used
+  int getNInputs() const
+  {
+    int nInputs = 14;
+    if (mDetector >= kTPCTOF) {
+      nInputs += 2;
+    }
+    if (mDetector >= kTPCTOFTRD) {
+      nInputs += 2;
+    }
+    return nInputs;
+  }
+
   PidMLDetector mDetector;
   int mPid;
   double mMinCertainty;
@@ -173,8 +238,9 @@ struct PidONNXModel {
     }
   }
 
+  // Fills the getNInputs() scaled input values of a track
   template <typename T>
-  std::vector<float> createInputsSingle(const T& track)
+  void fillInputs(const T& track, float* inputValues)
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
@@ -188,22 +254,42 @@ struct PidONNXModel {
 
     float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
 
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), (float)track.sign(), scaledX, scaledY, scaledZ, scaledAlpha, (float)track.trackType(), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    int i = 0;
+    inputValues[i++] = track.px();
+    inputValues[i++] = track.py();
+    inputValues[i++] = track.pz();
+    inputValues[i++] = (float)track.sign();
+    inputValues[i++] = scaledX;
+    inputValues[i++] = scaledY;
+    inputValues[i++] = scaledZ;
+    inputValues[i++] = scaledAlpha;
+    inputValues[i++] = (float)track.trackType();
+    inputValues[i++] = scaledTPCNClsShared;
+    inputValues[i++] = scaledDcaXY;
+    inputValues[i++] = scaledDcaZ;
+    inputValues[i++] = track.p();
+    inputValues[i++] = scaledTPCSignal;
 
     if (mDetector >= kTPCTOF) {
       float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
       float scaledBeta = (track.beta() - mScalingParams.at("fBeta").first) / mScalingParams.at("fBeta").second;
-      inputValues.push_back(scaledTOFSignal);
-      inputValues.push_back(scaledBeta);
+      inputValues[i++] = scaledTOFSignal;
+      inputValues[i++] = scaledBeta;
     }
 
     if (mDetector >= kTPCTOFTRD) {
       float scaledTRDSignal = (track.trdSignal() - mScalingParams.at("fTRDSignal").first) / mScalingParams.at("fTRDSignal").second;
       float scaledTRDPattern = (track.trdPattern() - mScalingParams.at("fTRDPattern").first) / mScalingParams.at("fTRDPattern").second;
-      inputValues.push_back(scaledTRDSignal);
-      inputValues.push_back(scaledTRDPattern);
+      inputValues[i++] = scaledTRDSignal;
+      inputValues[i++] = scaledTRDPattern;
     }
+  }
 
+  template <typename T>
+  std::vector<float> createInputsSingle(const T& track)
+  {
+    std::vector<float> inputValues(getNInputs());
+    fillInputs(track, inputValues.data());
     return inputValues;
   }
 
@@ -265,6 +351,9 @@ struct PidONNXModel {
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+
+  std::vector<float> mBatchInputs;  // input values of the last batch, track after track
+  std::vector<float> mBatchOutputs; // certainties of the last batch
 };
 
 #endif // O2_ANALYSIS_PIDONNXMODEL_H_